@@ -5,8 +5,14 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <iostream>
 
 #include "MLAppController.h"
+#include "MLParameterSnapshot.h"
 #include "mldsp.h"
 #include "mlvg.h"
 
@@ -21,11 +27,66 @@
 #include "native/MLSDLUtils.h"
 
 
+// how long --startup-bench waits for all resources before failing.
+constexpr double kStartupBenchTimeoutInMs{ 10000 };
+
+// how many events --latency-bench sends, and how long it waits for each one to be shown.
+constexpr int kLatencyBenchEvents{ 500 };
+constexpr double kLatencyBenchTimeoutInMs{ 1000 };
+
 struct TestAppProcessor : public SignalProcessor, public Actor
 {
   // sine generators.
   SineGen s1, s2;
   
+  // real parameter values for the audio thread, in the order of the descriptions.
+  // The parameter tree is only used on the Actor thread.
+  std::unique_ptr< ParameterSnapshot > snapshot;
+  std::vector< Path > paramNames;
+  size_t freq1ID{0}, freq2ID{0}, gainID{0};
+  
+  // call after buildParams() and before the audio starts.
+  void buildSnapshot(const ParameterDescriptionList& pdl)
+  {
+    for(auto& pd : pdl)
+    {
+      paramNames.push_back(Path(pd->getTextProperty("name")));
+    }
+    
+    // the snapshot has one more value than there are parameters, which is
+    // always 0, so that a missing parameter the audio thread reads is silent
+    // instead of out of bounds.
+    snapshot = std::make_unique< ParameterSnapshot >(paramNames.size() + 1);
+    freq1ID = getRequiredParamID("freq1");
+    freq2ID = getRequiredParamID("freq2");
+    gainID = getRequiredParamID("gain");
+    
+    for(size_t id = 0; id < paramNames.size(); ++id)
+    {
+      snapshot->setValue(id, getRealFloatParam(paramNames[id]));
+    }
+    snapshot->publish();
+  }
+  
+  // get the ID of a parameter, or paramNames.size() if there is none.
+  size_t getParamID(Path paramName) const
+  {
+    auto it = std::find(paramNames.begin(), paramNames.end(), paramName);
+    return it - paramNames.begin();
+  }
+  
+  // get the ID of a parameter the processor needs. A missing one is a bug.
+  size_t getRequiredParamID(Path paramName) const
+  {
+    size_t id = getParamID(paramName);
+    if(id >= paramNames.size())
+    {
+      std::cout << "TestAppProcessor: no parameter " << paramName << "!\n";
+      assert(false);
+    }
+    return id;
+  }
+  
   void onMessage(Message msg)
   {
     switch(hash(head(msg.address)))
@@ -35,6 +96,15 @@ struct TestAppProcessor : public SignalProcessor, public Actor
         auto paramName = tail(msg.address);
         auto newParamValue = msg.value;
         _params.setFromNormalizedValue(paramName, newParamValue);
+        
+        // publish the new real value to the audio thread.
+        size_t id = getParamID(paramName);
+        if(id < paramNames.size())
+        {
+          snapshot->setValue(id, getRealFloatParam(paramName));
+          snapshot->publish();
+        }
+        break;
       }
       default:
       {
@@ -49,10 +119,11 @@ void processTestApp(AudioContext* ctx, void *untypedState)
 {
   auto state = static_cast< TestAppProcessor* >(untypedState);
   
-  // get params from the SignalProcessor.
-  float f1 = state->getRealFloatParam("freq1");
-  float f2 = state->getRealFloatParam("freq2");
-  float gain = state->getRealFloatParam("gain");
+  // get the latest published params.
+  const float* params = state->snapshot->acquire();
+  float f1 = params[state->freq1ID];
+  float f2 = params[state->freq2ID];
+  float gain = params[state->gainID];
   
   // Running the sine generators makes DSPVectors as output.
   // The input parameter is omega: the frequency in Hz divided by the sample rate.
@@ -208,9 +279,53 @@ public:
   }
 };
 
+// With --startup-bench, the app quits once its first frame with all resources
+// has been presented, and reports the time to its first frame and to all
+// resources. The exit status is nonzero if --max-startup-ms is given and
+// exceeded, or if startup does not finish, so this can be used as a
+// regression gate.
+//
+// With --latency-bench, once all resources are ready the app pushes synthetic
+// scroll events over the gain Dial into the AppView's event queue, one at a time.
+// Each goes through processGUIEvent() and the Dial's redraw to a presented frame,
+// where the InputLatencyMonitor measures it. Then the app quits and reports the
+// p50 and p99 event-to-pixel latency. The exit status is nonzero if --max-p99-ms
+// is given and exceeded, or if an event is never shown.
+//
+// usage: testapp [--startup-bench [--max-startup-ms N]] [--latency-bench [--max-p99-ms N]]
+
 int main(int argc, char* argv[])
 {
     bool doneFlag{ false };
+    bool startupBench{ false };
+    double maxStartupMs{ 0 };
+    bool latencyBench{ false };
+    double maxP99Ms{ 0 };
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "--startup-bench"))
+        {
+            startupBench = true;
+        }
+        else if (!strcmp(argv[i], "--max-startup-ms") && (i + 1 < argc))
+        {
+            maxStartupMs = atof(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--latency-bench"))
+        {
+            latencyBench = true;
+        }
+        else if (!strcmp(argv[i], "--max-p99-ms") && (i + 1 < argc))
+        {
+            maxP99Ms = atof(argv[++i]);
+        }
+        else
+        {
+            std::cout << "usage: " << argv[0] << " [--startup-bench [--max-startup-ms N]] [--latency-bench [--max-p99-ms N]]\n";
+            return 2;
+        }
+    }
+
     PlatformView::initPlatform();
 
     ParameterDescriptionList pdl;
@@ -243,6 +358,7 @@ int main(int argc, char* argv[])
 
     appProcessor.buildParams(pdl);
     appProcessor.setDefaultParams();
+    appProcessor.buildSnapshot(pdl);
     appProcessor.start();
 
     TextFragment processorName(getAppName(), "processor", ml::textUtils::naturalNumberToText(appInstanceNum));
@@ -252,17 +368,89 @@ int main(int argc, char* argv[])
     appController.broadcastParams();
 
     testAppTask.startAudio();
+    auto startTime = std::chrono::steady_clock::now();
+
+    // latency bench state: the events sent so far, and when the last one was sent.
+    int latencyEventsSent{ 0 };
+    bool latencyBenchTimedOut{ false };
+    auto lastEventTime = startTime;
+
     while (!doneFlag)
     {
         SDLAppLoop(appController.window, &doneFlag);
+        auto now = std::chrono::steady_clock::now();
+        bool resourcesReady = (appController.appView->getTimeToAllResourcesInMs() > 0);
+        
+        // give up on either bench if startup takes much longer than it should.
+        double elapsedMs = std::chrono::duration< double, std::milli >(now - startTime).count();
+        if ((startupBench || latencyBench) && !resourcesReady && (elapsedMs > kStartupBenchTimeoutInMs))
+        {
+            latencyBenchTimedOut = latencyBench;
+            doneFlag = true;
+        }
+        else if (startupBench && resourcesReady)
+        {
+            doneFlag = true;
+        }
+        else if (latencyBench && resourcesReady)
+        {
+            // send the next event once the last one has been shown, alternating
+            // directions so that the Dial's value changes every time.
+            size_t eventsShown = appController.appView->getInputLatencyMonitor().getHistogram().getCount();
+            if (eventsShown >= size_t(latencyEventsSent))
+            {
+                if (latencyEventsSent == kLatencyBenchEvents)
+                {
+                    doneFlag = true;
+                }
+                else
+                {
+                    float direction = (latencyEventsSent & 1) ? -1.f : 1.f;
+                    Vec2 dialCenter = appController.appView->getWidgetCenterInPixels("gain");
+                    appController.appView->pushEvent(GUIEvent{ "scroll", dialCenter, Vec2(0, direction) });
+                    latencyEventsSent++;
+                    lastEventTime = now;
+                }
+            }
+            else if (std::chrono::duration< double, std::milli >(now - lastEventTime).count() > kLatencyBenchTimeoutInMs)
+            {
+                latencyBenchTimedOut = true;
+                doneFlag = true;
+            }
+        }
     }
     testAppTask.stopAudio();
 
+    int result{ 0 };
+    if (startupBench)
+    {
+        double firstFrameMs = appController.appView->getTimeToFirstFrameInMs();
+        double allResourcesMs = appController.appView->getTimeToAllResourcesInMs();
+        std::cout << "startup: first frame " << firstFrameMs << " ms, all resources " << allResourcesMs << " ms\n";
+        if (!allResourcesMs || ((maxStartupMs > 0) && (allResourcesMs > maxStartupMs)))
+        {
+            std::cout << "FAILED: startup took too long.\n";
+            result = 1;
+        }
+    }
+    else if (latencyBench)
+    {
+        LatencyHistogram h = appController.appView->getInputLatencyMonitor().getHistogram();
+        double p99Ms = h.getPercentileMs(0.99f);
+        std::cout << "event-to-pixel latency over " << h.getCount() << " events: p50 " << h.getPercentileMs(0.5f)
+            << " ms, p99 " << p99Ms << " ms, max " << h.getMaxMs() << " ms\n";
+        if (latencyBenchTimedOut || ((maxP99Ms > 0) && (p99Ms > maxP99Ms)))
+        {
+            std::cout << "FAILED: " << (latencyBenchTimedOut ? "an event was not shown.\n" : "latency too high.\n");
+            result = 1;
+        }
+    }
+
     appProcessor.stop();
     appController.appView->stop();
     SDL_DestroyWindow(appController.window);
     SDL_Quit();
-    return 0;
+    return result;
 }
 
 
@@ -7,7 +7,7 @@
 
 #include "testAppView.h"
 #include "testAppParameters.h"
-#include "../build/resources/testapp/resources.c"
+#include "../build/resources/testapp/resources_pack.c"
 
 TestAppView::TestAppView(TextFragment appName, size_t instanceNum) :
 AppView(appName, instanceNum)
@@ -22,57 +22,7 @@ TestAppView::~TestAppView ()
 
 void TestAppView::layoutView(DrawContext dc)
 {
-  ml::Rect largeDialRect{0, 0, 1.5, 1.5};
-  ml::Rect labelRect(0, 0, 2, 0.5);
-  
-  Vec2 pixelSize = dc.coords.viewSizeInPixels;
-  float gridSize = dc.coords.gridSizeInPixels;
-  
-  int gx = pixelSize.x() / gridSize;
-  int gy = pixelSize.y() / gridSize;
-  
-  
-  // layout dials
-  _view->_widgets["freq1"]->setBounds(alignCenterToPoint(largeDialRect, {1, 1}));
-  _view->_widgets["freq2"]->setBounds(alignCenterToPoint(largeDialRect, {gx - 1.f, 1}));
-  _view->_widgets["freq2b"]->setBounds(alignCenterToPoint(largeDialRect, {gx - 3.f, 1}));
-  _view->_widgets["gain"]->setBounds(alignCenterToPoint(largeDialRect, {gx - 1.f, gy - 1.f}));
-  
-  // layout test images
-  _view->_widgets["tess"]->setBounds(alignCenterToPoint(largeDialRect, { 1, gy - 1.f }));
-  _view->_widgets["view1"]->setBounds(alignCenterToPoint({0, 0, 1.5, 1.5}, { 3, gy - 1.f }));
-  
-  // layout labels
-  auto positionLabelUnderDial = [&](Path dialName)
-  {
-    Path labelName (TextFragment(pathToText(dialName), "_label"));
-    ml::Rect dialRect = _view->_widgets[dialName]->getRectProperty("bounds");
-    _view->_backgroundWidgets[labelName]->setRectProperty
-    ("bounds", alignCenterToPoint(labelRect, dialRect.bottomCenter() - Vec2(0, 0.125)));
-  };
-  for(auto dialName : {"freq1", "freq2", "gain"})
-  {
-    positionLabelUnderDial(dialName);
-  }
-  
-  // layout buttons
-  float centerX = gx/2.f;
-  int bottomY = gy - 2;
-  float buttonWidth = 3;
-  float buttonHeight = 0.75;
-  ml::Rect textButtonRect(0, 0, buttonWidth, buttonHeight);
-  float halfButtonWidth = buttonWidth/2.f;
-  float buttonsY1 = bottomY + 0.5;
-  
-  Rect openButtonRect = alignCenterToPoint(textButtonRect, { centerX, buttonsY1 });
-  _view->_widgets["open"]->setRectProperty("bounds", openButtonRect);
-  
-  // resize widgets
-  forEach< Widget >
-  (_view->_widgets, [&](Widget& w)
-   {
-    w.resize(dc);
-  });
+  // all the Widgets are placed by the rules in makeWidgets().
 }
 
 void TestAppView::initializeResources(NativeDrawContext* nvg)
@@ -90,18 +40,28 @@ void TestAppView::initializeResources(NativeDrawContext* nvg)
   // _drawingProperties.setProperty("draw_widget_bounds", true);
   // _drawingProperties.setProperty("draw_dirty_widgets", true);
   
-  // fonts
-  _resources.fonts["d_din"] = std::make_unique< FontResource >(nvg, "MLVG_sans", resources::D_DIN_otf, resources::D_DIN_otf_size);
-  _resources.fonts["d_din_italic"] = std::make_unique< FontResource >(nvg, "MLVG_italic", resources::D_DIN_Italic_otf, resources::D_DIN_Italic_otf_size);
+  // resources are found in the pack by name. Any image not loaded below will
+  // be made from the pack entry of the same name when it is first drawn.
+  _resourcePack = std::make_unique< ResourcePack >(resources::pack, resources::pack_size);
+  _resources.pack = _resourcePack.get();
   
-  // raster images
-  _resources.rasterImages["vignette"] = std::make_unique< RasterImage >(nvg, resources::vignette_jpg, resources::vignette_jpg_size);
+  // fonts
+  auto din = _resourcePack->find("D-DIN");
+  auto dinItalic = _resourcePack->find("D-DIN-Italic");
+  _resources.fonts["d_din"] = std::make_unique< FontResource >(nvg, "MLVG_sans", din.data, int(din.size));
+  _resources.fonts["d_din_italic"] = std::make_unique< FontResource >(nvg, "MLVG_italic", dinItalic.data, int(dinItalic.size));
   
-  // SVG images
-  _resources.vectorImages["tesseract"] = std::make_unique< VectorImage >(nvg, resources::Tesseract_Mark_svg, resources::Tesseract_Mark_svg_size);
+  // raster and SVG images are decoded in the background, and appear when ready.
+  auto vignette = _resourcePack->find("vignette");
+  auto tesseract = _resourcePack->find("Tesseract_Mark");
+  _resourceLoader.loadRasterImage("vignette", vignette.data, vignette.size);
+  _resourceLoader.loadVectorImage("tesseract", tesseract.data, tesseract.size);
   
   // drawable images
   _resources.drawableImages["screen1"] = std::make_unique< DrawableImage >(nvg, 320, 240);
+  
+  // any resources made before are gone now.
+  _resources.changed();
 }
 
 void TestAppView::clearResources()
@@ -110,6 +70,7 @@ void TestAppView::clearResources()
   _resources.rasterImages.clear();
   _resources.vectorImages.clear();
   _resources.drawableImages.clear();
+  _resources.changed();
 }
 
 void TestAppView::stop()
@@ -119,6 +80,11 @@ void TestAppView::stop()
 }
 
 
+Vec2 TestAppView::getWidgetCenterInPixels(Path widgetName)
+{
+  return getCenter(_GUICoordinates.gridToPixel(_view->_widgets[widgetName]->getBounds()));
+}
+
 void TestAppView::makeWidgets(const ParameterDescriptionList& pdl)
 {
   // add labels to background
@@ -188,6 +154,29 @@ void TestAppView::makeWidgets(const ParameterDescriptionList& pdl)
   });
 #endif
   
+  // layout rules. Anchors are fractions of the view size, offsets are in grid units.
+  ml::Rect largeDialRect{0, 0, 1.5, 1.5};
+  ml::Rect labelRect(0, 0, 2, 0.5);
+  ml::Rect textButtonRect(0, 0, 3, 0.75);
+  
+  // dials and test images in the corners
+  _layout.anchor("freq1", largeDialRect, {0, 0}, {1, 1});
+  _layout.anchor("freq2", largeDialRect, {1, 0}, {-1, 1});
+  _layout.anchor("freq2b", largeDialRect, {1, 0}, {-3, 1});
+  _layout.anchor("gain", largeDialRect, {1, 1}, {-1, -1});
+  _layout.anchor("tess", largeDialRect, {0, 1}, {1, -1});
+  _layout.anchor("view1", largeDialRect, {0, 1}, {3, -1});
+  
+  // labels
+  for(auto dialName : {"freq1", "freq2", "gain"})
+  {
+    Path labelName (TextFragment(dialName, "_label"));
+    _layout.under(labelName, dialName, labelRect, {0, -0.125});
+  }
+  
+  // buttons
+  _layout.anchor("open", textButtonRect, {0.5, 1}, {0, -1.5});
+  
   // make all the above Widgets visible
   forEach< Widget >
   (_view->_widgets, [&](Widget& w)
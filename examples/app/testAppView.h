@@ -34,6 +34,12 @@ public:
 
   void makeWidgets(const ParameterDescriptionList& pdl);
 
+  // center of a Widget in pixel coordinates, where input events are pushed.
+  Vec2 getWidgetCenterInPixels(Path widgetName);
+
   void stop();
 
+private:
+  // all of the app's resources, compiled in as one pack.
+  std::unique_ptr< ResourcePack > _resourcePack;
 };
@@ -0,0 +1,235 @@
+// Headless DSP benchmark for ClapSawDemo. Renders audio as fast as possible,
+// with synthetic notes and parameter automation, at several host block sizes,
+// and reports the time per sample, the worst block time and any allocations
+// made while processing.
+//
+// usage: clap-saw-demo-dsp-bench [--seconds S] [--max-ns-per-sample N] [--fail-on-allocation]
+//
+// The exit status is nonzero if a limit is exceeded, so this can be used as a
+// regression gate.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <vector>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+#include "clap-saw-demo.h"
+
+namespace {
+
+// allocation counting: every operator new on a thread with counting turned on is
+// counted, including the aligned and nothrow forms.
+thread_local bool tCountAllocations = false;
+thread_local size_t tAllocations = 0;
+
+void* countedAlloc(std::size_t size) noexcept {
+  if (tCountAllocations) {
+    tAllocations++;
+  }
+  return std::malloc(size ? size : 1);
+}
+
+void* countedAlignedAlloc(std::size_t size, std::align_val_t align) noexcept {
+  if (tCountAllocations) {
+    tAllocations++;
+  }
+  const std::size_t a = static_cast<std::size_t>(align);
+#if defined(_WIN32)
+  return _aligned_malloc(size ? size : 1, a);
+#else
+  // aligned_alloc() needs a size that is a multiple of the alignment.
+  return std::aligned_alloc(a, ((size ? size : 1) + a - 1) / a * a);
+#endif
+}
+
+void alignedFree(void* p) noexcept {
+#if defined(_WIN32)
+  _aligned_free(p);
+#else
+  std::free(p);
+#endif
+}
+
+void* throwIfNull(void* p) {
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+
+}  // namespace
+
+void* operator new(std::size_t size) { return throwIfNull(countedAlloc(size)); }
+void* operator new[](std::size_t size) { return throwIfNull(countedAlloc(size)); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+void* operator new(std::size_t size, std::align_val_t align) { return throwIfNull(countedAlignedAlloc(size, align)); }
+void* operator new[](std::size_t size, std::align_val_t align) { return throwIfNull(countedAlignedAlloc(size, align)); }
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+  return countedAlignedAlloc(size, align);
+}
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+  return countedAlignedAlloc(size, align);
+}
+void operator delete(void* p, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { alignedFree(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { alignedFree(p); }
+
+namespace {
+
+constexpr float kSampleRate = 48000.0f;
+constexpr int kBlockSizes[] = {16, 64, 100, 256, 512, 1024, 4096};
+
+struct BenchResult {
+  double nsPerSample{0};
+  double worstBlockUs{0};
+  double blockDeadlineUs{0};
+  size_t allocations{0};
+};
+
+// A repeating pattern of chords: a new chord every 250 ms, held for 200 ms,
+// with up to all of the processor's voices playing at once.
+void addNoteEvents(ml::AudioContext& ctx, uint64_t vectorStart) {
+  constexpr uint64_t kChordPeriod = uint64_t(kSampleRate / 4);
+  constexpr uint64_t kChordLength = uint64_t(kSampleRate / 5);
+  for (int i = 0; i < ml::kFloatsPerDSPVector; ++i) {
+    const uint64_t t = vectorStart + i;
+    const uint64_t chord = t / kChordPeriod;
+    const uint64_t phase = t % kChordPeriod;
+    if (phase != 0 && phase != kChordLength) continue;
+
+    const int notes = 1 + int(chord % ClapSawDemo::kNumVoices);
+    for (int n = 0; n < notes; ++n) {
+      ml::Event e;
+      e.type = (phase == 0) ? ml::kNoteOn : ml::kNoteOff;
+      e.channel = 1;
+      e.sourceIdx = 36 + int((chord * 7 + n * 5) % 48);
+      e.time = i;
+      e.value1 = float(e.sourceIdx);
+      e.value2 = (phase == 0) ? 0.8f : 0.0f;
+      ctx.addInputEvent(e);
+    }
+  }
+}
+
+BenchResult render(int blockSize, double seconds, bool useVoiceBank) {
+  ClapSawDemo processor;
+  processor.setSampleRate(kSampleRate);
+  processor.setUseVoiceBank(useVoiceBank);
+
+  ml::AudioContext ctx(0, 2, int(kSampleRate));
+  ctx.setInputPolyphony(ClapSawDemo::kNumVoices);
+  processor.setAudioContext(&ctx);
+
+  ml::DSPVectorDynamic inputs(0);
+  ml::DSPVectorDynamic outputs(2);
+
+  const uint64_t totalFrames = uint64_t(seconds * kSampleRate);
+  uint64_t framesIn = 0;
+  uint64_t vectorStart = 0;
+  double totalNs = 0;
+  double worstNs = 0;
+  float sink = 0.0f;
+
+  tAllocations = 0;
+  while (framesIn < totalFrames) {
+    // automation: sweep the cutoff once per second, set once per block as a host would.
+    const float sweep = 0.5f + 0.4f * std::sin(2.0f * ml::kPi * float(framesIn) / kSampleRate);
+
+    auto start = std::chrono::steady_clock::now();
+
+    processor.setParamFromNormalizedValue("f0", sweep);
+    framesIn += blockSize;
+
+    // process every vector completed by this block. Only allocations made while
+    // processing are counted, not those made by the harness making events.
+    while (vectorStart + ml::kFloatsPerDSPVector <= framesIn) {
+      ctx.clearInputEvents();
+      addNoteEvents(ctx, vectorStart);
+      tCountAllocations = true;
+      ctx.processVector(0);
+      processor.processVector(inputs, outputs, &ctx);
+      tCountAllocations = false;
+      sink += outputs[0][0];
+      vectorStart += ml::kFloatsPerDSPVector;
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    const double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    totalNs += ns;
+    worstNs = std::max(worstNs, ns);
+  }
+
+  BenchResult r;
+  r.nsPerSample = totalNs / double(framesIn);
+  r.worstBlockUs = worstNs * 1e-3;
+  r.blockDeadlineUs = 1e6 * blockSize / kSampleRate;
+  r.allocations = tAllocations;
+
+  // keep the output from being optimized away.
+  if (sink == 12345.0f) std::cout << " ";
+  return r;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  double seconds = 10.0;
+  double maxNsPerSample = 0.0;
+  bool failOnAllocation = false;
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "--seconds") && (i + 1 < argc)) {
+      seconds = std::atof(argv[++i]);
+    } else if (!std::strcmp(argv[i], "--max-ns-per-sample") && (i + 1 < argc)) {
+      maxNsPerSample = std::atof(argv[++i]);
+    } else if (!std::strcmp(argv[i], "--fail-on-allocation")) {
+      failOnAllocation = true;
+    } else {
+      std::cout << "usage: " << argv[0] << " [--seconds S] [--max-ns-per-sample N] [--fail-on-allocation]\n";
+      return 2;
+    }
+  }
+
+  ml::UsingFlushDenormalsToZero denormalHandler;
+  bool failed = false;
+
+  std::cout << "ClapSawDemo, " << seconds << " s of audio at " << kSampleRate << " Hz per run\n";
+  std::cout << std::setw(12) << "mode" << std::setw(8) << "block" << std::setw(14) << "ns/sample"
+            << std::setw(12) << "x realtime" << std::setw(16) << "worst block us" << std::setw(14)
+            << "deadline us" << std::setw(8) << "allocs" << "\n";
+
+  for (bool useVoiceBank : {false, true}) {
+    for (int blockSize : kBlockSizes) {
+      BenchResult r = render(blockSize, seconds, useVoiceBank);
+      std::cout << std::setw(12) << (useVoiceBank ? "voice bank" : "per voice") << std::setw(8) << blockSize
+                << std::fixed << std::setprecision(2) << std::setw(14) << r.nsPerSample << std::setw(12)
+                << 1e9 / kSampleRate / r.nsPerSample << std::setw(16) << r.worstBlockUs << std::setw(14)
+                << r.blockDeadlineUs << std::setw(8) << r.allocations << "\n";
+
+      if (failOnAllocation && r.allocations > 0) failed = true;
+      if (maxNsPerSample > 0.0 && r.nsPerSample > maxNsPerSample) failed = true;
+    }
+  }
+
+  if (failed) {
+    std::cout << "FAILED: a limit was exceeded.\n";
+  }
+  return failed ? 1 : 0;
+}
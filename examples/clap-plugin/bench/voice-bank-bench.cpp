@@ -0,0 +1,103 @@
+// Offline benchmark for the CLAP saw demo voices: the per-voice loop of
+// ClapSawDemo::processVoice() compared with SawVoiceBank.
+//
+// usage: clap-saw-demo-bench [voices]
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include "mldsp.h"
+#include "clap-saw-demo-voice-bank.h"
+
+namespace {
+
+constexpr int kNumVoices = 16;
+constexpr float kSampleRate = 48000.0f;
+constexpr int kVectors = 20000;
+
+struct VoiceDSP {
+  ml::SawGen sawOscillator;
+  ml::Lopass mLoPass;
+  ml::ADSR mADSR;
+};
+
+// the pitch of each test voice, as a MIDI note.
+float voicePitch(int v) { return 48.0f + 3.0f * v; }
+
+template <typename Fn>
+double nanosPerVector(Fn&& processOneVector, float& sink) {
+  // warm up, then time.
+  for (int i = 0; i < kVectors / 10; ++i) {
+    sink += processOneVector()[0];
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kVectors; ++i) {
+    sink += processOneVector()[0];
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() / kVectors;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  ml::UsingFlushDenormalsToZero denormalHandler;
+
+  int activeVoices = (argc > 1) ? std::atoi(argv[1]) : kNumVoices;
+  activeVoices = std::max(0, std::min(kNumVoices, activeVoices));
+
+  const float filterFreq = 2000.0f, filterQ = 3.4f;
+  const float attack = 0.01f, decay = 0.1f, sustain = 0.7f, release = 0.2f;
+
+  // held notes for the active voices, silence for the rest.
+  ml::DSPVector gates[kNumVoices], freqs[kNumVoices];
+  for (int v = 0; v < kNumVoices; ++v) {
+    gates[v] = ml::DSPVector((v < activeVoices) ? 1.0f : 0.0f);
+    freqs[v] = ml::DSPVector(440.0f * std::pow(2.0f, (voicePitch(v) - 69.0f) / 12.0f) / kSampleRate);
+  }
+
+  float sink = 0.0f;
+
+  // the per-voice loop, as in ClapSawDemo::processVoice().
+  std::array<VoiceDSP, kNumVoices> voiceDSP;
+  double perVoiceNs = nanosPerVector([&]() {
+    ml::DSPVector total{0.0f};
+    for (int v = 0; v < kNumVoices; ++v) {
+      auto& dsp = voiceDSP[v];
+      const ml::DSPVector vOscillator = dsp.sawOscillator(freqs[v]);
+      dsp.mLoPass._coeffs = ml::Lopass::makeCoeffs(filterFreq / kSampleRate, 1.0f / filterQ);
+      const ml::DSPVector vFiltered = dsp.mLoPass(vOscillator);
+      dsp.mADSR.coeffs = ml::ADSR::calcCoeffs(attack, decay, sustain, release, kSampleRate);
+      total += vFiltered * dsp.mADSR(gates[v]);
+    }
+    return total;
+  }, sink);
+
+  // the voice bank, with inputs for only the voices that need them.
+  SawVoiceBank<kNumVoices> bank;
+  double bankNs = nanosPerVector([&]() {
+    bank.setParams(filterFreq, filterQ, attack, decay, sustain, release, kSampleRate);
+    for (int v = 0; v < kNumVoices; ++v) {
+      if (bank.isGateOn(gates[v]) || bank.isVoiceActive(v)) {
+        bank.setVoiceInput(v, freqs[v], gates[v]);
+      } else {
+        bank.setVoiceSilent(v);
+      }
+    }
+    return bank.process();
+  }, sink);
+
+  const double vectorNs = 1e9 * ml::kFloatsPerDSPVector / kSampleRate;
+  std::cout << "clap-saw-demo voices: " << activeVoices << " of " << kNumVoices << " playing\n";
+  std::cout << "    per-voice loop: " << perVoiceNs << " ns/vector, "
+            << 100.0 * perVoiceNs / vectorNs << "% of one core\n";
+  std::cout << "    voice bank:     " << bankNs << " ns/vector, "
+            << 100.0 * bankNs / vectorNs << "% of one core\n";
+  std::cout << "    speedup: " << perVoiceNs / bankNs << "x\n";
+  std::cout << "(" << sink << ")\n";
+  return 0;
+}
@@ -6,7 +6,7 @@
 #include <vector>
 
 // Include embedded font resources
-#include "../build/resources/clap-saw-demo/resources.c"
+#include "../build/resources/clap-saw-demo/resources_pack.c"
 
 ClapSawDemoGUI::ClapSawDemoGUI(ClapSawDemo* processor)
   : CLAPAppView("ClapSawDemo", processor) {
@@ -168,6 +168,15 @@ void ClapSawDemoGUI::makeWidgets() {
     {"text_color", ml::colorToMatrix({ 0.01, 0.01, 0.01, 1.0 })}
   });
 
+  // Position labels under dials consistently. The dials keep the bounds they
+  // were made with, and each label follows its dial.
+  const char* dialNames[] = {"f0", "Q", "attack", "decay", "sustain", "release"};
+  for (auto dialName : dialNames) {
+    ml::Path labelName(ml::TextFragment(dialName, "_label"));
+    _layout.fixed(dialName, _view->_widgets[dialName]->getBounds());
+    _layout.under(labelName, dialName, ml::Rect(0, 0, 3, 0.4), ml::Vec2(-0.4, -0.5));
+  }
+
   // Add resize widget to bottom right corner
   _view->_widgets.add_unique<Resizer>("resizer", ml::WithValues{
     {"fix_ratio", static_cast<float>(kGridUnitsX)/static_cast<float>(kGridUnitsY)},  // Use grid constants for aspect ratio
@@ -179,30 +188,7 @@ void ClapSawDemoGUI::makeWidgets() {
 }
 
 void ClapSawDemoGUI::layoutView(ml::DrawContext dc) {
-
-  // Helper function to position labels under dials consistently
-  auto positionLabelUnderDial = [&](ml::Path dialName, ml::Path labelName) {
-    // Safety check: ensure both widgets exist before accessing them
-    if (!_view->_widgets[dialName] || !_view->_backgroundWidgets[labelName]) {
-      return;
-    }
-    ml::Rect dialRect = _view->_widgets[dialName]->getRectProperty("bounds");
-    ml::Rect labelRect(0, 0, 3, 0.4); // TODO: make this smarter, using label's bounds?
-    _view->_backgroundWidgets[labelName]->setRectProperty(
-      "bounds",
-      ml::alignCenterToPoint(labelRect, dialRect.bottomCenter() - ml::Vec2(0.4, 0.50))
-    );
-  };
-
-  // Position lopass dials
-  positionLabelUnderDial("f0", "f0_label");
-  positionLabelUnderDial("Q", "Q_label");
-
-  // Position ADSR labels
-  positionLabelUnderDial("attack", "attack_label");
-  positionLabelUnderDial("decay", "decay_label");
-  positionLabelUnderDial("sustain", "sustain_label");
-  positionLabelUnderDial("release", "release_label");
+  // the labels are placed by the layout rules made in makeWidgets().
 }
 
 // void ClapSawDemoGUI::loadFontFromFile(NativeDrawContext* nvg, const std::string& fontName, const std::string& filePath) {
@@ -267,9 +253,14 @@ void ClapSawDemoGUI::initializeResources(NativeDrawContext* nvg) {
   _drawingProperties.setProperty("small_dial_height", 2.5f);
 
   // Load embedded fonts (essential for text to work properly)
-  // These fonts are embedded as C arrays and loaded directly from memory
-  _resources.fonts["d_din"] = std::make_unique<ml::FontResource>(nvg, "d_din", resources::D_DIN_otf, resources::D_DIN_otf_size, 0);
-  _resources.fonts["d_din_italic"] = std::make_unique<ml::FontResource>(nvg, "d_din_italic", resources::D_DIN_Italic_otf, resources::D_DIN_Italic_otf_size, 0);
+  // These fonts are found by name in the embedded resource pack and loaded directly from memory
+  _resourcePack = std::make_unique<ml::ResourcePack>(resources::pack, resources::pack_size);
+  _resources.pack = _resourcePack.get();
+  auto din = _resourcePack->find("D-DIN");
+  auto dinItalic = _resourcePack->find("D-DIN-Italic");
+  _resources.fonts["d_din"] = std::make_unique<ml::FontResource>(nvg, "d_din", din.data, int(din.size), 0);
+  _resources.fonts["d_din_italic"] = std::make_unique<ml::FontResource>(nvg, "d_din_italic", dinItalic.data, int(dinItalic.size), 0);
+  _resources.changed();
 
   // // Helpful for debugging layout
   // _drawingProperties.setProperty("draw_widget_bounds", true);
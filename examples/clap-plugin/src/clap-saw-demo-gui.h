@@ -30,6 +30,8 @@ public:
   void initializeResources(NativeDrawContext* nvg) override;
 
 private:
+  // Resources compiled in as one pack
+  std::unique_ptr<ml::ResourcePack> _resourcePack;
 
   // Helper function to load fonts from disk
   // void loadFontFromFile(NativeDrawContext* nvg, const std::string& fontName, const std::string& filePath);
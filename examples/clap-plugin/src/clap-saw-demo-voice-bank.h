@@ -0,0 +1,216 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "mldsp.h"
+
+// The saw -> lopass -> ADSR voices of ClapSawDemo, with the state of all voices
+// stored as a structure of arrays and processed one SIMD vector of voices at a
+// time: 4 voices per group with SSE or NEON, 8 with AVX. Each step is branch-free,
+// using masks to choose between envelope stages. A group whose voices are all
+// silent is skipped.
+//
+// As with ml::ADSR, the gate's level when it is on, typically the note's velocity,
+// scales the envelope, and is held through the release.
+//
+// Inputs are given per voice, then interleaved so that each sample of a group's
+// inputs is one contiguous SIMD vector.
+template <int VOICES>
+class SawVoiceBank {
+public:
+  static constexpr int kLanes = ml::kFloatsPerSIMDVector;
+  static constexpr int kGroups = VOICES / kLanes;
+  static_assert(VOICES % kLanes == 0, "SawVoiceBank: voices must fill whole groups");
+
+  // the envelope level below which a released voice is silent.
+  static constexpr float kSilence = 1e-4f;
+
+  // set the parameters shared by all voices. Times are in seconds.
+  void setParams(float cutoffHz, float q, float attack, float decay, float sustain, float release, float sr) {
+    // SVF lowpass coefficients, as in ml::Lopass, with k = 1/Q.
+    const float g = std::tan(ml::kPi * cutoffHz / sr);
+    const float k = 1.0f / q;
+    coeffA1 = 1.0f / (1.0f + g * (g + k));
+    coeffA2 = g * coeffA1;
+    coeffA3 = g * coeffA2;
+
+    // linear attack, exponential decay and release.
+    attackStep = 1.0f / std::max(attack * sr, 1.0f);
+    decayCoeff = 1.0f - std::exp(-1.0f / std::max(decay * sr, 1.0f));
+    sustainLevel = sustain;
+    releaseCoeff = 1.0f - std::exp(-1.0f / std::max(release * sr, 1.0f));
+  }
+
+  // true if the voice is still sounding and needs input to continue.
+  bool isVoiceActive(int v) const {
+    const Group& g = groups[v / kLanes];
+    return g.gateOn[v % kLanes] || (g.env[v % kLanes] > kSilence);
+  }
+
+  int getActiveVoiceCount() const {
+    int n = 0;
+    for (int v = 0; v < VOICES; ++v) {
+      n += isVoiceActive(v);
+    }
+    return n;
+  }
+
+  static bool isGateOn(const ml::DSPVector& gate) {
+    const float* pGate = gate.getConstBuffer();
+    float sum = 0.0f;
+    for (int i = 0; i < ml::kFloatsPerDSPVector; ++i) {
+      sum += pGate[i];
+    }
+    return sum > 0.0f;
+  }
+
+  // set the inputs of a voice for the next vector: frequency / sample rate, and gate.
+  void setVoiceInput(int v, const ml::DSPVector& freqNorm, const ml::DSPVector& gate) {
+    Group& g = groups[v / kLanes];
+    const int lane = v % kLanes;
+    const float* pFreq = freqNorm.getConstBuffer();
+    const float* pGate = gate.getConstBuffer();
+    for (int i = 0; i < ml::kFloatsPerDSPVector; ++i) {
+      g.freq[i][lane] = pFreq[i];
+      g.gate[i][lane] = pGate[i];
+    }
+    g.gateOn[lane] = isGateOn(gate);
+  }
+
+  // set a voice's gate off for the next vector, leaving its frequency.
+  void setVoiceSilent(int v) {
+    Group& g = groups[v / kLanes];
+    const int lane = v % kLanes;
+    if (!g.gateOn[lane] && (g.gate[0][lane] == 0.0f)) return;
+    for (int i = 0; i < ml::kFloatsPerDSPVector; ++i) {
+      g.gate[i][lane] = 0.0f;
+    }
+    g.gateOn[lane] = false;
+  }
+
+  // process all active groups and return the sum of all voices.
+  ml::DSPVector process() {
+    std::fill(&mix[0][0], &mix[0][0] + ml::kFloatsPerDSPVector * kLanes, 0.0f);
+    for (auto& g : groups) {
+      bool active = false;
+      for (int l = 0; l < kLanes; ++l) {
+        active |= g.gateOn[l] || (g.env[l] > kSilence);
+      }
+      if (active) {
+        processGroup(g);
+      }
+    }
+
+    // sum the lanes.
+    ml::DSPVector out;
+    float* pOut = out.getBuffer();
+    for (int i = 0; i < ml::kFloatsPerDSPVector; ++i) {
+      float sum = 0.0f;
+      for (int l = 0; l < kLanes; ++l) {
+        sum += mix[i][l];
+      }
+      pOut[i] = sum;
+    }
+    return out;
+  }
+
+private:
+  struct Group {
+    // interleaved inputs: [sample][lane]
+    alignas(sizeof(SIMDVectorFloat)) float freq[ml::kFloatsPerDSPVector][kLanes]{};
+    alignas(sizeof(SIMDVectorFloat)) float gate[ml::kFloatsPerDSPVector][kLanes]{};
+
+    // state
+    alignas(sizeof(SIMDVectorFloat)) float phase[kLanes]{};
+    alignas(sizeof(SIMDVectorFloat)) float ic1[kLanes]{};
+    alignas(sizeof(SIMDVectorFloat)) float ic2[kLanes]{};
+    alignas(sizeof(SIMDVectorFloat)) float env[kLanes]{};
+    alignas(sizeof(SIMDVectorFloat)) float decaying[kLanes]{};
+    alignas(sizeof(SIMDVectorFloat)) float level[kLanes]{};
+    bool gateOn[kLanes]{};
+  };
+
+  static SIMDVectorFloat select(SIMDVectorFloat mask, SIMDVectorFloat a, SIMDVectorFloat b) {
+    return vecOr(vecAnd(mask, a), vecAndNot(mask, b));
+  }
+
+  // process one group, adding each lane's output to mix.
+  void processGroup(Group& g) {
+    const SIMDVectorFloat zero = vecZeros();
+    const SIMDVectorFloat one = vecSet1(1.0f);
+    const SIMDVectorFloat two = vecSet1(2.0f);
+    const SIMDVectorFloat a2 = vecSet1(coeffA2);
+    const SIMDVectorFloat a3 = vecSet1(coeffA3);
+    const SIMDVectorFloat a2x2 = vecSet1(2.0f * coeffA2);
+    const SIMDVectorFloat a3x2 = vecSet1(2.0f * coeffA3);
+    const SIMDVectorFloat m22 = vecSet1(1.0f - coeffA3);
+    const SIMDVectorFloat c11 = vecSet1(2.0f * coeffA1 - 1.0f);
+    const SIMDVectorFloat c12 = vecSet1(-2.0f * coeffA2);
+    const SIMDVectorFloat c22 = vecSet1(1.0f - 2.0f * coeffA3);
+    const SIMDVectorFloat attackInc = vecSet1(attackStep);
+    const SIMDVectorFloat decayK = vecSet1(decayCoeff);
+    const SIMDVectorFloat sustainV = vecSet1(sustainLevel);
+    const SIMDVectorFloat releaseK = vecSet1(releaseCoeff);
+
+    SIMDVectorFloat phase = vecLoad(g.phase);
+    SIMDVectorFloat ic1 = vecLoad(g.ic1);
+    SIMDVectorFloat ic2 = vecLoad(g.ic2);
+    SIMDVectorFloat env = vecLoad(g.env);
+    SIMDVectorFloat decaying = vecLoad(g.decaying);
+    SIMDVectorFloat level = vecLoad(g.level);
+
+    for (int i = 0; i < ml::kFloatsPerDSPVector; ++i) {
+      // saw with polyBLEP at the wrap.
+      const SIMDVectorFloat dt = vecLoad(g.freq[i]);
+      SIMDVectorFloat t = vecAdd(phase, dt);
+      t = vecSub(t, vecAnd(vecGreaterThanOrEqual(t, one), one));
+      phase = t;
+      const SIMDVectorFloat invDt = vecDiv(one, vecMax(dt, vecSet1(1e-9f)));
+      const SIMDVectorFloat x0 = vecMul(t, invDt);
+      const SIMDVectorFloat x1 = vecMul(vecSub(t, one), invDt);
+      const SIMDVectorFloat blep0 = vecSub(vecMul(x0, vecSub(two, x0)), one);
+      const SIMDVectorFloat blep1 = vecAdd(vecMul(x1, vecAdd(x1, two)), one);
+      SIMDVectorFloat blep = vecAnd(vecGreaterThan(t, vecSub(one, dt)), blep1);
+      blep = select(vecLessThan(t, dt), blep0, blep);
+      const SIMDVectorFloat saw = vecSub(vecSub(vecMul(two, t), one), blep);
+
+      // SVF lowpass. The update is expanded so that the state depends on
+      // itself through one multiply and two adds.
+      const SIMDVectorFloat v2 = vecAdd(vecAdd(vecMul(a2, ic1), vecMul(m22, ic2)), vecMul(a3, saw));
+      const SIMDVectorFloat newIc1 = vecAdd(vecAdd(vecMul(c11, ic1), vecMul(a2x2, saw)), vecMul(c12, ic2));
+      const SIMDVectorFloat newIc2 = vecAdd(vecAdd(vecMul(a2x2, ic1), vecMul(a3x2, saw)), vecMul(c22, ic2));
+      ic1 = newIc1;
+      ic2 = newIc2;
+
+      // ADSR, scaled by the level of the gate while it is on.
+      const SIMDVectorFloat gate = vecLoad(g.gate[i]);
+      const SIMDVectorFloat on = vecGreaterThan(gate, zero);
+      level = select(on, gate, level);
+      const SIMDVectorFloat attackEnv = vecMin(vecAdd(env, attackInc), one);
+      const SIMDVectorFloat decayEnv = vecAdd(env, vecMul(vecSub(sustainV, env), decayK));
+      const SIMDVectorFloat releaseEnv = vecSub(env, vecMul(env, releaseK));
+      const SIMDVectorFloat isDecaying = vecGreaterThan(decaying, zero);
+      env = select(on, select(isDecaying, decayEnv, attackEnv), releaseEnv);
+      decaying = vecAnd(on, vecOr(decaying, vecAnd(vecGreaterThanOrEqual(env, one), one)));
+
+      vecStore(mix[i], vecAdd(vecLoad(mix[i]), vecMul(v2, vecMul(env, level))));
+    }
+
+    vecStore(g.phase, phase);
+    vecStore(g.ic1, ic1);
+    vecStore(g.ic2, ic2);
+    vecStore(g.env, env);
+    vecStore(g.decaying, decaying);
+    vecStore(g.level, level);
+  }
+
+  // the sum of the groups' outputs for each lane: [sample][lane]
+  alignas(sizeof(SIMDVectorFloat)) float mix[ml::kFloatsPerDSPVector][kLanes];
+
+  std::array<Group, kGroups> groups;
+
+  float coeffA1{0.0f}, coeffA2{0.0f}, coeffA3{0.0f};
+  float attackStep{1.0f}, decayCoeff{1.0f}, sustainLevel{1.0f}, releaseCoeff{1.0f};
+};
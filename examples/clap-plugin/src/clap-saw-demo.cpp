@@ -30,14 +30,20 @@ void ClapSawDemo::processVector(const ml::DSPVectorDynamic& inputs, ml::DSPVecto
   // Buffer process voices to generate audio.
   ml::DSPVector totalOutput{0.0f};
 
-  // Process all voices - use the same pattern as mltemplate
-  const int maxVoices = std::min(static_cast<int>(voiceDSP.size()), audioContext->getInputPolyphony());
-
-  for (int v = 0; v < maxVoices; ++v) {
-    // Process voice - follow Sumu's pattern exactly: always process, let processVoice handle activity
-    auto& voice = const_cast<ml::EventsToSignals::Voice&>(audioContext->getInputVoice(v));
-    ml::DSPVector voiceOutput = processVoice(v, voice, audioContext);
-    totalOutput += voiceOutput;
+  if (useVoiceBank) {
+    totalOutput = processVoiceBank(audioContext);
+  } else {
+    // Process all voices - use the same pattern as mltemplate
+    const int maxVoices = std::min(static_cast<int>(voiceDSP.size()), audioContext->getInputPolyphony());
+
+    // counted by processVoice().
+    activeVoiceCount = 0;
+    for (int v = 0; v < maxVoices; ++v) {
+      // Process voice - follow Sumu's pattern exactly: always process, let processVoice handle activity
+      auto& voice = const_cast<ml::EventsToSignals::Voice&>(audioContext->getInputVoice(v));
+      ml::DSPVector voiceOutput = processVoice(v, voice, audioContext);
+      totalOutput += voiceOutput;
+    }
   }
 
   // Apply gain parameter
@@ -52,6 +58,42 @@ void ClapSawDemo::processVector(const ml::DSPVectorDynamic& inputs, ml::DSPVecto
 }
 
 
+ml::DSPVector ClapSawDemo::processVoiceBank(ml::AudioContext* audioContext) {
+  const float sr = audioContext->getSampleRate();
+  if (sr <= 0.0f) {
+    return ml::DSPVector{0.0f};
+  }
+
+  // Parameters are shared by all voices, so read them once per vector.
+  float filterFreq = std::max(10.0f, std::min(10000.0f, this->getRealFloatParam("f0")));
+  float filterQ = std::max(0.01f, std::min(10.0f, this->getRealFloatParam("Q")));
+  voiceBank.setParams(filterFreq, filterQ,
+                      this->getRealFloatParam("attack"), this->getRealFloatParam("decay"),
+                      this->getRealFloatParam("sustain"), this->getRealFloatParam("release"), sr);
+
+  // Give the bank inputs for voices that are playing or still releasing.
+  const int maxVoices = std::min(kNumVoices, audioContext->getInputPolyphony());
+  for (int v = 0; v < kNumVoices; ++v) {
+    if (v < maxVoices) {
+      const auto& voice = audioContext->getInputVoice(v);
+      const ml::DSPVector vGate = voice.outputs.row(ml::kGate);
+      if (voiceBank.isGateOn(vGate) || voiceBank.isVoiceActive(v)) {
+        const ml::DSPVector vPitch = voice.outputs.row(ml::kPitch);
+        const ml::DSPVector vPitchOffset = vPitch - ml::DSPVector(69.0f);
+        const ml::DSPVector vPitchRatio = pow(ml::DSPVector(2.0f), vPitchOffset * ml::DSPVector(1.0f/12.0f));
+        const ml::DSPVector vFreqNorm = ml::DSPVector(440.0f / sr) * vPitchRatio;
+        voiceBank.setVoiceInput(v, vFreqNorm, vGate);
+        continue;
+      }
+    }
+    voiceBank.setVoiceSilent(v);
+  }
+
+  ml::DSPVector output = voiceBank.process();
+  activeVoiceCount = voiceBank.getActiveVoiceCount();
+  return output;
+}
+
 ml::DSPVector ClapSawDemo::processVoice(int voiceIndex, ml::EventsToSignals::Voice& voice, ml::AudioContext* audioContext) {
   // Bounds check to prevent crashes
   if (voiceIndex < 0 || voiceIndex >= voiceDSP.size()) {
@@ -104,6 +146,13 @@ ml::DSPVector ClapSawDemo::processVoice(int voiceIndex, ml::EventsToSignals::Voi
   const ml::DSPVector vEnvelope = voiceDSP[voiceIndex].mADSR(vGate);
   const ml::DSPVector vOutput = vFiltered * vEnvelope;
 
+  // The voice is active while its gate is on or its release is still sounding,
+  // as in the voice bank.
+  using Bank = SawVoiceBank<kNumVoices>;
+  if (Bank::isGateOn(vGate) || (vEnvelope.getConstBuffer()[ml::kFloatsPerDSPVector - 1] > Bank::kSilence)) {
+    activeVoiceCount++;
+  }
+
   return vOutput;
 }
 
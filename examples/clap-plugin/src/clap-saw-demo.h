@@ -1,6 +1,7 @@
 #pragma once
 
 #include "CLAPExport.h"  // Includes madronalib core + CLAPSignalProcessor base class
+#include "clap-saw-demo-voice-bank.h"
 
 #ifdef HAS_GUI
 class ClapSawDemoGUI;
@@ -23,6 +24,12 @@ private:
   };
   std::array<VoiceDSP, kNumVoices> voiceDSP;
 
+  // The same voices processed in SIMD groups. Used instead of voiceDSP
+  // when useVoiceBank is true. Its saw and envelope are close to ml::SawGen
+  // and ml::ADSR but not the same, so it is off by default.
+  SawVoiceBank<kNumVoices> voiceBank;
+  bool useVoiceBank = false;
+
   // Simple voice activity tracking for CLAP
   int activeVoiceCount = 0;
 
@@ -41,6 +48,9 @@ public:
 
   void setAudioContext(ml::AudioContext* ctx) { audioContext = ctx; }
 
+  // Choose between the SIMD voice bank and the per-voice loop.
+  void setUseVoiceBank(bool b) { useVoiceBank = b; }
+
   // Voice activity for CLAP sleep/continue
   bool hasActiveVoices() const override { return activeVoiceCount > 0; }
 
@@ -51,5 +61,6 @@ public:
 
 private:
   // Helper methods go here
+  ml::DSPVector processVoiceBank(ml::AudioContext* audioContext);
   ml::DSPVector processVoice(int voiceIndex, ml::EventsToSignals::Voice& voice, ml::AudioContext* audioContext);
 };
@@ -18,6 +18,7 @@
 #include "parameters.h"
 
 #include <cmath>
+#include <cstring>
 #include <iostream>
 
 #include "MLSerialization.h"
@@ -30,6 +31,9 @@ namespace llllpluginnamellll {
 FUID PluginController::uid(0xAAAAAAAA, 0xAAAAAAAA, 0xAAAAAAAA, 0xAAAAAAAA);
 
 const char* vstBinaryAttrID{"b"};
+const char* kSignalRingMessageID{"signal_ring"};
+const char* kSignalRingNameAttrID{"name"};
+const char* kSignalRingIDAttrID{"ring"};
 
 //-----------------------------------------------------------------------------
 // PluginController implementation
@@ -51,49 +55,27 @@ tresult PLUGIN_API PluginController::notify(IMessage* message)
 {
   if (!message) return kInvalidArgument;
 
-  const char * signalName = message->getMessageID();
-  
-  // could add signal header if we want to send any other messages
-  
-  const void* messageData;
-  uint32 messageSizeInBytes;
-    
-  if (message->getAttributes()->getBinary(vstBinaryAttrID, messageData, messageSizeInBytes) == kResultOk)
+  if (!strcmp(message->getMessageID(), kSignalRingMessageID))
   {
-    //std::cout  << "notify: received " << signalName << ", " << messageSizeInBytes << " bytes\n";
-    
-    const float * pFloatData = reinterpret_cast< const float* >(messageData);
-    
-    if(messageSizeInBytes > sizeof(float))
+    // the processor is sharing the ring for one of its published signals.
+    // after this no messages are needed: signal viewers read the ring directly.
+    const void* nameData;
+    uint32 nameSizeInBytes;
+    int64 ringID{0};
+    if ((message->getAttributes()->getBinary(kSignalRingNameAttrID, nameData, nameSizeInBytes) == kResultOk) &&
+        (message->getAttributes()->getInt(kSignalRingIDAttrID, ringID) == kResultOk))
     {
-      // get signal width
-      size_t signalWidthInChannels = pFloatData[0];
-      if(signalWidthInChannels)
-      {
-        // lazily make DSPBuffer if needed
-        if(!_signalsFromProcessor[signalName])
-        {
-            _signalsFromProcessor[signalName] = ml::make_unique< DSPBuffer >();
-            
-            // set buffer size in frames
-            _signalsFromProcessor[signalName]->resize(kPublishedSignalBufferSize*signalWidthInChannels);
-            
-            // set signal width info
-            //_processorSignalWidths[signalName] = VECTORS;
-           std::cout  << "        made buffer for " << signalName << ", " << signalWidthInChannels << " channels\n";
-        }
+      // share the ring registered by the processor. If the processor is
+      // in another process, there is no ring for the id.
+      auto ring = SignalRingHandle::find(uint64_t(ringID));
+      if(!ring) return kResultFalse;
       
-        // write message data to DSPBuffer
-        DSPBuffer* sigBuf = _signalsFromProcessor[signalName].get();
-        size_t samplesInMessage = (messageSizeInBytes - sizeof(float))/sizeof(float);
-
-        sigBuf->write(pFloatData + 1, samplesInMessage);
-    
-        //std::cout  << "        writing " << signalName << ", " << samplesInMessage << " samples\n";
-      }
+      std::string nameStr(static_cast< const char* >(nameData), nameSizeInBytes);
+      Path signalName(nameStr.c_str());
+      _signalsFromProcessor[signalName] = ring;
+      
+      return kResultOk;
     }
-    
-    return kResultOk;
   }
 
   return EditController::notify(message);
@@ -22,6 +22,12 @@ const int kChangeQueueSize = 128;
 
 extern const char* vstBinaryAttrID;
 
+// message sent once per published signal by the processor, with the signal's
+// name and the id of a SignalRingHandle the controller finds the ring with.
+extern const char* kSignalRingMessageID;
+extern const char* kSignalRingNameAttrID;
+extern const char* kSignalRingIDAttrID;
+
 
 //-----------------------------------------------------------------------------
 class PluginController : public EditController, public PropertyTree
@@ -77,7 +83,8 @@ public:
   ParameterDescription* getParamDescriptionByPath(Path paramName);
   ParameterDescription* getParamDescriptionByIndex(int i);
   
-  DSPBuffer* getSignalFromProcessor(Symbol signalName) { return _signalsFromProcessor[signalName].get(); }
+  // get the ring for a signal published by the processor, or nullptr if it has not arrived.
+  SignalRing* getSignalFromProcessor(Symbol signalName) { return _signalsFromProcessor[signalName].get(); }
 
 
 // TEMP public
@@ -100,8 +107,8 @@ private:
   
   Tree< int > _paramIDsByName;
   
-  // signals received from processor for signal viewers, transmitters, etc
-  Tree< std::unique_ptr < DSPBuffer > > _signalsFromProcessor;
+  // signals shared by the processor for signal viewers, transmitters, etc
+  Tree< std::shared_ptr < SignalRing > > _signalsFromProcessor;
 
   SharedResourcePointer< ml::Timers > _timers ;
   
@@ -15,7 +15,6 @@
 #include "MLSVGImage.h"
 #include "MLRegLabel.h"
 #include "MLMeter.h"
-#include "MLScope.h"
 #include "MLFPSMeter.h"
 #include "MLPopup.h"
 
@@ -62,7 +61,7 @@ _platformHandle(platformHandle)
     {"indicator", {250, 228, 116, 255} },
     {"label", "freq left" },
     {"param", "freq_l" },
-    {"signalName", "freq_l_mod"} // TEST
+    {"signal_name", "freq_l_mod"} // TEST
   } );
   
   _widgets["freq_r"] = ml::make_unique<Dial>(WithValues{
@@ -93,12 +92,12 @@ _platformHandle(platformHandle)
   /*
    _widgets["input_meter"] = ml::make_unique<Meter>(WithValues{
    {"bounds", {0.625, 1.5, 1, 0.75} },
-   {"signalName", "input_meter"}
+   {"signal_name", "input_meter"}
    } );
    
    _widgets["output_meter"] = ml::make_unique<Meter>(WithValues{
    {"bounds", {14.375, 1.5, 1, 0.75} },
-   {"signalName", "output_meter"}
+   {"signal_name", "output_meter"}
    } );
    */
   
@@ -110,9 +109,14 @@ _platformHandle(platformHandle)
     {"anchor", {1, 1}} // for fixed-size widgets, anchor is a point on the view from top left {0, 0} to bottom right {1, 1}.
   } );
   
-  _widgets["scope"] = ml::make_unique<Scope>(WithValues{
+  _widgets["scope"] = ml::make_unique<SignalView>(WithValues{
     {"bounds", {11, 2, 3, 1}},
-    {"signalName", "scope"}
+    {"signal_name", "scope"}
+  } );
+  
+  _widgets["spectrum"] = ml::make_unique<SpectrumView>(WithValues{
+    {"bounds", {11, 3, 3, 1}},
+    {"spectrum_name", "spectrum"}
   } );
   
   // for each parameter, send description to Widgets and collect a list of Widgets that respond to it
@@ -605,21 +609,54 @@ void PluginEditorView::updateWidgets()
   
   // send published signals to widgets
   
-  for(auto& w : _widgets)
+  // make a Matrix for a reader if it does not have the right size.
+  auto sizeBlock = [](SignalReader& reader, size_t width, size_t height)
+  {
+    if((reader.block.getWidth() != width) || (reader.block.getHeight() != height))
+    {
+      reader.block = Matrix(width, height);
+    }
+  };
+  
+  for(auto it = _widgets.begin(); it != _widgets.end(); ++it)
   {
-    if(w->getProperty("signalName"))
+    auto& w = *it;
+    if(w->getProperty("signal_name"))
     {
-      Text sigName = w->getTextProperty("signalName");
-      auto buf = _controller.getSignalFromProcessor(sigName); // again remove API TODO controller sends changed signals via messages
-      if(buf)
+      Text sigName = w->getTextProperty("signal_name");
+      SignalRing* ring = _controller.getSignalFromProcessor(sigName);
+      if(ring)
       {
-        if(buf->getReadAvailable())
+        // each block has one DSPVector per channel, which is the layout of a
+        // Matrix with one row of frames per channel, so blocks are read right
+        // into the Widget's Matrix. Only blocks the processor did not write
+        // over while we copied them are sent.
+        SignalReader& reader = _signalReaders[it.getCurrentPath()];
+        sizeBlock(reader, kFloatsPerDSPVector, ring->getNumChannels());
+        while(ring->read(reader.readSequence, reader.block.getBuffer(), 1).blocksRead)
         {
-          // the widget can use DSPBuffer.peekMostRecent() to view the signal without clearing it
-          w->processSignal(*buf);
-          
-          // discard the oldest signal, more slowly than it will be used by the widget.
-          buf->discard(kFloatsPerDSPVector*4);
+          w->processPublishedSignal(Value(reader.block), "signal");
+        }
+      }
+    }
+    else if(w->getProperty("spectrum_name"))
+    {
+      // a spectrum's ring has one block of magnitudes per frame, made by the
+      // processor's analysis worker. Send the newest frame, if any.
+      Text sigName = w->getTextProperty("spectrum_name");
+      SignalRing* ring = _controller.getSignalFromProcessor(sigName);
+      if(ring)
+      {
+        SignalReader& reader = _signalReaders[it.getCurrentPath()];
+        uint64_t writeSeq = ring->getWriteSequence();
+        if(writeSeq > reader.readSequence)
+        {
+          reader.readSequence = writeSeq - 1;
+          sizeBlock(reader, ring->getBlockSizeInFloats(), 1);
+          if(ring->read(reader.readSequence, reader.block.getBuffer(), 1).blocksRead)
+          {
+            w->processPublishedSignal(Value(reader.block), "spectrum");
+          }
         }
       }
     }
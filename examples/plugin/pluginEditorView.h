@@ -12,6 +12,8 @@
 #include "MLRenderer.h"
 #include "MLWidget.h"
 #include "MLView.h"
+#include "MLSignalView.h"
+#include "MLSpectrumView.h"
 
 #include "pluginController.h"
 
@@ -135,6 +137,16 @@ private:
   Vec2 _clickAndHoldStartPosition;
 
   PluginController& _controller;
+  
+  // each Widget's read position in the ring of the signal it shows, so that
+  // Widgets showing the same signal each get all of its blocks, and a Matrix
+  // that the blocks are read into, made once.
+  struct SignalReader
+  {
+    uint64_t readSequence{0};
+    Matrix block;
+  };
+  Tree< SignalReader > _signalReaders;
 
   void* _platformHandle{ nullptr };
   
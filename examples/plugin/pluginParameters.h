@@ -7,6 +7,7 @@
 #include "mldsp.h"
 #include "madronalib.h"
 #include "MLPropertyTree.h" // TODO add to madronalib
+#include "MLParameterRamps.h"
 
 constexpr int kPublishedSignalBufferSize = 1024;
 
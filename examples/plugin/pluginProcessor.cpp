@@ -13,8 +13,10 @@
 #include "pluginterfaces/base/ibstream.h"
 #include "base/source/fstreamer.h"
 
+#include <cassert>
 #include <cmath>
 #include <cstdlib>
+#include <cstring>
 #include <math.h>
 #include <iostream>
 
@@ -48,12 +50,23 @@ PluginProcessor::PluginProcessor()
   // make normalized <-> real projections
   createProjections(_parameterDescriptions);
   
+  size_t nParams = _parameterDescriptions.size();
+  _paramRamps.resize(nParams + 1);
+  _stateToApply = std::make_unique< std::atomic< float >[] >(nParams);
+  _blockEndValues = std::make_unique< std::atomic< float >[] >(nParams);
+  _stateValues.resize(nParams);
   setParameterDefaults();
+  
+  _gainID = getRequiredParamID("gain");
+  _freqLID = getRequiredParamID("freq_l");
+  _freqRID = getRequiredParamID("freq_r");
+  _bypassID = getRequiredParamID("bypass");
+  _freqLLfoRateID = getRequiredParamID("freq_l/lfo/rate");
+  _freqLLfoAmountID = getRequiredParamID("freq_l/lfo/amount");
 }
 
 PluginProcessor::~PluginProcessor()
 {
-  _ioTimer.stop();
 }
 
 tresult PLUGIN_API PluginProcessor::initialize(FUnknown* context)
@@ -77,19 +90,28 @@ tresult PLUGIN_API PluginProcessor::initialize(FUnknown* context)
   publishSignal("scope", 2, 2);
   publishSignal("input_meter", 2, 4);
   publishSignal("output_meter", 2, 4);
-  
-  _ioTimer.start([=](){sendPublishedSignalsToController();}, milliseconds(1000/60));
+  publishSpectrum("spectrum", 2048, 512);
 
   return kResultOk;
 }
 
 tresult PLUGIN_API PluginProcessor::terminate()
 {
+  _analysisWorker.stop();
   return AudioEffect::terminate();
 }
 
 tresult PLUGIN_API PluginProcessor::setActive(TBool state)
 {
+  // analyze published spectra only while processing.
+  if(state)
+  {
+    _analysisWorker.start(kAnalysisPeriodInMs);
+  }
+  else
+  {
+    _analysisWorker.stop();
+  }
   return AudioEffect::setActive(state);
 }
 
@@ -101,6 +123,7 @@ tresult PLUGIN_API PluginProcessor::process(ProcessData& data)
   // processEvents(data.inputEvents);
   
   processSignals(data);
+  publishBlockEndValues();
   
   return kResultTrue;
 }
@@ -112,13 +135,18 @@ tresult PLUGIN_API PluginProcessor::setState(IBStream* state)
   // let's use the Steinberg streaming class
   IBStreamer streamer(state, kLittleEndian);
 
-  for(auto& p : _parameterDescriptions)
+  for(size_t id = 0; id < _parameterDescriptions.size(); ++id)
   {
-    Path paramName = p->getTextProperty("name");
+    Path paramName = _parameterDescriptions[id]->getTextProperty("name");
     float fTemp;
     streamer.readFloat(fTemp);
     setProperty(paramName, fTemp);
+    _stateValues[id] = fTemp;
+    
+    // the audio thread may be reading the ramps, so they are set there.
+    _stateToApply[id].store(fTemp, std::memory_order_relaxed);
   }
+  _stateCount.fetch_add(1, std::memory_order_release);
   
 std::cout << "PluginProcessor SET STATE: \n";
 dump();
@@ -131,10 +159,19 @@ tresult PLUGIN_API PluginProcessor::getState(IBStream* state)
   // here we need to save the model
   IBStreamer streamer(state, kLittleEndian);
  
-  for(auto& p : _parameterDescriptions)
+  // once a block has applied the last state set, the values at its end are
+  // current. Until then, the values of that state are.
+  if(_blockEndStateCount.load(std::memory_order_acquire) == _stateCount.load(std::memory_order_relaxed))
+  {
+    for(size_t id = 0; id < _parameterDescriptions.size(); ++id)
+    {
+      _stateValues[id] = _blockEndValues[id].load(std::memory_order_relaxed);
+    }
+  }
+  
+  for(size_t id = 0; id < _parameterDescriptions.size(); ++id)
   {
-    Path paramName = p->getTextProperty("name");
-    streamer.writeFloat(getFloatProperty(paramName));
+    streamer.writeFloat(_stateValues[id]);
   }
   
   std::cout << "PluginProcessor GET STATE: \n";
@@ -186,12 +223,37 @@ tresult PLUGIN_API PluginProcessor::notify(IMessage* message)
   return AudioEffect::notify(message);
 }
 
+tresult PLUGIN_API PluginProcessor::connect(IConnectionPoint* other)
+{
+  tresult result = AudioEffect::connect(other);
+  if(result == kResultTrue)
+  {
+    sendSignalRingsToController();
+  }
+  return result;
+}
+
 // --------------------------------------------------------------------------------
 // private implementation
 
 
+// add every point of each parameter change in the block to the parameter's ramp.
+// This runs on the audio thread, so it must not look up names, log or allocate.
 bool PluginProcessor::processParameterChanges(IParameterChanges* changes)
 {
+  _paramRamps.beginBlock(_blockStartTime);
+  
+  // values from setState() come first, so the host's changes in this block apply after them.
+  uint32_t stateCount = _stateCount.load(std::memory_order_acquire);
+  if(stateCount != _appliedStateCount)
+  {
+    for(size_t id = 0; id < _parameterDescriptions.size(); ++id)
+    {
+      _paramRamps.setValue(id, _stateToApply[id].load(std::memory_order_relaxed));
+    }
+    _appliedStateCount = stateCount;
+  }
+  
   if(changes)
   {
     int32 numParamsChanged = changes->getParameterCount();
@@ -202,28 +264,20 @@ bool PluginProcessor::processParameterChanges(IParameterChanges* changes)
       IParamValueQueue* paramQueue = changes->getParameterData(i);
       if(paramQueue)
       {
-        ParamValue value;
-        int32 sampleOffset;
         int32 numPoints = paramQueue->getPointCount();
         int32 id = paramQueue->getParameterId();
         
-        // TODO sample-accurate, smoothing
-        
-//        if (ml::within(id, 0, (int)_parameterDescriptions.size()))
         if ((id >= 0) && (id < _parameterDescriptions.size()))
-          {
+        {
           ParameterDescription* pDesc = _parameterDescriptions[id].get();
-          
-          Path paramName = pDesc->getTextProperty("name");
-          if(paramName)
+          for(int32 j = 0; j < numPoints; ++j)
           {
-            if(paramQueue->getPoint(numPoints - 1, sampleOffset, value) == kResultTrue)
+            ParamValue value;
+            int32 sampleOffset;
+            if(paramQueue->getPoint(j, sampleOffset, value) == kResultTrue)
             {
-              // convert the normalized value to the real value and set the property.
-              // DEBUG
-              std::cout << "PluginProcessor: setting " << paramName << " to " << pDesc->normalizedToReal(value) << "\n";
-              
-              setProperty(paramName, pDesc->normalizedToReal(value));
+              // convert the normalized value to the real value at each point.
+              _paramRamps.addPoint(id, _blockStartTime + sampleOffset, pDesc->normalizedToReal(value));
             }
           }
         }
@@ -243,9 +297,50 @@ void PluginProcessor::setParameterDefaults()
     if(paramName)
     {
       float defaultVal = pDesc->getFloatProperty("default");
-      setProperty(paramName, pDesc->normalizedToReal(defaultVal));
+      float realVal = pDesc->normalizedToReal(defaultVal);
+      setProperty(paramName, realVal);
+      _paramRamps.setValue(id, realVal);
+      _stateToApply[id].store(realVal);
+      _blockEndValues[id].store(realVal);
+      _stateValues[id] = realVal;
+    }
+  }
+}
+
+size_t PluginProcessor::getParamID(Path paramName) const
+{
+  for(size_t id = 0; id < _parameterDescriptions.size(); ++id)
+  {
+    if(Path(_parameterDescriptions[id]->getTextProperty("name")) == paramName)
+    {
+      return id;
     }
   }
+  return _parameterDescriptions.size();
+}
+
+// get the ID of a parameter used in processVectors(). A missing parameter is a
+// bug in parameters.h. In release builds it gets the extra ramp, which is 0.
+size_t PluginProcessor::getRequiredParamID(Path paramName) const
+{
+  size_t id = getParamID(paramName);
+  if(id >= _parameterDescriptions.size())
+  {
+    std::cout << "PluginProcessor: no parameter " << paramName << "!\n";
+    assert(false);
+  }
+  return id;
+}
+
+// write the value of each parameter at the end of the block, for getState().
+// This runs on the audio thread.
+void PluginProcessor::publishBlockEndValues()
+{
+  for(size_t id = 0; id < _parameterDescriptions.size(); ++id)
+  {
+    _blockEndValues[id].store(_paramRamps.getValue(id), std::memory_order_relaxed);
+  }
+  _blockEndStateCount.store(_appliedStateCount, std::memory_order_release);
 }
 
 void PluginProcessor::publishSignal(Symbol signalName, int channels, int octavesDown)
@@ -267,39 +362,58 @@ void PluginProcessor::storePublishedSignal(Symbol signalName, DSPVectorArray< CH
   }
 }
 
-void PluginProcessor::sendPublishedSignalsToController()
+void PluginProcessor::publishSpectrum(Symbol signalName, int fftSize, int hop)
 {
-  for(auto it = _publishedSignals.begin(); it != _publishedSignals.end(); ++it)
-  {
-    Symbol signalName = it.getCurrentNodeName();
-    const std::unique_ptr < PublishedSignal >& publishedSignal = *it;
-    size_t samplesAvailable = publishedSignal->getReadAvailable();
-    
-    if(samplesAvailable)
-    {
-      if (IPtr<IMessage> message = owned(allocateMessage()))
-      {
-        message->setMessageID (signalName.getUTF8Ptr());
-        
-        // add space for signal width
-        size_t dataSize = samplesAvailable + 1;
-
-        // MLTEST
-        // alloc temp space for read
-        std::vector<float> tempVec(dataSize);
-        
-        // write # of channels for controller
-        tempVec[0] = publishedSignal->getNumChannels();
-        
-        // read floats from downsampled signal to temp space
-        publishedSignal->read(tempVec.data() + 1, samplesAvailable);
+  auto spectrum = ml::make_unique< PublishedSpectrum >(fftSize, hop);
+  _analysisWorker.add(spectrum->getAnalyzer());
+  _publishedSpectra[signalName] = std::move(spectrum);
+}
 
-        // make binary message - this copies the data to the message
-        message->getAttributes()->setBinary(vstBinaryAttrID, tempVec.data(), dataSize*sizeof(float));
+// write a vector of raw input to the named spectrum. No analysis is done here.
+void PluginProcessor::storePublishedSpectrum(Symbol signalName, const DSPVector& v)
+{
+  PublishedSpectrum* publishedSpectrum = _publishedSpectra[signalName].get();
+  if(publishedSpectrum)
+  {
+    publishedSpectrum->write(v);
+  }
+}
 
-        sendMessage(message);
-      }
+// The rings are shared by SignalRingHandle, which requires the processor and controller
+// to be in the same process. This is true for all the hosts we know of, but the
+// VST3 spec allows otherwise. In that case the controller will get no signals.
+void PluginProcessor::sendSignalRingsToController()
+{
+  // rings sent on an earlier connection are no longer needed.
+  _signalRingHandles.clear();
+  
+  auto sendRing = [&](Symbol signalName, std::shared_ptr< SignalRing > ring)
+  {
+    if (IPtr<IMessage> message = owned(allocateMessage()))
+    {
+      message->setMessageID (kSignalRingMessageID);
+      const char* pName = signalName.getUTF8Ptr();
+      message->getAttributes()->setBinary(kSignalRingNameAttrID, pName, strlen(pName));
+      
+      // the controller finds the ring by the handle's id. We keep the handle,
+      // so if the message is never delivered the ring is freed with us.
+      _signalRingHandles.emplace_back(ring);
+      message->getAttributes()->setInt(kSignalRingIDAttrID, int64(_signalRingHandles.back().getID()));
+      sendMessage(message);
     }
+  };
+  
+  for(auto it = _publishedSignals.begin(); it != _publishedSignals.end(); ++it)
+  {
+    const std::unique_ptr < PublishedSignal >& publishedSignal = *it;
+    sendRing(it.getCurrentNodeName(), publishedSignal->getRing());
+  }
+  
+  // for spectra, the controller gets the magnitude frames.
+  for(auto it = _publishedSpectra.begin(); it != _publishedSpectra.end(); ++it)
+  {
+    const std::unique_ptr < PublishedSpectrum >& publishedSpectrum = *it;
+    sendRing(it.getCurrentNodeName(), publishedSpectrum->getRing());
   }
 }
 
@@ -322,6 +436,7 @@ void PluginProcessor::processSignals(ProcessData& data)
 
   // run buffered processing
   processBuffer.process(inputs, outputs, data.numSamples, processFn);
+  _blockStartTime += data.numSamples;
 
   // test
   // static periodicAction()
@@ -341,16 +456,20 @@ void PluginProcessor::processSignals(ProcessData& data)
 // It is called every time a new buffer of audio is needed.
 DSPVectorArray<kOutputChannels> PluginProcessor::processVectors(const DSPVectorArray<kInputChannels>& inputVectors)
 {
-  float fGain = getFloatProperty("gain");
-  float fFreqL = getFloatProperty("freq_l");
-  float fFreqR = getFloatProperty("freq_r");
-  int bBypass = getFloatProperty("bypass");
+  // get the parameter values for this vector as ramps.
+  _paramRamps.processVector(_vectorStartTime);
+  _vectorStartTime += kFloatsPerDSPVector;
+  
+  const DSPVector& gain = _paramRamps.getRamp(_gainID);
+  const DSPVector& freqL = _paramRamps.getRamp(_freqLID);
+  const DSPVector& freqR = _paramRamps.getRamp(_freqRID);
+  int bBypass = _paramRamps.getValue(_bypassID);
 
-  float fFreqLLfoRate = getFloatProperty("freq_l/lfo/rate");
-  float fFreqLLfoAmount = getFloatProperty("freq_l/lfo/amount");
+  const DSPVector& freqLLfoRate = _paramRamps.getRamp(_freqLLfoRateID);
+  float fFreqLLfoAmount = _paramRamps.getValue(_freqLLfoAmountID);
 
   // testing LFO just sampled once per vector here
-  auto lfoOscL = lfoL1(fFreqLLfoRate/_sampleRate);
+  auto lfoOscL = lfoL1(freqLLfoRate/_sampleRate);
   auto lfoOscUnipolar = 0.5f*(1.0f + lfoOscL); // [0 - 1]
   float fLfoL = lfoOscUnipolar[0] * fFreqLLfoAmount;
   float m = powf(2.0f, fLfoL);
@@ -358,8 +477,8 @@ DSPVectorArray<kOutputChannels> PluginProcessor::processVectors(const DSPVectorA
   // Running the sine generators makes DSPVectors as output.
   // The input parameter is omega: the frequency in Hz divided by the sample rate.
   // The output sines are multiplied by the gain.
-  auto sineL = s1(fFreqL*m/_sampleRate)*fGain;
-  auto sineR = s2(fFreqR/_sampleRate)*fGain;
+  auto sineL = s1(freqL*m/_sampleRate)*gain;
+  auto sineR = s2(freqR/_sampleRate)*gain;
   
   // store published output signals to they can be read later by subscribers.
   // currently DSP graph nodes don't have names, except in the context of this function, so
@@ -379,11 +498,12 @@ DSPVectorArray<kOutputChannels> PluginProcessor::processVectors(const DSPVectorA
     //  storePublishedSignal("input_meter", append(mRMSInL(inputL), mRMSInR(inputR)));
     //  storePublishedSignal("output_meter", append(mRMSOutL(outputL), mRMSOutR(outputR)));
 
-    storePublishedSignal("freq_l_mod", DSPVector(fFreqL*m));
+    storePublishedSignal("freq_l_mod", freqL*m);
 
     storePublishedSignal("input_meter", concatRows(test1, test2));
     storePublishedSignal("output_meter", concatRows(test2, test1));
     storePublishedSignal("scope", concatRows(sineL, sineR));
+    storePublishedSpectrum("spectrum", sineL);
     
     // appending the two DSPVectors makes a DSPVectorArray<2>: our stereo output.
     return concatRows(sineL, sineR);
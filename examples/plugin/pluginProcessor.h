@@ -12,9 +12,13 @@
 #include "madronalib.h"
 #include "MLPlatform.h"
 #include "pluginParameters.h"
+#include "MLSignalRing.h"
+#include "MLSpectrumAnalyzer.h"
 
 #include "MLDebug.h"
 
+#include <atomic>
+
 extern void* gHINSTANCE;
 
 using namespace ml;
@@ -30,6 +34,9 @@ constexpr int kMaxProcessBlockFrames = 4096;
 constexpr int kInputChannels = 2;
 constexpr int kOutputChannels = 2;
 
+// how often the analysis worker looks for new input to published spectra.
+constexpr int kAnalysisPeriodInMs = 10;
+
 
 //-----------------------------------------------------------------------------
 class PluginProcessor : public AudioEffect, public PropertyTree
@@ -52,6 +59,7 @@ public:
   tresult PLUGIN_API setBusArrangements(SpeakerArrangement* inputs, int32 numIns, SpeakerArrangement* outputs, int32 numOuts) SMTG_OVERRIDE;
   tresult PLUGIN_API canProcessSampleSize(int32 symbolicSampleSize) SMTG_OVERRIDE;
   tresult PLUGIN_API notify(IMessage* message) SMTG_OVERRIDE;
+  tresult PLUGIN_API connect(IConnectionPoint* other) SMTG_OVERRIDE;
   
 private:
   bool processParameterChanges(IParameterChanges* changes);
@@ -73,6 +81,33 @@ private:
   
   float _sampleRate{0.f};
   
+  // parameter values for each vector, indexed by parameter ID. There is one
+  // more ramp than parameters, always 0, for any parameter that is missing.
+  ParameterRamps _paramRamps;
+  
+  // values set by setState() on the host's thread, to be set in the ramps on
+  // the audio thread at the start of the next block. Each setState() counts
+  // a new state after writing all of its values, so a state that the audio
+  // thread reads while it is being written is applied again the next block.
+  std::unique_ptr< std::atomic< float >[] > _stateToApply;
+  std::atomic< uint32_t > _stateCount{0};
+  uint32_t _appliedStateCount{0};
+  
+  // the value of each parameter at the end of the last block, written on the
+  // audio thread, and the count of the last state applied before it.
+  std::unique_ptr< std::atomic< float >[] > _blockEndValues;
+  std::atomic< uint32_t > _blockEndStateCount{0};
+  
+  // the host's copy of the current values, which getState() writes.
+  std::vector< float > _stateValues;
+  
+  // IDs of the parameters used in processVectors().
+  size_t _gainID, _freqLID, _freqRID, _bypassID, _freqLLfoRateID, _freqLLfoAmountID;
+  
+  // the input time in samples of the next host block and of the next vector processed.
+  uint64_t _blockStartTime{0};
+  uint64_t _vectorStartTime{0};
+  
   // sine generators.
   SineGen s1, s2;
   
@@ -89,25 +124,28 @@ private:
   
   // private methods
   void setParameterDefaults();
+  size_t getParamID(Path paramName) const;
+  size_t getRequiredParamID(Path paramName) const;
+  void publishBlockEndValues();
   
+  // a published signal is downsampled on the audio thread and written to a
+  // SignalRing that the controller reads directly.
   class PublishedSignal
   {
     Downsampler _downsampler;
-    DSPBuffer _buffer;
-    size_t _channels{0};
+    std::shared_ptr< SignalRing > _ring;
     
   public:
     PublishedSignal(int channels, int octavesDown) :
       _downsampler(channels, octavesDown),
-      _channels(channels)
+      _ring(std::make_shared< SignalRing >(channels, kPublishedSignalBufferSize/kFloatsPerDSPVector))
     {
-      _buffer.resize(kPublishedSignalBufferSize*_channels);
     }
     
     ~PublishedSignal() = default;
     
-    size_t getNumChannels() { return _channels; }
-    int getReadAvailable() { return _buffer.getReadAvailable(); }
+    size_t getNumChannels() { return _ring->getNumChannels(); }
+    std::shared_ptr< SignalRing > getRing() { return _ring; }
     
     // write a single vector of data.
     template< size_t CHANNELS >
@@ -115,14 +153,9 @@ private:
     {
       if(_downsampler.write(v))
       {
-        _buffer.write(_downsampler.read< CHANNELS >());
+        _ring->write(_downsampler.read< CHANNELS >());
       }
     }
-    
-    int read(float* pDest, size_t framesRequested)
-    {
-      return _buffer.read(pDest, framesRequested);
-    }
   };
   
   Tree< std::unique_ptr < PublishedSignal > > _publishedSignals;
@@ -132,12 +165,41 @@ private:
   template< size_t CHANNELS >
   void storePublishedSignal(Symbol signalName, DSPVectorArray< CHANNELS > v);
 
-  void sendPublishedSignalsToController();
-  
+  // a published spectrum is written raw on the audio thread. The analysis
+  // worker reads the raw frames and writes magnitude frames to a ring of
+  // its own, which is the one the controller reads.
+  class PublishedSpectrum
+  {
+    std::shared_ptr< SignalRing > _input;
+    std::shared_ptr< SpectrumAnalyzer > _analyzer;
+    
+  public:
+    PublishedSpectrum(int fftSize, int hop) :
+      _input(std::make_shared< SignalRing >(1, std::max(kPublishedSignalBufferSize, fftSize*2)/kFloatsPerDSPVector)),
+      _analyzer(std::make_shared< SpectrumAnalyzer >(_input, fftSize, hop))
+    {
+    }
+    
+    ~PublishedSpectrum() = default;
+    
+    std::shared_ptr< SignalRing > getRing() { return _analyzer->getOutput(); }
+    std::shared_ptr< SpectrumAnalyzer > getAnalyzer() { return _analyzer; }
+    
+    // write a single vector of data.
+    void write(const DSPVector& v) { _input->write(v.getConstBuffer()); }
+  };
   
-  ml::Timer _ioTimer;
+  Tree< std::unique_ptr < PublishedSpectrum > > _publishedSpectra;
+  AnalysisWorker _analysisWorker;
   
+  void publishSpectrum(Symbol signalName, int fftSize, int hop);
+  void storePublishedSpectrum(Symbol signalName, const DSPVector& v);
+
+  // send each published signal's ring to the controller, once.
+  void sendSignalRingsToController();
   
+  // handles for the rings sent, which keep them findable by the controller.
+  std::vector< SignalRingHandle > _signalRingHandles;
 };
 
 }}} // namespaces
@@ -5,6 +5,8 @@
 // See LICENSE.txt for details.
 
 #include "MLAppView.h"
+#include "MLFiles.h"
+#include "MLProfiler.h"
 
 namespace ml {
 
@@ -22,6 +24,11 @@ AppView::AppView(TextFragment appName, size_t instanceNum)
 
   // stash in object
   appName_ = appName;
+  _creationTime = steady_clock::now();
+  
+  // decode images once for all instances.
+  _resources.sharedAssets = _sharedAssets;
+  _resourceLoader.setSharedAssetCache(_sharedAssets);
 }
 
 AppView::~AppView()
@@ -31,7 +38,25 @@ AppView::~AppView()
 
 // called when native view size changes in the PlatformView callback.
 // newSize is in pixel coordinates. displayScale is pixels per system size unit.
-void AppView::viewResized(NativeDrawContext* nvg, Vec2 newSize, float displayScale)
+void AppView::viewResized(NativeDrawContext* nvg, Vec2 newSize, float displayScale, bool contentsKept)
+{
+  _requestedSize = newSize;
+  _requestedDisplayScale = displayScale;
+  
+  // if a layout is put off, the contents must have been kept through every
+  // resize until it is done.
+  _contentsKept = (_liveResize.isPending() ? _contentsKept : true) && contentsKept;
+  
+  // during a live resize, leave the layout to animate() so it can be throttled.
+  if(_liveResize.isActive() && _liveResizePreview)
+  {
+    _liveResize.request(steady_clock::now());
+    return;
+  }
+  _layoutAtSize(nvg, newSize, displayScale);
+}
+
+void AppView::_layoutAtSize(NativeDrawContext* nvg, Vec2 newSize, float displayScale)
 {
   float gridSizeInPixels{0};
   
@@ -56,6 +81,7 @@ void AppView::viewResized(NativeDrawContext* nvg, Vec2 newSize, float displaySca
   }
   
   Vec2 origin (0, 0);
+  GUICoordinates previousCoords = _GUICoordinates;
   _GUICoordinates = {gridSizeInPixels, newSize, displayScale, origin};
   
   // set bounds for top-level View in grid coordinates
@@ -67,7 +93,60 @@ void AppView::viewResized(NativeDrawContext* nvg, Vec2 newSize, float displaySca
   DrawContext dc{nvg, &_resources, &_drawingProperties, _GUICoordinates};
   layoutView(dc);
   
-  _view->setDirty(true);
+  // if the scale is the same and the backing layer kept what was drawn to it
+  // in place, only the Widgets that moved and any newly exposed area need to
+  // be redrawn. Otherwise, redraw everything.
+  bool sameScale = (gridSizeInPixels == previousCoords.gridSizeInPixels) && (displayScale == previousCoords.displayScale);
+  bool movedOnly = _layout.getNumRules() && sameScale && _contentsKept;
+  _contentsKept = false;
+  if(!_applyLayout(dc, movedOnly) || !_view->exposeResizedArea(dc, previousCoords.viewSizeInPixels))
+  {
+    _view->setDirty(true);
+  }
+}
+
+bool AppView::_applyLayout(DrawContext dc, bool movedOnly)
+{
+  if(!_layout.getNumRules()) return false;
+  
+  // without a fixed ratio, lay out in the whole grid units that fit.
+  Vec2 gridSize = _view->getBounds().dims();
+  if(!aspectRatioIsFixed_)
+  {
+    gridSize = Vec2(floorf(gridSize.x()), floorf(gridSize.y()));
+  }
+  _layout.setViewSize(gridSize);
+  
+  bool backgroundMoved{false};
+  for(const Path& name : _layout.solve())
+  {
+    Rect bounds = _layout.getBounds(name);
+    if(const auto& pw = _view->_widgets[name])
+    {
+      // the Widget's old area is redrawn along with its new one.
+      pw->setProperty("previous_bounds", rectToMatrix(pw->getBounds()));
+      pw->setBounds(bounds);
+      pw->resize(dc);
+      pw->setDirty(true);
+    }
+    else if(const auto& pbw = _view->_backgroundWidgets[name])
+    {
+      // background Widgets are only drawn with the whole background.
+      pbw->setBounds(bounds);
+      pbw->resize(dc);
+      backgroundMoved = true;
+    }
+  }
+  
+  if(movedOnly && !backgroundMoved) return true;
+  
+  // everything will be redrawn, so every Widget may need resizing.
+  forEach< Widget >
+  (_view->_widgets, [&](Widget& w)
+   {
+    w.resize(dc);
+  });
+  return false;
 }
 
 void AppView::layoutFixedSizeWidgets_()
@@ -88,7 +167,12 @@ void AppView::layoutFixedSizeWidgets_()
       Vec4 systemWidgetBounds = w.getRectProperty("fixed_bounds");
       systemWidgetBounds = translate(systemWidgetBounds, systemAnchor);
       ml::Rect gridWidgetBounds = _GUICoordinates.systemToGrid(systemWidgetBounds);
-      w.setBounds(gridWidgetBounds);
+      if(gridWidgetBounds != w.getBounds())
+      {
+        w.setProperty("previous_bounds", rectToMatrix(w.getBounds()));
+        w.setBounds(gridWidgetBounds);
+        w.setDirty(true);
+      }
     }
   }
    );
@@ -120,6 +204,7 @@ void AppView::_setupWidgets(const ParameterDescriptionList& pdl)
   _widgetsByParameter.clear();
   _widgetsByCollection.clear();
   _widgetsBySignal.clear();
+  _widgetsBySpectrum.clear();
 
   // build index of widgets by parameter.
   // for each parameter, collect Widgets responding to it
@@ -176,6 +261,14 @@ void AppView::_setupWidgets(const ParameterDescriptionList& pdl)
         sendMessageToActor(_controllerName, Message{"do/subscribe_to_signal", pathToText(sigName)});
       }
     }
+    
+    // a spectrum is subscribed to like a signal, but its frames are magnitudes.
+    if(w->hasProperty("spectrum_name"))
+    {
+      const Path sigName(w->getTextProperty("spectrum_name"));
+      _widgetsBySpectrum[sigName].push_back(w.get());
+      sendMessageToActor(_controllerName, Message{"do/subscribe_to_signal", pathToText(sigName)});
+    }
   }
   
   // give each Widget a chance to do setup now: after it has its
@@ -195,11 +288,13 @@ void AppView::clearWidgets()
 // and handling any returned Messages.
 void AppView::_handleGUIEvents()
 {
+  ML_PROFILE_SCOPE("AppView::handleGUIEvents");
   // doResizeIfNeeded();
 
-  while (_inputQueue.elementsAvailable())
+  // consecutive drags and scrolls are coalesced by the queue as they are popped.
+  GUIEvent e;
+  while (_inputQueue.pop(e))
   {
-    auto e = _inputQueue.pop();
     GUIEvent nativeEvent = _detectDoubleClicks(e);
     GUIEvent gridEvent(nativeEvent);
     gridEvent.position = _GUICoordinates.pixelToGrid(gridEvent.position);
@@ -209,8 +304,18 @@ void AppView::_handleGUIEvents()
     
     // The top-level processGUIEvent call.
     // Send input events to all Widgets in our View and handle any resulting messages.
+    // Widgets changed by the messages are marked with the event's input time.
+    _currentInputTime = gridEvent.enqueueTime;
     enqueueMessageList(_view->processGUIEvent(_GUICoordinates, gridEvent));
     handleMessagesInQueue();
+    _currentInputTime = InputTime{};
+    
+    // a mouse up anywhere ends a live resize, even if the Widget that began it
+    // did not get the event.
+    if(e.type == "up")
+    {
+      endLiveResize();
+    }
   }
 }
 
@@ -230,6 +335,7 @@ void AppView::_sendParameterMessageToWidgets(const Message& msg)
       if(!pw->engaged)
       {
         sendMessageExpectingReply(*pw, msg, &replies);
+        pw->markInputTime(_currentInputTime);
       }
     }
     
@@ -246,6 +352,7 @@ void AppView::_sendParameterMessageToWidgets(const Message& msg)
             Path wildCardMessageAddress("set_param", "*",
                                         lastN(pname, pname.getSize() - _currentModalParam.getSize()));
             sendMessageExpectingReply(*pw, {wildCardMessageAddress, msg.value}, &replies);
+            pw->markInputTime(_currentInputTime);
 
           }
         }
@@ -310,31 +417,98 @@ size_t AppView::_getElapsedTime()
   return elapsedTime;
 }
 
+void AppView::dumpResourceUsage()
+{
+  _resources.dumpResourceUsage(std::cout);
+}
+
 void AppView::animate(NativeDrawContext* nvg)
 {
+    // evict resources over budget now and then, outside of any frame.
+    constexpr uint32_t kFramesPerEvictionCheck{ 30 };
+    _resources.frame++;
+    if(_resources.frame % kFramesPerEvictionCheck == 0)
+    {
+      _resources.evictToBudget();
+    }
+
+    _updateLiveResize(nvg);
+    
+    // move any Widgets whose layout rules changed since the last frame.
+    if(_layout.needsSolve() && (_GUICoordinates.gridSizeInPixels > 0))
+    {
+      DrawContext layoutContext{nvg, &_resources, &_drawingProperties, _GUICoordinates};
+      if(!_applyLayout(layoutContext, true))
+      {
+        _view->setDirty(true);
+      }
+    }
+    
     // Allow Widgets to draw any needed animations outside of main nvgBeginFrame().
     // Do animations and handle any resulting messages immediately.
     DrawContext dc{nvg, &_resources, &_drawingProperties, _GUICoordinates };
     MessageList ml = _view->animate((int)_getElapsedTime(), dc);
     enqueueMessageList(ml);
     handleMessagesInQueue();
+
+    // add any resources that have finished decoding, and redraw everything
+    // that may have been drawn without them.
+    if(_resourceLoader.installReadyResources(nvg, _resources))
+    {
+      _view->setDirty(true);
+    }
+
+    // upload whatever changed in streaming images since the last frame.
+    for(auto& img : _resources.streamingImages)
+    {
+      if(img) img->upload();
+    }
 }
 
 void AppView::render(NativeDrawContext* nvg)
 {
+  bool collectRenderStats = _drawingProperties.getBoolPropertyWithDefault("collect_render_stats", false);
+  if(collectRenderStats)
+  {
+    _renderStats.attach(nvg);
+  }
+  else if(_renderStats.isAttached())
+  {
+    _renderStats.detach();
+  }
+  
   // TODO move resource types into Renderer, DrawContext points to Renderer
-  DrawContext dc{nvg, &_resources, &_drawingProperties, _GUICoordinates};
+  DrawContext dc{nvg, &_resources, &_drawingProperties, _GUICoordinates, &_latencyMonitor,
+    collectRenderStats ? &_renderStats : nullptr};
 
   auto layerSize = _GUICoordinates.viewSizeInPixels;
   if((layerSize.x() == 0) || (layerSize.y() == 0))
   {
     return;
   }
-  ml::Rect topViewBounds = dc.coords.gridToPixel(_view->getBounds());
   
-  // begin the frame on the backing layer
-  int w = layerSize.x();
-  int h = layerSize.y();
+  // during a live resize, draw the last full frame scaled to the new size.
+  if(_liveResizePreview)
+  {
+    ml::Rect layerBounds(0, 0, _requestedSize.x(), _requestedSize.y());
+    nvgSave(nvg);
+    nvgResetTransform(nvg);
+    nvgResetScissor(nvg);
+    nvgBeginPath(nvg);
+    nvgRect(nvg, layerBounds);
+    nvgFillPaint(nvg, drawableImagePattern(nvg, *_liveResizePreview, layerBounds));
+    nvgFill(nvg);
+    nvgRestore(nvg);
+    return;
+  }
+  
+  _drawView(dc);
+}
+
+void AppView::_drawView(const DrawContext& dc)
+{
+  NativeDrawContext* nvg = getNativeContext(dc);
+  ml::Rect topViewBounds = dc.coords.gridToPixel(_view->getBounds());
   
   // translate the draw context to top level view bounds and draw.
   nvgIntersectScissor(nvg, topViewBounds);
@@ -346,6 +520,153 @@ void AppView::render(NativeDrawContext* nvg)
   _view->setDirty(false);
 }
 
+void AppView::_updateLiveResize(NativeDrawContext* nvg)
+{
+  // lay out at most every live_resize_interval ms while resizing, and right
+  // away once the resize is over.
+  float intervalInMs = _drawingProperties.getFloatPropertyWithDefault("live_resize_interval", 100.f);
+  float timeoutInMs = _drawingProperties.getFloatPropertyWithDefault("live_resize_timeout", 1000.f);
+  if(_liveResize.update(steady_clock::now(), intervalInMs, timeoutInMs))
+  {
+    _layoutAtSize(nvg, _requestedSize, _requestedDisplayScale);
+    _previewNeedsUpdate = true;
+  }
+  
+  if(_liveResize.isActive())
+  {
+    if(!_liveResizePreview || _previewNeedsUpdate)
+    {
+      _drawLiveResizePreview(nvg);
+    }
+  }
+  else if(_liveResizePreview)
+  {
+    // the resize is over: redraw everything at full quality.
+    if(_resources.framebuffers)
+    {
+      _resources.framebuffers->release(std::move(_liveResizePreview));
+    }
+    _liveResizePreview = nullptr;
+    _view->setDirty(true);
+  }
+}
+
+// draw a full frame at the current layout to the preview image.
+void AppView::_drawLiveResizePreview(NativeDrawContext* nvg)
+{
+  int w = _GUICoordinates.viewSizeInPixels.x();
+  int h = _GUICoordinates.viewSizeInPixels.y();
+  if((w == 0) || (h == 0)) return;
+  
+  if(_resources.framebuffers)
+  {
+    _resources.framebuffers->resize(_liveResizePreview, w, h);
+  }
+  else if(!_liveResizePreview || !_liveResizePreview->fits(w, h))
+  {
+    _liveResizePreview = std::make_unique< DrawableImage >(nvg, w, h);
+  }
+  _liveResizePreview->setUsedSize(w, h);
+  
+  DrawContext dc{nvg, &_resources, &_drawingProperties, _GUICoordinates};
+  drawToImage(_liveResizePreview.get());
+  nvgBeginFrame(nvg, w, h, 1.0f);
+  _view->setDirty(true);
+  _drawView(dc);
+  nvgEndFrame(nvg);
+  drawToImage(nullptr);
+  _previewNeedsUpdate = false;
+}
+
+void AppView::setFramebufferPool(FramebufferPool* pool)
+{
+  // the preview may come from the old pool, and must go before the draw context does.
+  if(pool != _resources.framebuffers)
+  {
+    _liveResizePreview = nullptr;
+  }
+  _resources.framebuffers = pool;
+}
+
+void AppView::framePresented()
+{
+  _latencyMonitor.framePresented();
+  
+  if(!_timeToAllResourcesInMs)
+  {
+    double ms = duration< double, std::milli >(steady_clock::now() - _creationTime).count();
+    if(!_timeToFirstFrameInMs)
+    {
+      _timeToFirstFrameInMs = ms;
+    }
+    if(!_resourceLoader.getPendingCount())
+    {
+      _timeToAllResourcesInMs = ms;
+    }
+  }
+  
+  if(_renderStats.isAttached())
+  {
+    _renderStats.endFrame();
+    _updateRenderStatsReport();
+  }
+}
+
+// slow reverse lookup of a Widget's name in a View and any Views it contains.
+static Path findWidgetPath(View& view, const void* target)
+{
+  Path p, r;
+  forEachChild< Widget >
+  (view._widgets, [&](Widget& w)
+   {
+    if(r) return;
+    if(&w == target)
+    {
+      r = p;
+    }
+    else if(View* pSubView = dynamic_cast< View* >(&w))
+    {
+      Path q = findWidgetPath(*pSubView, target);
+      if(q) r = Path(p, q);
+    }
+  }, &p
+   );
+  return r;
+}
+
+void AppView::_updateRenderStatsReport()
+{
+  // for debugging only: name lookups are slow, so only name the top few Widgets.
+  constexpr size_t kMaxWidgetsInReport{16};
+  
+  const auto& widgetStats = _renderStats.getFrameWidgetStats();
+  _renderStatsReport.frame = _renderStats.getFrameStats();
+  _renderStatsReport.widgets.clear();
+  for(size_t i = 0; i < std::min(widgetStats.size(), kMaxWidgetsInReport); ++i)
+  {
+    _renderStatsReport.widgets.push_back({findWidgetPath(*_view, widgetStats[i].widget), widgetStats[i].stats});
+  }
+}
+
+void AppView::debugAppView()
+{
+  if(_drawingProperties.getBoolPropertyWithDefault("debug_input_latency", false))
+  {
+    _latencyMonitor.dump(std::cout);
+  }
+  
+  if(_drawingProperties.getBoolPropertyWithDefault("collect_render_stats", false))
+  {
+    // the report is written on the render thread, so this may be torn. OK for debugging.
+    constexpr size_t kWidgetsToPrint{5};
+    std::cout << "render stats: " << _renderStatsReport.frame << "\n";
+    for(size_t i = 0; i < std::min(_renderStatsReport.widgets.size(), kWidgetsToPrint); ++i)
+    {
+      std::cout << "    " << _renderStatsReport.widgets[i].first << ": " << _renderStatsReport.widgets[i].second << "\n";
+    }
+  }
+}
+
 // _GUICoordinates
 
 void AppView::startTimersAndActor()
@@ -461,6 +782,31 @@ void AppView::onMessage(Message msg)
     {
       switch(hash(second(msg.address)))
       {
+        case(hash("begin_live_resize")):
+        {
+          beginLiveResize();
+          break;
+        }
+        case(hash("end_live_resize")):
+        {
+          endLiveResize();
+          break;
+        }
+#if ML_PROFILER
+        case(hash("dump_profile")):
+        {
+          // write the profiler's spans as Chrome trace JSON, to the path
+          // in the message value if there is one.
+          TextFragment pathText = msg.value.getTextValue();
+          if(!pathText.lengthInBytes())
+          {
+            pathText = filePathToText(Path(FileUtils::getUserDataPath(), "mlvg-trace.json"));
+          }
+          bool OK = Profiler::instance().writeChromeTrace(pathText.getText());
+          std::cout << "dump_profile: " << pathText << (OK ? "" : " failed") << "\n";
+          break;
+        }
+#endif
         default:
         {
           // if the message is not from the controller,
@@ -474,6 +820,21 @@ void AppView::onMessage(Message msg)
       }
       break;
     }
+    case(hash("signal")):
+    {
+      // frames of a published signal. Send them to the Widgets that view the
+      // signal, with the type each Widget subscribed to it as.
+      Path sigName = tail(msg.address);
+      for(Widget* w : _widgetsBySignal[sigName])
+      {
+        w->processPublishedSignal(msg.value, "signal");
+      }
+      for(Widget* w : _widgetsBySpectrum[sigName])
+      {
+        w->processPublishedSignal(msg.value, "spectrum");
+      }
+      break;
+    }
     default:
     {
       // try to forward the message to another receiver
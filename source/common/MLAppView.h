@@ -7,9 +7,15 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "MLActor.h"
 #include "MLDrawContext.h"
 #include "MLGUIEvent.h"
+#include "MLGUIEventQueue.h"
+#include "MLLayout.h"
+#include "MLLiveResizeThrottle.h"
+#include "MLResourceLoader.h"
 #include "MLView.h"
 #include "MLWidget.h"
 
@@ -22,9 +28,11 @@ public:
   // pure virtual methods that subclasses must implement:
   //
   // initialize resources such as images, needed to draw the View.
+  // call _resources.changed() after replacing any existing resources.
   virtual void initializeResources(NativeDrawContext* nvg) = 0;
   //
-  // clear all resources that could depend on the draw context.
+  // clear all resources that could depend on the draw context, then
+  // call _resources.changed().
   virtual void clearResources() = 0;
   //
   // set the bounds of all the Widgets.
@@ -42,8 +50,13 @@ public:
   virtual void animate(NativeDrawContext* nvg);
   virtual void render(NativeDrawContext* nvg);
   
-  // called by the PlatformView to set our size in pixel coordinates.
-  void viewResized(NativeDrawContext* nvg, Vec2 newSize, float displayScale);
+  // called by the PlatformView after the frame drawn by render() is visible.
+  void framePresented();
+  
+  // called by the PlatformView to set our size in pixel coordinates. If the
+  // backing layer kept what was drawn to it in place, contentsKept is true and
+  // only what changed is redrawn.
+  void viewResized(NativeDrawContext* nvg, Vec2 newSize, float displayScale, bool contentsKept = false);
   
   const GUICoordinates& getCoords() { return _GUICoordinates; }
 
@@ -76,15 +89,62 @@ public:
   
   Vec2 constrainSize(Vec2 size) const;
   
+  // time from input events entering the queue to the frames that show them.
+  const InputLatencyMonitor& getInputLatencyMonitor() const { return _latencyMonitor; }
+  
+  // rendering stats for the last presented frame, collected if the drawing
+  // property "collect_render_stats" is set. A RenderStatsView can show these
+  // if it is sent a pointer to the report named "render_stats".
+  const RenderStatsReport& getRenderStatsReport() const { return _renderStatsReport; }
+  
+  // time from making the AppView to its first frame being presented, and to the
+  // first frame with all the resources from the ResourceLoader. Zero until known.
+  // These may be read from any thread, for example by a startup benchmark.
+  double getTimeToFirstFrameInMs() const { return _timeToFirstFrameInMs; }
+  double getTimeToAllResourcesInMs() const { return _timeToAllResourcesInMs; }
+  
+  // set the most memory that regenerable resources, such as images made from the
+  // resource pack, may use. Past this the least recently used are evicted. Zero,
+  // the default, means no limit.
+  void setResourceBudget(size_t bytes) { _resources.budgetInBytes = bytes; }
+  
+  // called by the PlatformView to share its framebuffer pool, or with nullptr
+  // before the pool and the draw context are deleted. Its stats are printed by
+  // dumpResourceUsage().
+  void setFramebufferPool(FramebufferPool* pool);
+  
+  // during a live resize, such as a Resizer drag, size changes are laid out at
+  // most every "live_resize_interval" ms, 100 by default. Frames in between show
+  // the last full frame scaled to the new size. When the live resize ends, the
+  // view is laid out and redrawn at full quality. A mouse up anywhere ends it, as
+  // does "live_resize_timeout" ms, 1000 by default, without a size change.
+  void beginLiveResize() { _liveResize.begin(steady_clock::now()); }
+  void endLiveResize() { _liveResize.end(); }
+  
+  // print the memory used by each kind of resource to std::cout.
+  void dumpResourceUsage();
+  
   void onMessage(Message msg);
   
 protected:
   
+  // decoded images shared by all the AppViews in the process.
+  SharedResourcePointer< SharedAssetCache > _sharedAssets;
+  
   // main view and top-level things.
   // order is important for default destructor!
   std::unique_ptr< ml::View > _view;
   DrawingResources _resources;
   PropertyTree _drawingProperties;
+  
+  // where the Widgets go. If a subclass adds rules here, the Widgets they name
+  // are placed after each layoutView(), and only the Widgets that moved are
+  // redrawn when possible.
+  Layout _layout;
+  
+  // decodes images in the background. Subclasses can use this in initializeResources()
+  // so that the first frame is not held up by images.
+  ResourceLoader _resourceLoader;
   ParameterTree _params;
   
   // Actors
@@ -108,11 +168,15 @@ protected:
   Tree< std::vector< Widget* > > _widgetsByProperty;
   Tree< std::vector< Widget* > > _widgetsByCollection;
   Tree< std::vector< Widget* > > _widgetsBySignal;
+  Tree< std::vector< Widget* > > _widgetsBySpectrum;
   Tree< std::vector< Widget* > > _modalWidgetsByParameter;
   Path _currentModalParam;
   
   // timing
   time_point< system_clock > _previousFrameTime;
+  time_point< steady_clock > _creationTime;
+  std::atomic< double > _timeToFirstFrameInMs{0};
+  std::atomic< double > _timeToAllResourcesInMs{0};
   Timer _ioTimer;
   Timer _doubleClickTimer;
   Timer _animationTimer;
@@ -120,12 +184,21 @@ protected:
   int guiToResizeCounter{0};
   
   // GUI Events
-  Queue< GUIEvent > _inputQueue{ 1024 };
+  GUIEventQueue _inputQueue{ 1024 };
+  InputLatencyMonitor _latencyMonitor;
+  InputTime _currentInputTime{};
+  
+  // render stats
+  RenderStatsCollector _renderStats;
+  RenderStatsReport _renderStatsReport;
+  void _updateRenderStatsReport();
   Vec2 _clickAndHoldStartPosition;
   Vec2 _doubleClickStartPosition;
   
-  // called every second
-  virtual void debugAppView() {}
+  // called every second. The default prints input latency stats
+  // if the drawing property "debug_input_latency" is set, and the
+  // costliest Widgets if "collect_render_stats" is set.
+  virtual void debugAppView();
 
   // why underscores?! TODO clean up.
   void _setupWidgets(const ParameterDescriptionList& pdl);
@@ -139,6 +212,19 @@ protected:
   size_t _getElapsedTime();
   void layoutFixedSizeWidgets_();
   
+  // live resize
+  LiveResizeThrottle _liveResize;
+  bool _previewNeedsUpdate{ false };
+  Vec2 _requestedSize;
+  float _requestedDisplayScale{ 1.f };
+  bool _contentsKept{ false };
+  std::unique_ptr< DrawableImage > _liveResizePreview;
+  void _layoutAtSize(NativeDrawContext* nvg, Vec2 newSize, float displayScale);
+  void _updateLiveResize(NativeDrawContext* nvg);
+  void _drawLiveResizePreview(NativeDrawContext* nvg);
+  void _drawView(const DrawContext& dc);
+  bool _applyLayout(DrawContext dc, bool movedOnly);
+  
   // here is where all the Widgets are stored. Other instances of Collection < Widget >
   // may reference this.
   CollectionRoot< Widget > _rootWidgets;
@@ -7,6 +7,9 @@
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
+#include <algorithm>
+#include <functional>
+#include <ostream>
 
 #define NANOSVG_IMPLEMENTATION
 #include "MLDrawContext.h"
@@ -446,4 +449,247 @@ void drawTextBox(NativeDrawContext* nvg, Vec2 location, float rowWidth, ml::Text
 }
 
 
+// DrawingResources memory accounting
+
+namespace {
+
+template< typename T >
+void addUsage(Tree< std::unique_ptr< T > >& t, DrawingResources::Usage& u)
+{
+  for (auto it = t.begin(); it != t.end(); ++it)
+  {
+    const auto& r = *it;
+    if (!r) continue;
+    ResourceSize s = r->getSize();
+    u.count++;
+    u.size += s;
+    if (r->regenerable)
+    {
+      u.regenerableBytes += s.total();
+    }
+  }
+}
+
+struct EvictionCandidate
+{
+  uint32_t lastUsedFrame;
+  size_t bytes;
+  std::function< void() > evict;
+};
+
+template< typename T >
+void addEvictionCandidates(Tree< std::unique_ptr< T > >& t, uint32_t keepAfterFrame, std::vector< EvictionCandidate >& c)
+{
+  for (auto it = t.begin(); it != t.end(); ++it)
+  {
+    const auto& r = *it;
+    if (r && r->regenerable && (r->lastUsedFrame < keepAfterFrame))
+    {
+      Path p = it.getCurrentPath();
+      c.push_back({ r->lastUsedFrame, r->getSize().total(), [&t, p]() { t[p] = nullptr; } });
+    }
+  }
+}
+
+void printUsage(std::ostream& out, const char* kind, const DrawingResources::Usage& u)
+{
+  constexpr double kKB{ 1024. };
+  out << "  " << kind << ": " << u.count << " (cpu " << u.size.cpuBytes/kKB << " KB, gpu " << u.size.gpuBytes/kKB
+      << " KB, regenerable " << u.regenerableBytes/kKB << " KB)\n";
+}
+
+} // namespace
+
+ResourceSize DrawingResources::UsageReport::total() const
+{
+  ResourceSize s;
+  for (auto u : { vectorImages, rasterImages, drawableImages, streamingImages, fonts, blobs })
+  {
+    s += u.size;
+  }
+  return s;
+}
+
+size_t DrawingResources::UsageReport::regenerableBytes() const
+{
+  return vectorImages.regenerableBytes + rasterImages.regenerableBytes + drawableImages.regenerableBytes;
+}
+
+DrawingResources::UsageReport DrawingResources::getUsage()
+{
+  UsageReport r;
+  addUsage(vectorImages, r.vectorImages);
+  addUsage(rasterImages, r.rasterImages);
+  addUsage(drawableImages, r.drawableImages);
+  addUsage(fonts, r.fonts);
+
+  // streaming images keep pixels and a staging copy on the CPU side.
+  for (auto& img : streamingImages)
+  {
+    if (!img) continue;
+    size_t imageBytes = img->getBytesPerRow()*img->getHeight();
+    r.streamingImages.count++;
+    r.streamingImages.size += ResourceSize{ imageBytes*2, imageBytes };
+  }
+  for (auto& blob : blobs)
+  {
+    if (!blob) continue;
+    r.blobs.count++;
+    r.blobs.size += ResourceSize{ blob->size(), 0 };
+  }
+  return r;
 }
+
+size_t DrawingResources::evictToBudget()
+{
+  if (!budgetInBytes) return 0;
+  size_t used = getUsage().regenerableBytes();
+  if (used <= budgetInBytes) return 0;
+
+  std::vector< EvictionCandidate > candidates;
+  uint32_t keepAfterFrame = frame - 1;
+  addEvictionCandidates(vectorImages, keepAfterFrame, candidates);
+  addEvictionCandidates(rasterImages, keepAfterFrame, candidates);
+  addEvictionCandidates(drawableImages, keepAfterFrame, candidates);
+  std::sort(candidates.begin(), candidates.end(),
+            [](const EvictionCandidate& a, const EvictionCandidate& b) { return a.lastUsedFrame < b.lastUsedFrame; });
+
+  size_t freed{ 0 };
+  for (auto& c : candidates)
+  {
+    if (used - freed <= budgetInBytes) break;
+    c.evict();
+    freed += c.bytes;
+  }
+  if (freed)
+  {
+    changed();
+  }
+  return freed;
+}
+
+void DrawingResources::dumpResourceUsage(std::ostream& out)
+{
+  constexpr double kKB{ 1024. };
+  UsageReport r = getUsage();
+  out << "resource usage:\n";
+  printUsage(out, "vector images", r.vectorImages);
+  printUsage(out, "raster images", r.rasterImages);
+  printUsage(out, "drawable images", r.drawableImages);
+  printUsage(out, "streaming images", r.streamingImages);
+  printUsage(out, "fonts", r.fonts);
+  printUsage(out, "blobs", r.blobs);
+  ResourceSize total = r.total();
+  out << "  total: cpu " << total.cpuBytes/kKB << " KB, gpu " << total.gpuBytes/kKB << " KB";
+  if (budgetInBytes)
+  {
+    out << ", regenerable " << r.regenerableBytes()/kKB << " of " << budgetInBytes/kKB << " KB budget";
+  }
+  out << "\n";
+  if (framebuffers)
+  {
+    out << "  framebuffer pool: " << framebuffers->getStats() << "\n";
+  }
+}
+
+// FramebufferPool
+
+float FramebufferPool::Stats::hitRate() const
+{
+  size_t requests = hits + misses;
+  return requests ? float(hits)/float(requests) : 0.f;
+}
+
+std::ostream& operator<<(std::ostream& out, const FramebufferPool::Stats& s)
+{
+  out << s.hits << " hits, " << s.misses << " misses (" << s.hitRate()*100.f << "% hit rate), ";
+  out << s.pooledImages << " pooled in " << s.pooledBytes/1024. << " KB";
+  return out;
+}
+
+std::unique_ptr< DrawableImage > FramebufferPool::acquire(int w, int h)
+{
+  w = std::max(w, 0);
+  h = std::max(h, 0);
+
+  // take the smallest pooled image that fits.
+  auto best = _pool.end();
+  for (auto it = _pool.begin(); it != _pool.end(); ++it)
+  {
+    if ((*it)->fits(w, h))
+    {
+      if ((best == _pool.end()) || ((*it)->getSize().total() < (*best)->getSize().total()))
+      {
+        best = it;
+      }
+    }
+  }
+
+  std::unique_ptr< DrawableImage > pImage;
+  if (best != _pool.end())
+  {
+    _hits++;
+    pImage = std::move(*best);
+    _pool.erase(best);
+  }
+  else
+  {
+    _misses++;
+    pImage = std::make_unique< DrawableImage >(_nvg, bucketSize(w), bucketSize(h));
+  }
+  pImage->setUsedSize(w, h);
+  return pImage;
+}
+
+void FramebufferPool::release(std::unique_ptr< DrawableImage > pImage)
+{
+  if (!pImage) return;
+  _pool.push_back(std::move(pImage));
+
+  size_t pooledBytes{0};
+  for (const auto& p : _pool)
+  {
+    pooledBytes += p->getSize().total();
+  }
+  while (pooledBytes > _maxPooledBytes)
+  {
+    pooledBytes -= _pool.front()->getSize().total();
+    _pool.erase(_pool.begin());
+  }
+}
+
+bool FramebufferPool::resize(std::unique_ptr< DrawableImage >& pImage, int w, int h)
+{
+  w = std::max(w, 0);
+  h = std::max(h, 0);
+
+  if (pImage && pImage->fits(w, h))
+  {
+    _hits++;
+    pImage->setUsedSize(w, h);
+    return true;
+  }
+  release(std::move(pImage));
+  pImage = acquire(w, h);
+  return false;
+}
+
+void FramebufferPool::clear()
+{
+  _pool.clear();
+}
+
+FramebufferPool::Stats FramebufferPool::getStats() const
+{
+  Stats s;
+  s.hits = _hits;
+  s.misses = _misses;
+  s.pooledImages = _pool.size();
+  for (const auto& p : _pool)
+  {
+    s.pooledBytes += p->getSize().total();
+  }
+  return s;
+}
+
+} // namespace ml
@@ -10,11 +10,20 @@
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
+#include <algorithm>
+#include <ostream>
+#include <type_traits>
+#include <vector>
 
 #include "mldsp.h"
 #include "madronalib.h"
 #include "MLMath2D.h"
 #include "MLGUICoordinates.h"
+#include "MLInputLatency.h"
+#include "MLRenderStats.h"
+#include "MLStreamingImage.h"
+#include "MLResourcePack.h"
+#include "MLSharedAssetCache.h"
 
 
 // TODO clean up cross-platform code
@@ -68,37 +77,66 @@ constexpr float kMinVisibleAlpha{ 0.01f };
 // kinds of drawing resources. TODO move
 using ResourceBlob = std::vector< uint8_t >;
 
-struct VectorImage
+// the memory used by a resource, in bytes.
+struct ResourceSize
+{
+  size_t cpuBytes{ 0 };
+  size_t gpuBytes{ 0 };
+  size_t total() const { return cpuBytes + gpuBytes; }
+  ResourceSize& operator+=(ResourceSize b) { cpuBytes += b.cpuBytes; gpuBytes += b.gpuBytes; return *this; }
+};
+
+// bookkeeping common to resources. A regenerable resource is one that can be made
+// again by name when it is next asked for, so DrawingResources may evict it to stay
+// within its budget.
+struct ResourceUsage
+{
+  uint32_t lastUsedFrame{ 0 };
+  bool regenerable{ false };
+};
+
+struct VectorImage : public ResourceUsage
 {
   NSVGimage* _pImage{ nullptr };
   NativeDrawContext* nvg_{ nullptr };
   float width{ 0 };
   float height{ 0 };
   
-  VectorImage(NativeDrawContext* nvg, const unsigned char* dataStart, size_t dataBytes) :
-  nvg_(nvg)
+  // the parsed image, which may be shared with other VectorImages.
+  SharedAssetCache::SVGPtr _shared;
+  
+  VectorImage(NativeDrawContext* nvg, SharedAssetCache::SVGPtr image) :
+  nvg_(nvg), _shared(std::move(image))
   {
-    // horribly, nsvgParse will clobber the data it reads! So let's copy that data before parsing.
-    // TODO replace nanosvg
-    char* pTempData{nullptr};
-    // there must be some bug in nanosvg. *2 is a safety net
-    if((pTempData = (char*)malloc(dataBytes*2)))
+    _pImage = _shared.get();
+    if (_pImage)
     {
-      std::copy_n(dataStart, dataBytes, pTempData);
-      _pImage = nsvgParse(pTempData, "px", 96);
-      if (_pImage)
-      {
-        width = _pImage->width;
-        height = _pImage->height;
-      }
+      width = _pImage->width;
+      height = _pImage->height;
     }
-    
-    free(pTempData);
   }
   
-  ~VectorImage()
+  // parse an image of our own.
+  VectorImage(NativeDrawContext* nvg, const unsigned char* dataStart, size_t dataBytes) :
+  VectorImage(nvg, SharedAssetCache::parseSVG(dataStart, dataBytes))
   {
-    if (_pImage) { nsvgDelete(_pImage); }
+  }
+  
+  // the parsed shapes and paths. Gradients are not counted.
+  ResourceSize getSize() const
+  {
+    ResourceSize s;
+    if (!_pImage) return s;
+    s.cpuBytes = sizeof(NSVGimage);
+    for (auto shape = _pImage->shapes; shape; shape = shape->next)
+    {
+      s.cpuBytes += sizeof(NSVGshape);
+      for (auto path = shape->paths; path; path = path->next)
+      {
+        s.cpuBytes += sizeof(NSVGpath) + path->npts*2*sizeof(float);
+      }
+    }
+    return s;
   }
   
   explicit operator bool() const { return (_pImage != nullptr); }
@@ -110,18 +148,26 @@ struct VectorImage
 
 // inline NativeDrawBuffer* toNativeBuffer(void* p) { return static_cast<NativeDrawBuffer*>(p); }
 
-struct DrawableImage
+struct DrawableImage : public ResourceUsage
 {
   NativeDrawBuffer* _buf{ nullptr };
   NativeDrawContext* _nvg{ nullptr };
+
+  // the size in use, which is drawn to and shown.
   size_t width{ 0 };
   size_t height{ 0 };
+
+  // the size of the framebuffer, which may be larger.
+  size_t allocatedWidth{ 0 };
+  size_t allocatedHeight{ 0 };
   
   DrawableImage(NativeDrawContext* nvg, int w, int h) :
   _nvg(nvg), width(w), height(h)
   {
     w = max(w, 16);
     h = max(h, 16);
+    allocatedWidth = w;
+    allocatedHeight = h;
     
     _buf = nvgCreateFramebuffer(nvg, w, h, 0);
     nvgBindFramebuffer(_buf);
@@ -139,15 +185,35 @@ struct DrawableImage
     // if called after the nvg context is gone, this will crash.
     nvgDeleteFramebuffer(_buf);
   }
+  
+  bool fits(size_t w, size_t h) const { return (w <= allocatedWidth) && (h <= allocatedHeight); }
+  
+  // use a w x h sub-rect of the framebuffer. The framebuffer is not changed, so
+  // the new size must fit.
+  void setUsedSize(size_t w, size_t h)
+  {
+    width = std::min(w, allocatedWidth);
+    height = std::min(h, allocatedHeight);
+  }
+  
+  // an RGBA color buffer and an 8-bit stencil buffer.
+  ResourceSize getSize() const
+  {
+    return ResourceSize{ 0, allocatedWidth*allocatedHeight*5 };
+  }
 };
 
+// draw to the sub-rect of the image in use, or to the screen if pImg is null.
+// The sub-rect is at the top left of the framebuffer on every platform, so
+// what was drawn stays in place when the size in use changes. GL counts rows
+// from the bottom, so its viewport is moved up to the top.
 inline void drawToImage(const DrawableImage* pImg)
 {
   if (pImg)
   {
     nvgBindFramebuffer(pImg->_buf);
 #if ML_WINDOWS // TEMP
-    glViewport(0, 0, pImg->width, pImg->height);
+    glViewport(0, GLint(pImg->allocatedHeight - pImg->height), pImg->width, pImg->height);
 #endif
   }
   else
@@ -156,10 +222,88 @@ inline void drawToImage(const DrawableImage* pImg)
   }
 }
 
+// get a pattern that maps the sub-rect of the image in use onto dest, or 1:1
+// onto the rect (0, 0, width, height).
+inline NVGpaint drawableImagePattern(NativeDrawContext* nvg, const DrawableImage& img, Rect dest, float alpha = 1.0f)
+{
+  float sx = dest.width()/std::max(float(img.width), 1.f);
+  float sy = dest.height()/std::max(float(img.height), 1.f);
+  return nvgImagePattern(nvg, dest.left(), dest.top(), img.allocatedWidth*sx, img.allocatedHeight*sy, 0,
+                         img._buf->image, alpha);
+}
+
+inline NVGpaint drawableImagePattern(NativeDrawContext* nvg, const DrawableImage& img, float alpha = 1.0f)
+{
+  return drawableImagePattern(nvg, img, Rect(0, 0, img.width, img.height), alpha);
+}
+
+
+// FramebufferPool: reuses DrawableImages, so that resizing a backing layer over
+// and over doesn't create and delete a framebuffer each time. Framebuffers are
+// allocated in sizes rounded up to a multiple of kBucketSize, and an image is
+// only ever given a larger framebuffer: when the size in use shrinks, its
+// framebuffer is kept and a smaller sub-rect is drawn to. Released images wait
+// in the pool until someone needs one of their size or larger.
+//
+// A pool belongs to one nvg context and must be cleared before the context is
+// deleted.
+
+class FramebufferPool
+{
+public:
+  static constexpr int kBucketSize{ 256 };
+
+  struct Stats
+  {
+    size_t hits{0};
+    size_t misses{0};
+    size_t pooledImages{0};
+    size_t pooledBytes{0};
+
+    // the fraction of requests met without making a framebuffer.
+    float hitRate() const;
+  };
+
+  explicit FramebufferPool(NativeDrawContext* nvg) : _nvg(nvg) {}
+  ~FramebufferPool() = default;
+
+  // get an image with a used size of w x h, from the pool if possible.
+  std::unique_ptr< DrawableImage > acquire(int w, int h);
+
+  // return an image to the pool. If the pool is then over its limit, the
+  // images released longest ago are deleted.
+  void release(std::unique_ptr< DrawableImage > pImage);
+
+  // change the used size of an image, keeping its framebuffer if the new size
+  // fits. If pImage is null, a new image is acquired. Returns true if the
+  // framebuffer was kept, with what was drawn to it in place.
+  bool resize(std::unique_ptr< DrawableImage >& pImage, int w, int h);
+
+  // delete all the pooled images.
+  void clear();
+
+  // the most memory that released images are kept in.
+  void setMaxPooledBytes(size_t bytes) { _maxPooledBytes = bytes; }
+
+  Stats getStats() const;
+
+  // round a size up to the next bucket.
+  static int bucketSize(int n) { return std::max(1, (n + kBucketSize - 1)/kBucketSize)*kBucketSize; }
+
+private:
+  NativeDrawContext* _nvg;
+  std::vector< std::unique_ptr< DrawableImage > > _pool;
+  size_t _maxPooledBytes{ 64*1024*1024 };
+  size_t _hits{0};
+  size_t _misses{0};
+};
+
+std::ostream& operator<<(std::ostream& out, const FramebufferPool::Stats& s);
+
 
 // RasterImage
 
-struct RasterImage
+struct RasterImage : public ResourceUsage
 {
 public:
   int handle{ -1 };
@@ -177,6 +321,27 @@ public:
       nvgImageSize(nvg_, handle, &width, &height);
     }
   }
+
+  // make an image from decoded RGBA pixels.
+  RasterImage(NativeDrawContext* nvg, int w, int h, const unsigned char* pixels) :
+  nvg_(nvg)
+  {
+    int flags = 0;
+    handle = nvgCreateImageRGBA(nvg_, w, h, flags, pixels);
+    if (handle)
+    {
+      width = w;
+      height = h;
+    }
+  }
+
+  // make an image from shared decoded pixels. The pixels are only needed for
+  // the upload, so this image does not keep them: once every image made from
+  // them is uploaded, the CPU copy is freed.
+  RasterImage(NativeDrawContext* nvg, const SharedAssetCache::BitmapPtr& bitmap) :
+  RasterImage(nvg, bitmap->width, bitmap->height, bitmap->pixels)
+  {
+  }
   ~RasterImage()
   {
     if ((handle != -1) && (nvg_))
@@ -184,17 +349,24 @@ public:
       nvgDeleteImage(nvg_, handle);
     }
   }
+  // only the texture remains after the upload.
+  ResourceSize getSize() const
+  {
+    return ResourceSize{ 0, (handle != -1) ? size_t(width)*height*4 : 0 };
+  }
   explicit operator bool() const { return (handle != -1); }
 };
 
 
 // Font
 
-struct FontResource
+struct FontResource : public ResourceUsage
 {
   static constexpr int FONS_INVALID{ -1 };
   int handle{ -1 };
-  FontResource(NativeDrawContext* nvg, const char* name, const unsigned char* data, int ndata, int freeData = 0)
+  size_t dataBytes{ 0 };
+  FontResource(NativeDrawContext* nvg, const char* name, const unsigned char* data, int ndata, int freeData = 0) :
+  dataBytes(ndata)
   {
     int fonsResult = nvgCreateFontMem(nvg, "MLVG_sans", (unsigned char*)data, ndata, freeData);
     if (FONS_INVALID != fonsResult)
@@ -207,6 +379,9 @@ struct FontResource
     // ?
   }
   
+  // the font data, which nanovg reads in place.
+  ResourceSize getSize() const { return ResourceSize{ dataBytes, 0 }; }
+  
   explicit operator bool() const { return (handle != FONS_INVALID); }
 };
 
@@ -221,7 +396,64 @@ struct DrawingResources
   Tree< std::unique_ptr< VectorImage > > vectorImages;
   Tree< std::unique_ptr< DrawableImage > > drawableImages;
   Tree< std::unique_ptr< RasterImage > > rasterImages;
+  Tree< std::unique_ptr< StreamingRasterImage > > streamingImages;
   Tree< std::unique_ptr< FontResource > > fonts;
+
+  // if set, vector and raster images not found above are made from the pack
+  // entry with the same name, the first time they are asked for.
+  const ResourcePack* pack{nullptr};
+
+  // if set, images made from the pack are decoded through this cache, and
+  // shared with other AppViews.
+  SharedAssetCache* sharedAssets{nullptr};
+
+  // if set, the framebuffer pool of the platform view drawing us, which
+  // widgets can use for their own DrawableImages.
+  FramebufferPool* framebuffers{nullptr};
+
+  // the names of resources a ResourceLoader is decoding and has not yet
+  // installed, updated each frame. A missing resource named here has just not
+  // arrived yet.
+  std::vector< Path > pending;
+  bool isPending(Path name) const { return std::find(pending.begin(), pending.end(), name) != pending.end(); }
+
+  // incremented by changed(). Anyone who replaces or removes a resource must
+  // call changed() afterwards, so that ResourceHandles will find it again.
+  uint32_t generation{1};
+  void changed() { ++generation; }
+
+  // the current frame, advanced by the AppView before animating. Resources
+  // record the frame they were last used in, so the least recently used
+  // regenerable resources can be evicted first.
+  uint32_t frame{1};
+
+  // if nonzero, the most memory that regenerable resources should use.
+  size_t budgetInBytes{0};
+
+  struct Usage
+  {
+    size_t count{0};
+    ResourceSize size;
+    size_t regenerableBytes{0};
+  };
+
+  struct UsageReport
+  {
+    Usage vectorImages, rasterImages, drawableImages, streamingImages, fonts, blobs;
+    ResourceSize total() const;
+    size_t regenerableBytes() const;
+  };
+
+  // get the memory used by each kind of resource.
+  UsageReport getUsage();
+
+  // evict the least recently used regenerable resources until they are within
+  // budget. Resources used in the current or previous frame are kept. Returns
+  // the number of bytes freed.
+  size_t evictToBudget();
+
+  // print the memory used by each kind of resource.
+  void dumpResourceUsage(std::ostream& out);
 };
 
 // To draw a frame, animate a frame, or layout the view, views create a DrawContext that is passed to
@@ -232,6 +464,8 @@ struct DrawContext
   DrawingResources* pResources;
   PropertyTree* pProperties;
   GUICoordinates coords;
+  InputLatencyMonitor* pLatencyMonitor{nullptr};
+  RenderStatsCollector* pRenderStats{nullptr};
 };
 
 inline NativeDrawContext* getNativeContext(const DrawContext& dc) { return static_cast<NativeDrawContext*>(dc.pNativeContext); }
@@ -247,14 +481,37 @@ inline DrawContext translate(const DrawContext& dc, Vec2 topLeft)
 // resource helpers
 
 
+inline ResourcePack::Data findPackedResource(const DrawContext& dc, Path name)
+{
+  const ResourcePack* pack = dc.pResources->pack;
+  if (!pack) return ResourcePack::Data{};
+  return pack->find(pathToText(name).getText());
+}
+
 inline VectorImage* getVectorImage(const DrawContext& dc, Path name)
 {
   const auto& t = (dc.pResources->vectorImages);
   auto& res(t[name]);
   if (res)
   {
+    res->lastUsedFrame = dc.pResources->frame;
     return res.get();
   }
+  else if (auto data = findPackedResource(dc, name))
+  {
+    auto& newRes = dc.pResources->vectorImages[name];
+    if (auto assets = dc.pResources->sharedAssets)
+    {
+      newRes = std::make_unique< VectorImage >(getNativeContext(dc), assets->getSVG(data.data, data.size));
+    }
+    else
+    {
+      newRes = std::make_unique< VectorImage >(getNativeContext(dc), data.data, data.size);
+    }
+    newRes->lastUsedFrame = dc.pResources->frame;
+    newRes->regenerable = true;
+    return newRes.get();
+  }
   else
   {
     return nullptr;
@@ -281,8 +538,25 @@ inline RasterImage* getRasterImage(const DrawContext& dc, Path name)
   auto& res(t[name]);
   if (res)
   {
+    res->lastUsedFrame = dc.pResources->frame;
     return res.get();
   }
+  else if (auto data = findPackedResource(dc, name))
+  {
+    auto& newRes = dc.pResources->rasterImages[name];
+    auto assets = dc.pResources->sharedAssets;
+    if (auto bitmap = assets ? assets->getBitmap(data.data, data.size) : nullptr)
+    {
+      newRes = std::make_unique< RasterImage >(getNativeContext(dc), bitmap);
+    }
+    else
+    {
+      newRes = std::make_unique< RasterImage >(getNativeContext(dc), data.data, data.size);
+    }
+    newRes->lastUsedFrame = dc.pResources->frame;
+    newRes->regenerable = true;
+    return newRes.get();
+  }
   else
   {
     return nullptr;
@@ -294,6 +568,21 @@ inline DrawableImage* getDrawableImage(const DrawContext& dc, Path name)
   const auto& t = (dc.pResources->drawableImages);
   auto& res(t[name]);
   if (res)
+  {
+    res->lastUsedFrame = dc.pResources->frame;
+    return res.get();
+  }
+  else
+  {
+    return nullptr;
+  }
+}
+
+inline StreamingRasterImage* getStreamingImage(const DrawContext& dc, Path name)
+{
+  const auto& t = (dc.pResources->streamingImages);
+  auto& res(t[name]);
+  if (res)
   {
     return res.get();
   }
@@ -303,6 +592,57 @@ inline DrawableImage* getDrawableImage(const DrawContext& dc, Path name)
   }
 }
 
+inline void findResource(const DrawContext& dc, Path name, VectorImage*& p) { p = getVectorImage(dc, name); }
+inline void findResource(const DrawContext& dc, Path name, FontResource*& p) { p = getFontResource(dc, name); }
+inline void findResource(const DrawContext& dc, Path name, RasterImage*& p) { p = getRasterImage(dc, name); }
+inline void findResource(const DrawContext& dc, Path name, DrawableImage*& p) { p = getDrawableImage(dc, name); }
+inline void findResource(const DrawContext& dc, Path name, StreamingRasterImage*& p) { p = getStreamingImage(dc, name); }
+
+// A ResourceHandle finds a resource by name once and then keeps a pointer to it,
+// so that draw() methods do no Path or Tree work. Widgets should set the names of
+// their handles in setupParams(), not in draw().
+//
+// The pointer is kept until the DrawingResources generation changes. A resource
+// that was not found is looked for again on each get() until it appears.
+template< typename T >
+class ResourceHandle
+{
+public:
+  ResourceHandle() = default;
+  explicit ResourceHandle(Path name) : _name(name) {}
+
+  void setName(Path name)
+  {
+    if (!(name == _name))
+    {
+      _name = name;
+      _ptr = nullptr;
+    }
+  }
+
+  Path getName() const { return _name; }
+
+  T* get(const DrawContext& dc)
+  {
+    uint32_t generation = dc.pResources->generation;
+    if (!_ptr || (_generation != generation))
+    {
+      findResource(dc, _name, _ptr);
+      _generation = generation;
+    }
+    if constexpr (std::is_base_of< ResourceUsage, T >::value)
+    {
+      if (_ptr) { _ptr->lastUsedFrame = dc.pResources->frame; }
+    }
+    return _ptr;
+  }
+
+private:
+  Path _name;
+  T* _ptr{ nullptr };
+  uint32_t _generation{ 0 };
+};
+
 
 // nanovg + mlvg helpers
 
@@ -751,6 +1091,41 @@ inline NVGcolor getColorWithDefault(DrawContext t, Path p, NVGcolor r) { return
 
 inline NVGcolor lerp(NVGcolor a, NVGcolor b, float mix) { return nvgLerpRGBA(a, b, mix); }
 
+// draw a placeholder in place of a resource that is still loading.
+inline void drawPendingResource(DrawContext dc, Rect r)
+{
+  NativeDrawContext* nvg = getNativeContext(dc);
+  nvgFillColor(nvg, getColorWithDefault(dc, "placeholder", rgba(0.5, 0.5, 0.5, 0.25)));
+  nvgBeginPath(nvg);
+  nvgRect(nvg, r);
+  nvgFill(nvg);
+}
+
+// draw the named resource's placeholder if it is still loading. Otherwise it
+// was not found: draw a framed and crossed rect, so that it is visible instead
+// of drawing nothing.
+inline void drawMissingResource(DrawContext dc, Rect r, Path name)
+{
+  if(dc.pResources && dc.pResources->isPending(name))
+  {
+    drawPendingResource(dc, r);
+    return;
+  }
+  NativeDrawContext* nvg = getNativeContext(dc);
+  float strokeWidth = std::max(getFloatWithDefault(dc, "common_stroke_width", 1/32.f)*dc.coords.gridSizeInPixels, 1.f);
+  Rect frame = shrink(r, strokeWidth*0.5f);
+
+  nvgStrokeWidth(nvg, strokeWidth);
+  nvgStrokeColor(nvg, getColorWithDefault(dc, "mark", rgba(1, 0, 1, 1)));
+  nvgBeginPath(nvg);
+  nvgRect(nvg, frame);
+  nvgMoveTo(nvg, frame.left(), frame.top());
+  nvgLineTo(nvg, frame.right(), frame.bottom());
+  nvgMoveTo(nvg, frame.right(), frame.top());
+  nvgLineTo(nvg, frame.left(), frame.bottom());
+  nvgStroke(nvg);
+}
+
 // void setColorProperty(Path p, NVGcolor r) { setProperty(p, colorToMatrix(r)); }
 
 
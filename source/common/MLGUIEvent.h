@@ -24,8 +24,10 @@ struct GUIEvent
   uint32_t keyFlags{0};
   int sourceIndex{0}; // for multiple touches etc.
 
-//  time_point<system_clock> time;
-  
+  // set by GUIEventQueue when the event is pushed and popped.
+  time_point<steady_clock> enqueueTime{};
+  time_point<steady_clock> dequeueTime{};
+
   GUIEvent() = default;
   GUIEvent(Symbol t, Vec2 p=Vec2(), Vec2 d=Vec2(), int k=0, int s=0) : type(t), position(p), delta(d), keyFlags(k), sourceIndex(s) {}
 };
@@ -0,0 +1,125 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+// GUIEventQueue: a single-producer, single-consumer ring buffer of GUIEvents.
+// The platform view pushes events from its event thread and the AppView pops them
+// on its timer. When popping, runs of consecutive drag events from the same source
+// are coalesced into the last one, and runs of consecutive scroll events have their
+// deltas summed. Any other event type ends a run, so down / up ordering is kept.
+// This way the work done per tick scales with the number of distinct gestures
+// and not with the polling rate of the input device.
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "MLGUIEvent.h"
+
+namespace ml {
+
+class GUIEventQueue
+{
+public:
+  explicit GUIEventQueue(size_t capacity)
+  {
+    // round up to a power of two so we can mask indices.
+    size_t size{1};
+    while(size < capacity) size <<= 1;
+    _buffer.resize(size);
+    _mask = size - 1;
+  }
+  ~GUIEventQueue() = default;
+
+  // producer side. Stamps the enqueue time and returns false if the queue is full.
+  bool push(GUIEvent e)
+  {
+    const size_t writeIdx = _writeIndex.load(std::memory_order_relaxed);
+    const size_t readIdx = _readIndex.load(std::memory_order_acquire);
+    if(writeIdx - readIdx > _mask)
+    {
+      return false;
+    }
+    e.enqueueTime = steady_clock::now();
+    _buffer[writeIdx & _mask] = e;
+    _writeIndex.store(writeIdx + 1, std::memory_order_release);
+    return true;
+  }
+
+  // consumer side. Pop the next event, coalescing any following events that
+  // can be merged into it. Returns false if the queue is empty.
+  bool pop(GUIEvent& e)
+  {
+    size_t readIdx = _readIndex.load(std::memory_order_relaxed);
+    const size_t writeIdx = _writeIndex.load(std::memory_order_acquire);
+    if(readIdx == writeIdx)
+    {
+      return false;
+    }
+
+    e = _buffer[readIdx & _mask];
+    readIdx++;
+    _rawEventCount++;
+
+    while(readIdx != writeIdx)
+    {
+      const GUIEvent& next = _buffer[readIdx & _mask];
+      if(!canCoalesce(e, next)) break;
+
+      // the merged event keeps the earliest enqueue time, so that latency
+      // is measured from the start of the run.
+      if(e.type == "scroll")
+      {
+        e.delta += next.delta;
+      }
+      else
+      {
+        e.position = next.position;
+        e.screenPos = next.screenPos;
+        e.delta += next.delta;
+      }
+      readIdx++;
+      _rawEventCount++;
+    }
+
+    _readIndex.store(readIdx, std::memory_order_release);
+    _coalescedEventCount++;
+    e.dequeueTime = steady_clock::now();
+    return true;
+  }
+
+  // consumer side. The number of raw events waiting, before any coalescing.
+  size_t elementsAvailable() const
+  {
+    return _writeIndex.load(std::memory_order_acquire) - _readIndex.load(std::memory_order_relaxed);
+  }
+
+  size_t getCapacity() const { return _mask + 1; }
+
+  // consumer side. Counts of events popped before and after coalescing.
+  size_t getRawEventCount() const { return _rawEventCount; }
+  size_t getCoalescedEventCount() const { return _coalescedEventCount; }
+  void resetCounts() { _rawEventCount = _coalescedEventCount = 0; }
+
+  static bool canCoalesce(const GUIEvent& a, const GUIEvent& b)
+  {
+    if(a.type != b.type) return false;
+    if((a.type != "drag") && (a.type != "scroll")) return false;
+    return (a.sourceIndex == b.sourceIndex) && (a.keyFlags == b.keyFlags);
+  }
+
+private:
+  std::vector< GUIEvent > _buffer;
+  size_t _mask{0};
+
+  // keep the indices on separate cache lines to avoid false sharing.
+  alignas(64) std::atomic< size_t > _writeIndex{0};
+  alignas(64) std::atomic< size_t > _readIndex{0};
+
+  size_t _rawEventCount{0};
+  size_t _coalescedEventCount{0};
+};
+
+} // namespace ml
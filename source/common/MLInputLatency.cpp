@@ -0,0 +1,104 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+#include "MLInputLatency.h"
+
+namespace ml {
+
+using namespace std::chrono;
+
+// LatencyHistogram
+
+void LatencyHistogram::addSample(nanoseconds d)
+{
+  double ns = std::max(double(d.count()), 1.0);
+  double octaves = std::log2(ns/1000.0);
+  int bucket = int(std::ceil(octaves*kBucketsPerOctave));
+  bucket = std::max(0, std::min(bucket, kNumBuckets - 1));
+  _counts[bucket]++;
+  _count++;
+  _maxNs = std::max(_maxNs, ns);
+}
+
+void LatencyHistogram::clear()
+{
+  _counts.fill(0);
+  _count = 0;
+  _maxNs = 0;
+}
+
+double LatencyHistogram::getPercentileMs(float p) const
+{
+  if(!_count) return 0.;
+
+  size_t target = size_t(std::ceil(_count*std::max(0.f, std::min(p, 1.f))));
+  target = std::max(target, size_t(1));
+  size_t sum{0};
+  for(int i = 0; i < kNumBuckets; ++i)
+  {
+    sum += _counts[i];
+    if(sum >= target)
+    {
+      // upper edge of bucket i, clipped to the largest sample seen.
+      double upperNs = 1000.0*std::exp2(double(i)/kBucketsPerOctave);
+      return std::min(upperNs, _maxNs)*1e-6;
+    }
+  }
+  return getMaxMs();
+}
+
+// InputLatencyMonitor
+
+void InputLatencyMonitor::widgetDrawn(InputTime t)
+{
+  // many Widgets are usually changed by the same event, so keep only distinct times.
+  if(std::find(_pendingTimes.begin(), _pendingTimes.end(), t) != _pendingTimes.end()) return;
+  if(_pendingTimes.size() < kMaxPendingTimes)
+  {
+    _pendingTimes.push_back(t);
+  }
+}
+
+void InputLatencyMonitor::framePresented()
+{
+  if(_pendingTimes.empty()) return;
+
+  auto now = steady_clock::now();
+  {
+    std::lock_guard< std::mutex > lock(_histogramMutex);
+    for(auto t : _pendingTimes)
+    {
+      _histogram.addSample(duration_cast< nanoseconds >(now - t));
+    }
+  }
+  _pendingTimes.clear();
+}
+
+LatencyHistogram InputLatencyMonitor::getHistogram() const
+{
+  std::lock_guard< std::mutex > lock(_histogramMutex);
+  return _histogram;
+}
+
+void InputLatencyMonitor::clear()
+{
+  std::lock_guard< std::mutex > lock(_histogramMutex);
+  _histogram.clear();
+}
+
+void InputLatencyMonitor::dump(std::ostream& out) const
+{
+  auto h = getHistogram();
+  out << std::fixed << std::setprecision(3);
+  out << "input_latency count=" << h.getCount() << " p50_ms=" << h.getPercentileMs(0.5f)
+    << " p99_ms=" << h.getPercentileMs(0.99f) << " max_ms=" << h.getMaxMs() << "\n";
+  out << std::defaultfloat;
+}
+
+} // namespace ml
@@ -0,0 +1,78 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace ml {
+
+using InputTime = std::chrono::time_point< std::chrono::steady_clock >;
+
+// LatencyHistogram: a fixed-size histogram of durations with logarithmically
+// spaced buckets, four per octave starting at one microsecond. Adding a sample
+// does not allocate.
+class LatencyHistogram
+{
+public:
+  static constexpr int kBucketsPerOctave{4};
+  static constexpr int kOctaves{26};
+  static constexpr int kNumBuckets{kBucketsPerOctave*kOctaves};
+
+  void addSample(std::chrono::nanoseconds d);
+  void clear();
+
+  size_t getCount() const { return _count; }
+
+  // get the duration in milliseconds below which the fraction p of samples fall.
+  // The upper edge of the containing bucket is returned, so values are accurate to
+  // about 19%.
+  double getPercentileMs(float p) const;
+  double getMaxMs() const { return _maxNs*1e-6; }
+
+private:
+  std::array< size_t, kNumBuckets > _counts{};
+  size_t _count{0};
+  double _maxNs{0};
+};
+
+// InputLatencyMonitor: measures the time from an input event entering the
+// GUIEventQueue to the presentation of the first frame that shows its effect.
+// While a frame is drawn, the View reports the input times of each dirty Widget
+// it draws. When the platform view presents the frame, the elapsed time for each
+// distinct input time is added to the histogram.
+//
+// The stats are printed by AppView::debugAppView() if the drawing property
+// debug_input_latency is set. testapp --latency-bench measures them for
+// synthetic events.
+class InputLatencyMonitor
+{
+public:
+  InputLatencyMonitor() { _pendingTimes.reserve(kMaxPendingTimes); }
+
+  // render thread
+  void widgetDrawn(InputTime t);
+  void framePresented();
+
+  // any thread
+  LatencyHistogram getHistogram() const;
+  void clear();
+
+  // write a single line of stats in a form that is easy to scrape.
+  void dump(std::ostream& out) const;
+
+private:
+  static constexpr size_t kMaxPendingTimes{64};
+  std::vector< InputTime > _pendingTimes;
+
+  mutable std::mutex _histogramMutex;
+  LatencyHistogram _histogram;
+};
+
+} // namespace ml
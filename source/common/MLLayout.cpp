@@ -0,0 +1,182 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+#include "MLLayout.h"
+
+namespace ml {
+
+void Layout::anchor(Path name, Rect size, Vec2 viewFraction, Vec2 offset, Vec2 align)
+{
+  Rule r;
+  r.kind = Kind::kAnchor;
+  r.size = size;
+  r.fraction = viewFraction;
+  r.offset = offset;
+  r.align = align;
+  _setRule(name, r);
+}
+
+bool Layout::relative(Path name, Path ref, Rect size, Vec2 refFraction, Vec2 offset, Vec2 align)
+{
+  Rule r;
+  r.kind = Kind::kRelative;
+  r.ref = ref;
+  r.size = size;
+  r.fraction = refFraction;
+  r.offset = offset;
+  r.align = align;
+  return _setRule(name, r);
+}
+
+bool Layout::grid(Path name, Path area, int column, int row, int columns, int rows, Rect size)
+{
+  Rule r;
+  r.kind = Kind::kGrid;
+  r.ref = area;
+  r.size = size;
+  r.column = column;
+  r.row = row;
+  r.columns = std::max(columns, 1);
+  r.rows = std::max(rows, 1);
+  return _setRule(name, r);
+}
+
+void Layout::fixed(Path name, Rect bounds)
+{
+  Rule r;
+  r.kind = Kind::kFixed;
+  r.size = bounds;
+  _setRule(name, r);
+}
+
+void Layout::clear()
+{
+  _nodes.clear();
+  _indexByName.clear();
+  _dirty.clear();
+}
+
+void Layout::setViewSize(Vec2 size)
+{
+  if(size == _viewSize) return;
+  _viewSize = size;
+  for(size_t i = 0; i < _nodes.size(); ++i)
+  {
+    if(_nodes[i].rule.kind == Kind::kAnchor)
+    {
+      _dirty.insert(i);
+    }
+  }
+}
+
+bool Layout::_setRule(Path name, const Rule& rule)
+{
+  size_t index = _indexByName[name];
+  
+  // a rule can only refer to rects declared before it, so there are no cycles
+  // and each rect is solved after the rects it uses.
+  if(rule.ref)
+  {
+    size_t ref = _indexByName[rule.ref];
+    if(!ref || (index && (ref >= index)))
+    {
+      return false;
+    }
+  }
+  
+  if(!index)
+  {
+    _nodes.emplace_back();
+    _nodes.back().name = name;
+    index = _nodes.size();
+    _indexByName[name] = index;
+  }
+  size_t i = index - 1;
+  Node& node = _nodes[i];
+
+  // forget the old reference.
+  if(node.rule.ref)
+  {
+    size_t oldRef = _indexByName[node.rule.ref];
+    if(oldRef)
+    {
+      auto& d = _nodes[oldRef - 1].dependents;
+      d.erase(std::remove(d.begin(), d.end(), i), d.end());
+    }
+  }
+
+  node.rule = rule;
+  if(rule.ref)
+  {
+    _nodes[_indexByName[rule.ref] - 1].dependents.push_back(i);
+  }
+  _dirty.insert(i);
+  return true;
+}
+
+Rect Layout::_place(const Node& node) const
+{
+  const Rule& r = node.rule;
+  Vec2 point;
+  switch(r.kind)
+  {
+    case Kind::kFixed:
+    default:
+      return r.size;
+    case Kind::kAnchor:
+      point = _viewSize*r.fraction + r.offset;
+      break;
+    case Kind::kRelative:
+    {
+      Rect ref = getBounds(r.ref);
+      point = ref.topLeft() + ref.dims()*r.fraction + r.offset;
+      break;
+    }
+    case Kind::kGrid:
+    {
+      Rect area = getBounds(r.ref);
+      Vec2 cellSize(area.width()/r.columns, area.height()/r.rows);
+      Rect cell(area.left() + cellSize.x()*r.column, area.top() + cellSize.y()*r.row, cellSize.x(), cellSize.y());
+      if((r.size.width() == 0) || (r.size.height() == 0)) return cell;
+      return alignCenterToPoint(r.size, cell.center());
+    }
+  }
+  Vec2 dims = r.size.dims();
+  Vec2 topLeft = point - dims*r.align;
+  return Rect(topLeft.x(), topLeft.y(), dims.x(), dims.y());
+}
+
+std::vector< Path > Layout::solve()
+{
+  std::vector< Path > moved;
+  _solvedCount = 0;
+
+  // the lowest index first, so that each node is solved after the nodes it uses.
+  while(!_dirty.empty())
+  {
+    size_t i = *_dirty.begin();
+    _dirty.erase(_dirty.begin());
+    _solvedCount++;
+
+    Node& node = _nodes[i];
+    Rect bounds = _place(node);
+    if(!node.placed || (bounds != node.bounds))
+    {
+      node.bounds = bounds;
+      node.placed = true;
+      moved.push_back(node.name);
+      _dirty.insert(node.dependents.begin(), node.dependents.end());
+    }
+  }
+  return moved;
+}
+
+Rect Layout::getBounds(Path name) const
+{
+  size_t index = _indexByName[name];
+  return index ? _nodes[index - 1].bounds : Rect();
+}
+
+} // namespace ml
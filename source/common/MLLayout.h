@@ -0,0 +1,129 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+// Layout: a declarative description of where things go in a view, solved
+// incrementally. Each rule places one named rect in grid coordinates, either
+// relative to the view or to a rect placed by an earlier rule: anchored to a
+// point of the view, aligned under another rect, or in a cell of a grid over
+// another rect.
+//
+// Rules are declared once, usually when Widgets are made. When the view size
+// or a rule changes, solve() recomputes only the rects whose inputs changed,
+// and returns the names of those that actually moved. An AppView with a Layout
+// moves and redraws just those Widgets.
+
+#pragma once
+
+#include <set>
+#include <vector>
+
+#include "MLMath2D.h"
+#include "MLPath.h"
+#include "MLTree.h"
+
+namespace ml {
+
+class Layout
+{
+public:
+  // place name with its point at the fraction align of its size, (0.5, 0.5)
+  // being the center, at viewFraction*viewSize + offset.
+  void anchor(Path name, Rect size, Vec2 viewFraction, Vec2 offset = Vec2(), Vec2 align = Vec2(0.5f, 0.5f));
+
+  // place name with its point at the fraction align of its size at the point
+  // refFraction of the rect ref, plus offset.
+  //
+  // A rule can only refer to a rect whose rule was declared before it. A rule
+  // referring to any other rect is rejected, leaving any old rule for name in
+  // place, and false is returned.
+  bool relative(Path name, Path ref, Rect size, Vec2 refFraction, Vec2 offset = Vec2(),
+                Vec2 align = Vec2(0.5f, 0.5f));
+
+  // place name centered under the rect above, like a label under a dial.
+  bool under(Path name, Path above, Rect size, Vec2 offset = Vec2())
+  {
+    return relative(name, above, size, Vec2(0.5f, 1.f), offset);
+  }
+
+  // place name centered in the cell (column, row) of a grid of columns x rows
+  // cells over the rect area. If size is empty, the cell is filled. As with
+  // relative(), area must have been declared before.
+  bool grid(Path name, Path area, int column, int row, int columns, int rows, Rect size = Rect());
+
+  // place name at fixed bounds.
+  void fixed(Path name, Rect bounds);
+
+  // remove all rules.
+  void clear();
+
+  // set the size of the view in grid units. Rules that depend on it are
+  // solved again by the next solve().
+  void setViewSize(Vec2 size);
+  Vec2 getViewSize() const { return _viewSize; }
+
+  // solve the rules whose inputs have changed since the last solve(), and
+  // return the names of the rects that moved.
+  std::vector< Path > solve();
+
+  // true if any rules need solving.
+  bool needsSolve() const { return !_dirty.empty(); }
+
+  // the bounds of a rect after solve(), or an empty Rect if there is no rule for it.
+  Rect getBounds(Path name) const;
+
+  bool hasRule(Path name) const { return _indexByName[name] != 0; }
+  size_t getNumRules() const { return _nodes.size(); }
+
+  // the number of rules solved by the last solve().
+  size_t getSolvedCount() const { return _solvedCount; }
+
+private:
+  enum class Kind
+  {
+    kFixed,
+    kAnchor,
+    kRelative,
+    kGrid
+  };
+
+  struct Rule
+  {
+    Kind kind{Kind::kFixed};
+    Path ref;
+    Rect size;
+    Vec2 fraction;
+    Vec2 offset;
+    Vec2 align;
+    int column{0}, row{0}, columns{1}, rows{1};
+  };
+
+  struct Node
+  {
+    Path name;
+    Rule rule;
+    Rect bounds;
+    bool placed{false};
+
+    // the nodes with rules that use our bounds.
+    std::vector< size_t > dependents;
+  };
+
+  bool _setRule(Path name, const Rule& rule);
+  Rect _place(const Node& node) const;
+
+  std::vector< Node > _nodes;
+
+  // index + 1 of each node by name, so that 0 means no node.
+  Tree< size_t > _indexByName;
+
+  // the nodes to solve, in order. A node can only depend on nodes declared
+  // before it, so solving in index order solves each node once.
+  std::set< size_t > _dirty;
+
+  Vec2 _viewSize;
+  size_t _solvedCount{0};
+};
+
+} // namespace ml
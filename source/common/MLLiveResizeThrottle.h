@@ -0,0 +1,70 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+#pragma once
+
+#include <chrono>
+
+namespace ml {
+
+// LiveResizeThrottle: decides when the size changes of a live resize, such as
+// a Resizer drag, are laid out. While active, a requested layout is done at most
+// once per interval. Otherwise it is done right away.
+//
+// A live resize that sees no requests for the timeout is ended, so that if the
+// end of a drag is lost the view does not stay on its scaled preview.
+class LiveResizeThrottle
+{
+public:
+  using TimePoint = std::chrono::time_point< std::chrono::steady_clock >;
+
+  void begin(TimePoint now)
+  {
+    _active = true;
+    _lastRequestTime = now;
+  }
+
+  void end() { _active = false; }
+
+  bool isActive() const { return _active; }
+  bool isPending() const { return _pending; }
+
+  // request a layout at a new size.
+  void request(TimePoint now)
+  {
+    _pending = true;
+    _lastRequestTime = now;
+  }
+
+  // call once per frame. Returns true if the pending layout should be done now.
+  bool update(TimePoint now, double intervalInMs, double timeoutInMs)
+  {
+    if(_active && (msSince(_lastRequestTime, now) >= timeoutInMs))
+    {
+      _active = false;
+    }
+
+    if(_pending && (!_active || (msSince(_lastLayoutTime, now) >= intervalInMs)))
+    {
+      _pending = false;
+      _lastLayoutTime = now;
+      return true;
+    }
+    return false;
+  }
+
+private:
+  static double msSince(TimePoint t, TimePoint now)
+  {
+    return std::chrono::duration< double, std::milli >(now - t).count();
+  }
+
+  bool _active{ false };
+  bool _pending{ false };
+  TimePoint _lastRequestTime;
+  TimePoint _lastLayoutTime;
+};
+
+} // namespace ml
@@ -266,6 +266,11 @@ Vec2 Rect::bottomCenter() const
   return Vec2(left() + width()*0.5f, bottom());
 }
 
+Vec2 Rect::dims() const
+{
+  return Vec2(width(), height());
+}
+
 
 Rect intersectRects(const Rect& a, const Rect& b)
 {
@@ -410,6 +415,195 @@ Rect alignRect(const Rect& a, const Rect& b, alignFlags flags)
 }
 
 
+// Region
+
+Region::Region(const Rect& r)
+{
+  if((r.width() > 0) && (r.height() > 0))
+  {
+    _bands.push_back(Band{r.top(), r.bottom(), {r.left(), r.right()}});
+  }
+}
+
+Rect Region::getBounds() const
+{
+  if(_bands.empty()) return Rect();
+  float l{_bands.front().spans.front()};
+  float r{_bands.front().spans.back()};
+  for(const auto& band : _bands)
+  {
+    l = ml::min(l, band.spans.front());
+    r = ml::max(r, band.spans.back());
+  }
+  float t = _bands.front().top;
+  return Rect(l, t, r - l, _bands.back().bottom - t);
+}
+
+float Region::area() const
+{
+  float sum{0};
+  for(const auto& band : _bands)
+  {
+    for(size_t i = 0; i < band.spans.size(); i += 2)
+    {
+      sum += (band.spans[i + 1] - band.spans[i])*(band.bottom - band.top);
+    }
+  }
+  return sum;
+}
+
+std::vector< Rect > Region::getRects() const
+{
+  std::vector< Rect > rects;
+  rects.reserve(getNumRects());
+  for(const auto& band : _bands)
+  {
+    for(size_t i = 0; i < band.spans.size(); i += 2)
+    {
+      rects.emplace_back(band.spans[i], band.top, band.spans[i + 1] - band.spans[i], band.bottom - band.top);
+    }
+  }
+  return rects;
+}
+
+size_t Region::getNumRects() const
+{
+  size_t n{0};
+  for(const auto& band : _bands)
+  {
+    n += band.spans.size()/2;
+  }
+  return n;
+}
+
+bool Region::intersects(const Rect& r) const
+{
+  if((r.width() <= 0) || (r.height() <= 0)) return false;
+  for(const auto& band : _bands)
+  {
+    if(band.bottom <= r.top()) continue;
+    if(band.top >= r.bottom()) break;
+    for(size_t i = 0; i < band.spans.size(); i += 2)
+    {
+      if((band.spans[i] < r.right()) && (band.spans[i + 1] > r.left())) return true;
+    }
+  }
+  return false;
+}
+
+bool Region::contains(const Rect& r) const
+{
+  return Region(r).subtract(*this).isEmpty();
+}
+
+bool Region::operator==(const Region& b) const
+{
+  if(_bands.size() != b._bands.size()) return false;
+  for(size_t i = 0; i < _bands.size(); ++i)
+  {
+    const Band& p = _bands[i];
+    const Band& q = b._bands[i];
+    if((p.top != q.top) || (p.bottom != q.bottom) || (p.spans != q.spans)) return false;
+  }
+  return true;
+}
+
+// sweep across the edges of both span lists in x order, keeping track of
+// whether we are inside each, and write an edge wherever the result of
+// the op changes.
+void Region::combineSpans(const std::vector< float >& a, const std::vector< float >& b, Op op,
+                          std::vector< float >& result)
+{
+  result.clear();
+  size_t i{0}, j{0};
+  bool inA{false}, inB{false}, inResult{false};
+  while((i < a.size()) || (j < b.size()))
+  {
+    float x = (j >= b.size()) ? a[i] : (i >= a.size()) ? b[j] : ml::min(a[i], b[j]);
+    while((i < a.size()) && (a[i] == x))
+    {
+      inA = !inA;
+      i++;
+    }
+    while((j < b.size()) && (b[j] == x))
+    {
+      inB = !inB;
+      j++;
+    }
+
+    bool in{false};
+    switch(op)
+    {
+      case Op::kUnion:
+        in = inA || inB;
+        break;
+      case Op::kIntersect:
+        in = inA && inB;
+        break;
+      case Op::kSubtract:
+        in = inA && !inB;
+        break;
+    }
+    if(in != inResult)
+    {
+      result.push_back(x);
+      inResult = in;
+    }
+  }
+}
+
+void Region::appendBand(float top, float bottom, const std::vector< float >& spans)
+{
+  if(spans.empty()) return;
+  if(!_bands.empty())
+  {
+    Band& last = _bands.back();
+    if((last.bottom == top) && (last.spans == spans))
+    {
+      last.bottom = bottom;
+      return;
+    }
+  }
+  _bands.push_back(Band{top, bottom, spans});
+}
+
+// split both regions at every band edge of either, and combine the spans of
+// each piece.
+Region Region::combine(const Region& a, const Region& b, Op op)
+{
+  std::vector< float > ys;
+  ys.reserve((a._bands.size() + b._bands.size())*2);
+  for(const auto& band : a._bands)
+  {
+    ys.push_back(band.top);
+    ys.push_back(band.bottom);
+  }
+  for(const auto& band : b._bands)
+  {
+    ys.push_back(band.top);
+    ys.push_back(band.bottom);
+  }
+  std::sort(ys.begin(), ys.end());
+  ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+
+  static const std::vector< float > kNoSpans;
+  Region result;
+  std::vector< float > spans;
+  size_t ia{0}, ib{0};
+  for(size_t k = 0; k + 1 < ys.size(); ++k)
+  {
+    float y0 = ys[k];
+    float y1 = ys[k + 1];
+    while((ia < a._bands.size()) && (a._bands[ia].bottom <= y0)) ia++;
+    while((ib < b._bands.size()) && (b._bands[ib].bottom <= y0)) ib++;
+    bool hasA = (ia < a._bands.size()) && (a._bands[ia].top <= y0);
+    bool hasB = (ib < b._bands.size()) && (b._bands[ib].top <= y0);
+    combineSpans(hasA ? a._bands[ia].spans : kNoSpans, hasB ? b._bands[ib].spans : kNoSpans, op, spans);
+    result.appendBand(y0, y1, spans);
+  }
+  return result;
+}
+
 /*
 std::ostream& operator<< (std::ostream& out, const Vec2& r)
 {
@@ -10,6 +10,7 @@
 #include <array>
 #include <cmath>
 #include <algorithm>
+#include <vector>
 
 #include "mldsp.h"
 #include "MLMatrix.h"
@@ -464,6 +465,66 @@ enum alignFlags
 };
 
 Rect alignRect(const Rect& rectToAlign, const Rect& fixedRect, alignFlags flags);
+
+// Region: an area made of any number of rects, such as the parts of a view
+// that need to be redrawn. It is stored as bands from top to bottom, each with
+// a sorted list of x spans, as in the X11 and pixman regions. Bands don't
+// overlap and touching bands with the same spans are merged, so an area has
+// only one representation, and union, intersect and subtract are linear in
+// the number of spans.
+class Region
+{
+public:
+  Region() = default;
+  Region(const Rect& r);
+
+  bool isEmpty() const { return _bands.empty(); }
+  void clear() { _bands.clear(); }
+
+  // the smallest Rect enclosing the region.
+  Rect getBounds() const;
+  float area() const;
+
+  // the non-overlapping rects making up the region, top to bottom then left to right.
+  std::vector< Rect > getRects() const;
+  size_t getNumRects() const;
+
+  bool intersects(const Rect& r) const;
+  bool contains(const Rect& r) const;
+
+  Region unionWith(const Region& b) const { return combine(*this, b, Op::kUnion); }
+  Region intersect(const Region& b) const { return combine(*this, b, Op::kIntersect); }
+  Region subtract(const Region& b) const { return combine(*this, b, Op::kSubtract); }
+
+  void add(const Rect& r) { *this = unionWith(Region(r)); }
+
+  bool operator==(const Region& b) const;
+  bool operator!=(const Region& b) const { return !(*this == b); }
+
+private:
+  enum class Op
+  {
+    kUnion,
+    kIntersect,
+    kSubtract
+  };
+
+  struct Band
+  {
+    float top;
+    float bottom;
+
+    // pairs of left and right edges.
+    std::vector< float > spans;
+  };
+
+  static Region combine(const Region& a, const Region& b, Op op);
+  static void combineSpans(const std::vector< float >& a, const std::vector< float >& b, Op op,
+                           std::vector< float >& result);
+  void appendBand(float top, float bottom, const std::vector< float >& spans);
+
+  std::vector< Band > _bands;
+};
 /*
  std::ostream& operator<< (std::ostream& out, const Vec2& r);
  std::ostream& operator<< (std::ostream& out, const Vec3& r);
@@ -0,0 +1,166 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+// ParameterRamps: turns timestamped parameter changes into one DSPVector ramp
+// per parameter for each vector processed, so automation is sample-accurate at
+// any host block size. Storage is dense and indexed by parameter ID, and is all
+// allocated by resize(), so the audio thread does no lookups or allocation.
+//
+// Times are in samples from the start of processing. Points are given in real
+// values and the ramps are linear between them. Once processing has started,
+// values and points must only be set on the audio thread: values from other
+// threads, such as a preset being loaded, must be sent to it and set there.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "MLDSPOps.h"
+
+namespace ml {
+
+class ParameterRamps
+{
+public:
+  static constexpr size_t kMaxPointsPerParam{32};
+
+  // call before processing starts, not on the audio thread.
+  void resize(size_t nParams)
+  {
+    _params.resize(nParams);
+  }
+
+  size_t size() const { return _params.size(); }
+
+  // set a value immediately, discarding any pending points.
+  void setValue(size_t id, float value)
+  {
+    if(id >= _params.size()) return;
+    Param& p = _params[id];
+    p.startValue = value;
+    p.currentValue = value;
+    p.readIdx = p.writeIdx = 0;
+    p.rampIsCurrent = false;
+  }
+
+  // the value at the end of the last vector processed, or the last value set.
+  float getValue(size_t id) const
+  {
+    return (id < _params.size()) ? _params[id].currentValue : 0.f;
+  }
+
+  // call at the start of each host block, before adding the block's points.
+  void beginBlock(uint64_t blockStartTime)
+  {
+    _blockStartTime = blockStartTime;
+  }
+
+  // add a point to the parameter's ramp. Points for each parameter must be added
+  // in time order. The value holds from the previous point until the start of the
+  // block, then ramps to the first point in the block. If there is no room, the
+  // newest point is replaced.
+  void addPoint(size_t id, uint64_t time, float value)
+  {
+    if(id >= _params.size()) return;
+    Param& p = _params[id];
+    Point prev = p.pending() ? p.points[(p.writeIdx - 1) % kMaxPointsPerParam] : Point{p.startTime, p.startValue};
+    if(prev.time < _blockStartTime)
+    {
+      pushPoint(p, Point{_blockStartTime, prev.value});
+    }
+    pushPoint(p, Point{std::max(time, prev.time), value});
+  }
+
+  // make the ramps for the vector starting at vectorStartTime.
+  void processVector(uint64_t vectorStartTime)
+  {
+    for(auto& p : _params)
+    {
+      if(!p.pending())
+      {
+        // no changes: fill the ramp only if the value is new.
+        if(!p.rampIsCurrent)
+        {
+          p.ramp = DSPVector(p.startValue);
+          p.currentValue = p.startValue;
+          p.rampIsCurrent = true;
+        }
+        continue;
+      }
+
+      float* pRamp = p.ramp.getBuffer();
+      for(size_t i = 0; i < kFloatsPerDSPVector; ++i)
+      {
+        uint64_t t = vectorStartTime + i;
+
+        // move past points that have been reached.
+        while(p.pending() && (p.points[p.readIdx % kMaxPointsPerParam].time <= t))
+        {
+          const Point& next = p.points[p.readIdx % kMaxPointsPerParam];
+          p.startTime = next.time;
+          p.startValue = next.value;
+          p.readIdx++;
+        }
+
+        if(p.pending())
+        {
+          const Point& next = p.points[p.readIdx % kMaxPointsPerParam];
+          float fraction = float(t - p.startTime)/float(next.time - p.startTime);
+          pRamp[i] = p.startValue + (next.value - p.startValue)*fraction;
+        }
+        else
+        {
+          pRamp[i] = p.startValue;
+        }
+      }
+      p.currentValue = pRamp[kFloatsPerDSPVector - 1];
+      p.rampIsCurrent = false;
+    }
+  }
+
+  // the ramp for the last vector processed.
+  const DSPVector& getRamp(size_t id) const { return _params[id].ramp; }
+
+private:
+  struct Point
+  {
+    uint64_t time;
+    float value;
+  };
+
+  struct Param
+  {
+    DSPVector ramp;
+    Point points[kMaxPointsPerParam];
+    size_t readIdx{0};
+    size_t writeIdx{0};
+
+    // the start of the current segment.
+    uint64_t startTime{0};
+    float startValue{0.f};
+
+    float currentValue{0.f};
+    bool rampIsCurrent{false};
+
+    bool pending() const { return writeIdx != readIdx; }
+  };
+
+  void pushPoint(Param& p, Point pt)
+  {
+    if(p.writeIdx - p.readIdx >= kMaxPointsPerParam)
+    {
+      p.writeIdx--;
+    }
+    p.points[p.writeIdx % kMaxPointsPerParam] = pt;
+    p.writeIdx++;
+  }
+
+  std::vector< Param > _params;
+  uint64_t _blockStartTime{0};
+};
+
+} // namespace ml
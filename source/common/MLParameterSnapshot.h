@@ -0,0 +1,85 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+// ParameterSnapshot: a triple-buffered, dense array of parameter values shared
+// between one writer, such as a processor's Actor thread, and one reader, such
+// as the audio callback. The writer sets values by index and publishes them all
+// at once. The reader gets the most recently published values with acquire(),
+// which does one atomic load when nothing has changed and one exchange when
+// something has. Neither side ever blocks or allocates after construction.
+//
+// Values are stored as the writer gives them: typically real values, already
+// projected from normalized ones, so the reader does no work to use them.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+namespace ml {
+
+class ParameterSnapshot
+{
+public:
+  explicit ParameterSnapshot(size_t nParams) : _size(nParams), _staging(nParams, 0.f)
+  {
+    for(auto& b : _buffers)
+    {
+      b.resize(nParams, 0.f);
+    }
+  }
+  ~ParameterSnapshot() = default;
+
+  size_t size() const { return _size; }
+
+  // writer. Set a value to be published by the next publish().
+  void setValue(size_t id, float value)
+  {
+    if(id < _size) _staging[id] = value;
+  }
+
+  float getStagedValue(size_t id) const
+  {
+    return (id < _size) ? _staging[id] : 0.f;
+  }
+
+  // writer. Publish all of the staged values to the reader.
+  void publish()
+  {
+    std::memcpy(_buffers[_writeIdx].data(), _staging.data(), _size*sizeof(float));
+    int prev = _middle.exchange(_writeIdx | kFreshBit, std::memory_order_acq_rel);
+    _writeIdx = prev & kIndexMask;
+  }
+
+  // reader. Get the most recently published values. The pointer stays valid
+  // and unchanged until the next call to acquire().
+  const float* acquire()
+  {
+    if(_middle.load(std::memory_order_relaxed) & kFreshBit)
+    {
+      int prev = _middle.exchange(_readIdx, std::memory_order_acq_rel);
+      _readIdx = prev & kIndexMask;
+    }
+    return _buffers[_readIdx].data();
+  }
+
+private:
+  static constexpr int kIndexMask{3};
+  static constexpr int kFreshBit{4};
+
+  size_t _size;
+  std::vector< float > _buffers[3];
+  std::vector< float > _staging;
+
+  // the writer owns _buffers[_writeIdx] and the reader owns _buffers[_readIdx].
+  // The third buffer is in the middle, waiting to be picked up.
+  int _writeIdx{0};
+  alignas(64) std::atomic< int > _middle{1};
+  alignas(64) int _readIdx{2};
+};
+
+} // namespace ml
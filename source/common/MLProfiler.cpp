@@ -0,0 +1,92 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+#include "MLProfiler.h"
+
+#if ML_PROFILER
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "cJSON.h"
+
+namespace ml {
+
+void ProfileRing::read(std::vector< ProfileSpan >& out) const
+{
+  size_t end = _writeIndex.load(std::memory_order_acquire);
+  size_t start = (end > kSize) ? end - kSize : 0;
+  for(size_t i = start; i < end; ++i)
+  {
+    const ProfileSpan& s = _spans[i & (kSize - 1)];
+    if(s.name)
+    {
+      out.push_back(s);
+    }
+  }
+}
+
+Profiler& Profiler::instance()
+{
+  static Profiler p;
+  return p;
+}
+
+ProfileRing* Profiler::makeRing()
+{
+  std::lock_guard< std::mutex > lock(_ringsMutex);
+  _rings.emplace_back(std::make_unique< ProfileRing >(int(_rings.size())));
+  return _rings.back().get();
+}
+
+std::string Profiler::getChromeTraceJSON() const
+{
+  cJSON* root = cJSON_CreateObject();
+  cJSON* events = cJSON_CreateArray();
+  cJSON_AddItemToObject(root, "traceEvents", events);
+  cJSON_AddStringToObject(root, "displayTimeUnit", "ms");
+
+  std::vector< ProfileSpan > spans;
+  spans.reserve(ProfileRing::kSize);
+
+  std::lock_guard< std::mutex > lock(_ringsMutex);
+  for(const auto& ring : _rings)
+  {
+    spans.clear();
+    ring->read(spans);
+    for(const auto& s : spans)
+    {
+      // complete events ("X") with times in microseconds.
+      cJSON* e = cJSON_CreateObject();
+      cJSON_AddStringToObject(e, "name", s.name);
+      cJSON_AddStringToObject(e, "ph", "X");
+      cJSON_AddNumberToObject(e, "ts", s.startNs*1e-3);
+      cJSON_AddNumberToObject(e, "dur", s.durationNs*1e-3);
+      cJSON_AddNumberToObject(e, "pid", 1);
+      cJSON_AddNumberToObject(e, "tid", ring->getThreadIndex());
+      cJSON_AddItemToArray(events, e);
+    }
+  }
+
+  char* pText = cJSON_PrintUnformatted(root);
+  std::string r(pText ? pText : "");
+  free(pText);
+  cJSON_Delete(root);
+  return r;
+}
+
+bool Profiler::writeChromeTrace(const char* path) const
+{
+  std::string json = getChromeTraceJSON();
+  FILE* f = fopen(path, "wb");
+  if(!f) return false;
+  size_t written = fwrite(json.data(), 1, json.size(), f);
+  fclose(f);
+  return written == json.size();
+}
+
+} // namespace ml
+
+#endif // ML_PROFILER
@@ -0,0 +1,134 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+// A low-overhead profiler for the frame loop. Scoped timers record spans into
+// a lock-free ring buffer owned by the current thread. On demand, the spans in all
+// rings can be written as Chrome trace-event JSON, which can be opened in
+// chrome://tracing or https://ui.perfetto.dev.
+//
+// Profiling is compiled in only if ML_PROFILER is defined to 1, which the CMake
+// option ML_PROFILER does. Otherwise ML_PROFILE_SCOPE expands to nothing.
+
+#pragma once
+
+#ifndef ML_PROFILER
+#define ML_PROFILER 0
+#endif
+
+#if ML_PROFILER
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ml {
+
+struct ProfileSpan
+{
+  // must point to a string with static storage duration.
+  const char* name{nullptr};
+  int64_t startNs{0};
+  int64_t durationNs{0};
+};
+
+// a ring of spans written only by its owning thread. Once the ring is full,
+// the oldest spans are overwritten.
+class ProfileRing
+{
+public:
+  static constexpr size_t kSize{1 << 14};
+
+  explicit ProfileRing(int threadIndex) : _threadIndex(threadIndex) {}
+
+  void write(const ProfileSpan& s)
+  {
+    size_t w = _writeIndex.load(std::memory_order_relaxed);
+    _spans[w & (kSize - 1)] = s;
+    _writeIndex.store(w + 1, std::memory_order_release);
+  }
+
+  // copy the spans currently in the ring. A span being overwritten while
+  // this is called may be garbled, which is acceptable for a profiler.
+  void read(std::vector< ProfileSpan >& out) const;
+
+  int getThreadIndex() const { return _threadIndex; }
+
+private:
+  std::array< ProfileSpan, kSize > _spans;
+  std::atomic< size_t > _writeIndex{0};
+  int _threadIndex;
+};
+
+class Profiler
+{
+public:
+  static Profiler& instance();
+
+  // get the ring for the calling thread, making it the first time.
+  ProfileRing& getThreadRing()
+  {
+    thread_local ProfileRing* pRing{nullptr};
+    if(!pRing)
+    {
+      pRing = makeRing();
+    }
+    return *pRing;
+  }
+
+  int64_t nowNs() const
+  {
+    using namespace std::chrono;
+    return duration_cast< nanoseconds >(steady_clock::now() - _startTime).count();
+  }
+
+  // return the spans in all rings as Chrome trace-event JSON.
+  std::string getChromeTraceJSON() const;
+
+  // write Chrome trace-event JSON to the file at the given path. Returns true on success.
+  bool writeChromeTrace(const char* path) const;
+
+private:
+  Profiler() : _startTime(std::chrono::steady_clock::now()) {}
+  ProfileRing* makeRing();
+
+  std::chrono::steady_clock::time_point _startTime;
+
+  // rings are kept for the life of the process so that spans from exited
+  // threads can still be dumped.
+  mutable std::mutex _ringsMutex;
+  std::vector< std::unique_ptr< ProfileRing > > _rings;
+};
+
+class ProfileScope
+{
+public:
+  explicit ProfileScope(const char* name) : _name(name), _startNs(Profiler::instance().nowNs()) {}
+  ~ProfileScope()
+  {
+    auto& p = Profiler::instance();
+    int64_t endNs = p.nowNs();
+    p.getThreadRing().write({_name, _startNs, endNs - _startNs});
+  }
+
+private:
+  const char* _name;
+  int64_t _startNs;
+};
+
+} // namespace ml
+
+#define ML_PROFILE_CONCAT_(a, b) a##b
+#define ML_PROFILE_CONCAT(a, b) ML_PROFILE_CONCAT_(a, b)
+#define ML_PROFILE_SCOPE(name) ml::ProfileScope ML_PROFILE_CONCAT(mlProfileScope_, __LINE__)(name)
+
+#else
+
+#define ML_PROFILE_SCOPE(name)
+
+#endif // ML_PROFILER
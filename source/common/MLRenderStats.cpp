@@ -0,0 +1,372 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <mutex>
+
+#include "MLRenderStats.h"
+
+namespace ml {
+
+// RenderStats
+
+RenderStats& RenderStats::operator+=(const RenderStats& b)
+{
+  fills += b.fills;
+  strokes += b.strokes;
+  triangles += b.triangles;
+  vertices += b.vertices;
+  scissorChanges += b.scissorChanges;
+  textureCreates += b.textureCreates;
+  textureUpdates += b.textureUpdates;
+  pixelsCovered += b.pixelsCovered;
+  widgetsOccluded += b.widgetsOccluded;
+  return *this;
+}
+
+RenderStats operator-(const RenderStats& a, const RenderStats& b)
+{
+  RenderStats r;
+  r.fills = a.fills - b.fills;
+  r.strokes = a.strokes - b.strokes;
+  r.triangles = a.triangles - b.triangles;
+  r.vertices = a.vertices - b.vertices;
+  r.scissorChanges = a.scissorChanges - b.scissorChanges;
+  r.textureCreates = a.textureCreates - b.textureCreates;
+  r.textureUpdates = a.textureUpdates - b.textureUpdates;
+  r.pixelsCovered = a.pixelsCovered - b.pixelsCovered;
+  r.widgetsOccluded = a.widgetsOccluded - b.widgetsOccluded;
+  return r;
+}
+
+std::ostream& operator<<(std::ostream& out, const RenderStats& s)
+{
+  out << "fills: " << s.fills << " strokes: " << s.strokes << " tris: " << s.triangles
+    << " verts: " << s.vertices << " scissors: " << s.scissorChanges
+    << " tex new: " << s.textureCreates << " tex upd: " << s.textureUpdates
+    << " pixels: " << size_t(s.pixelsCovered) << " occluded: " << s.widgetsOccluded;
+  return out;
+}
+
+// wrapped contexts
+//
+// nanovg passes the backend's userPtr to each render callback, and backend
+// utilities like the framebuffer functions get it from nvgInternalParams().
+// So we leave userPtr alone and find our state by looking it up. There are
+// only ever a few contexts, so a small fixed table is fine.
+
+namespace {
+
+struct WrappedContext
+{
+  std::atomic< void* > userPtr{nullptr};
+  NVGparams original{};
+  std::atomic< RenderStatsCollector* > pCollector{nullptr};
+};
+
+constexpr int kMaxWrappedContexts{64};
+WrappedContext gWrappedContexts[kMaxWrappedContexts];
+std::mutex gWrappedContextsMutex;
+
+// the callbacks of the last backend wrapped. Every context made by one backend
+// has the same callbacks, so if a wrapped context's slot is ever missing, its
+// calls still reach its backend through these.
+NVGparams gBackend{};
+std::atomic< bool > gHasBackend{false};
+
+WrappedContext* findWrappedContext(void* uptr)
+{
+  for(auto& c : gWrappedContexts)
+  {
+    if(c.userPtr.load(std::memory_order_acquire) == uptr) return &c;
+  }
+  return nullptr;
+}
+
+// the backend callbacks to forward to for a context. A missing slot is a bug,
+// but drawing continues through the last backend wrapped.
+const NVGparams& getOriginal(WrappedContext* c)
+{
+  if(c) return c->original;
+  assert(gHasBackend.load(std::memory_order_acquire));
+  return gBackend;
+}
+
+// area of the bounds (minx, miny, maxx, maxy) clipped to the scissor, in pixels.
+double clippedArea(float x0, float y0, float x1, float y1, const NVGscissor* s)
+{
+  // an extent < 0 means no scissor.
+  if(s && (s->extent[0] >= 0.f))
+  {
+    float ex = s->extent[0]*fabsf(s->xform[0]) + s->extent[1]*fabsf(s->xform[2]);
+    float ey = s->extent[0]*fabsf(s->xform[1]) + s->extent[1]*fabsf(s->xform[3]);
+    float cx = s->xform[4];
+    float cy = s->xform[5];
+    x0 = std::max(x0, cx - ex);
+    y0 = std::max(y0, cy - ey);
+    x1 = std::min(x1, cx + ex);
+    y1 = std::min(y1, cy + ey);
+  }
+  return double(std::max(0.f, x1 - x0))*double(std::max(0.f, y1 - y0));
+}
+
+double clippedVertexArea(const NVGvertex* verts, int n, const NVGscissor* s)
+{
+  if(n <= 0) return 0.;
+  float x0{verts[0].x}, y0{verts[0].y}, x1{x0}, y1{y0};
+  for(int i = 1; i < n; ++i)
+  {
+    x0 = std::min(x0, verts[i].x);
+    y0 = std::min(y0, verts[i].y);
+    x1 = std::max(x1, verts[i].x);
+    y1 = std::max(y1, verts[i].y);
+  }
+  return clippedArea(x0, y0, x1, y1, s);
+}
+
+int wrapCreateTexture(void* uptr, int type, int w, int h, int imageFlags, const unsigned char* data)
+{
+  WrappedContext* c = findWrappedContext(uptr);
+  if(auto p = c ? c->pCollector.load(std::memory_order_acquire) : nullptr)
+  {
+    p->currentStats().textureCreates++;
+  }
+  return getOriginal(c).renderCreateTexture(uptr, type, w, h, imageFlags, data);
+}
+
+int wrapUpdateTexture(void* uptr, int image, int x, int y, int w, int h, const unsigned char* data)
+{
+  WrappedContext* c = findWrappedContext(uptr);
+  if(auto p = c ? c->pCollector.load(std::memory_order_acquire) : nullptr)
+  {
+    p->currentStats().textureUpdates++;
+  }
+  return getOriginal(c).renderUpdateTexture(uptr, image, x, y, w, h, data);
+}
+
+void wrapFill(void* uptr, NVGpaint* paint, NVGcompositeOperationState op, NVGscissor* scissor,
+              float fringe, const float* bounds, const NVGpath* paths, int npaths)
+{
+  WrappedContext* c = findWrappedContext(uptr);
+  if(auto p = c ? c->pCollector.load(std::memory_order_acquire) : nullptr)
+  {
+    auto& s = p->currentStats();
+    s.fills++;
+    for(int i = 0; i < npaths; ++i)
+    {
+      s.vertices += paths[i].nfill + paths[i].nstroke;
+    }
+    s.pixelsCovered += clippedArea(bounds[0], bounds[1], bounds[2], bounds[3], scissor);
+    p->noteScissor(scissor);
+  }
+  getOriginal(c).renderFill(uptr, paint, op, scissor, fringe, bounds, paths, npaths);
+}
+
+void wrapStroke(void* uptr, NVGpaint* paint, NVGcompositeOperationState op, NVGscissor* scissor,
+                float fringe, float strokeWidth, const NVGpath* paths, int npaths)
+{
+  WrappedContext* c = findWrappedContext(uptr);
+  if(auto p = c ? c->pCollector.load(std::memory_order_acquire) : nullptr)
+  {
+    auto& s = p->currentStats();
+    s.strokes++;
+    for(int i = 0; i < npaths; ++i)
+    {
+      s.vertices += paths[i].nstroke;
+      s.pixelsCovered += clippedVertexArea(paths[i].stroke, paths[i].nstroke, scissor);
+    }
+    p->noteScissor(scissor);
+  }
+  getOriginal(c).renderStroke(uptr, paint, op, scissor, fringe, strokeWidth, paths, npaths);
+}
+
+void wrapTriangles(void* uptr, NVGpaint* paint, NVGcompositeOperationState op, NVGscissor* scissor,
+                   const NVGvertex* verts, int nverts, float fringe)
+{
+  WrappedContext* c = findWrappedContext(uptr);
+  if(auto p = c ? c->pCollector.load(std::memory_order_acquire) : nullptr)
+  {
+    auto& s = p->currentStats();
+    s.triangles++;
+    s.vertices += nverts;
+    s.pixelsCovered += clippedVertexArea(verts, nverts, scissor);
+    p->noteScissor(scissor);
+  }
+  getOriginal(c).renderTriangles(uptr, paint, op, scissor, verts, nverts, fringe);
+}
+
+// put the backend's callbacks back and make the slot free for another context.
+// The caller must hold gWrappedContextsMutex.
+void unwrap(WrappedContext* c, NVGparams* params)
+{
+  if(params)
+  {
+    params->renderCreateTexture = c->original.renderCreateTexture;
+    params->renderUpdateTexture = c->original.renderUpdateTexture;
+    params->renderFill = c->original.renderFill;
+    params->renderStroke = c->original.renderStroke;
+    params->renderTriangles = c->original.renderTriangles;
+    params->renderDelete = c->original.renderDelete;
+  }
+  if(auto p = c->pCollector.load(std::memory_order_acquire))
+  {
+    p->forgetContext();
+  }
+  c->pCollector.store(nullptr, std::memory_order_release);
+  c->userPtr.store(nullptr, std::memory_order_release);
+}
+
+// when a wrapped context is deleted, free its slot before the backend deletes
+// its state, so that a new context at the same address starts clean.
+void wrapDelete(void* uptr)
+{
+  void (*originalDelete)(void*){nullptr};
+  {
+    std::lock_guard< std::mutex > lock(gWrappedContextsMutex);
+    WrappedContext* c = findWrappedContext(uptr);
+    originalDelete = getOriginal(c).renderDelete;
+    if(c)
+    {
+      unwrap(c, nullptr);
+    }
+  }
+  if(originalDelete)
+  {
+    originalDelete(uptr);
+  }
+}
+
+} // namespace
+
+size_t RenderStatsCollector::getNumWrappedContexts()
+{
+  std::lock_guard< std::mutex > lock(gWrappedContextsMutex);
+  size_t n{0};
+  for(const auto& c : gWrappedContexts)
+  {
+    n += (c.userPtr.load(std::memory_order_acquire) != nullptr);
+  }
+  return n;
+}
+
+// RenderStatsCollector
+
+RenderStatsCollector::RenderStatsCollector()
+{
+  _currentWidgets.reserve(256);
+  _frameWidgets.reserve(256);
+}
+
+RenderStatsCollector::~RenderStatsCollector()
+{
+  detach();
+}
+
+void RenderStatsCollector::attach(NVGcontext* nvg)
+{
+  if(nvg == _nvg) return;
+  detach();
+
+  NVGparams* params = nvgInternalParams(nvg);
+  void* uptr = params->userPtr;
+
+  std::lock_guard< std::mutex > lock(gWrappedContextsMutex);
+  WrappedContext* c = findWrappedContext(uptr);
+  if(!c)
+  {
+    c = findWrappedContext(nullptr);
+    if(!c)
+    {
+      std::cout << "RenderStatsCollector: too many contexts!\n";
+      return;
+    }
+  }
+
+  if(params->renderFill != wrapFill)
+  {
+    c->original = *params;
+    if(!gHasBackend.load(std::memory_order_acquire))
+    {
+      gBackend = *params;
+      gHasBackend.store(true, std::memory_order_release);
+    }
+    c->userPtr.store(uptr, std::memory_order_release);
+    params->renderCreateTexture = wrapCreateTexture;
+    params->renderUpdateTexture = wrapUpdateTexture;
+    params->renderFill = wrapFill;
+    params->renderStroke = wrapStroke;
+    params->renderTriangles = wrapTriangles;
+    params->renderDelete = wrapDelete;
+  }
+  auto previous = c->pCollector.exchange(this, std::memory_order_acq_rel);
+  if(previous && (previous != this))
+  {
+    previous->forgetContext();
+  }
+  _nvg = nvg;
+}
+
+void RenderStatsCollector::detach()
+{
+  std::lock_guard< std::mutex > lock(gWrappedContextsMutex);
+  if(!_nvg) return;
+
+  // the context is still alive: if it was deleted, wrapDelete() has already
+  // freed its slot and cleared _nvg.
+  NVGparams* params = nvgInternalParams(_nvg);
+  if(WrappedContext* c = findWrappedContext(params->userPtr))
+  {
+    unwrap(c, params);
+  }
+  _nvg = nullptr;
+}
+
+void RenderStatsCollector::noteScissor(const NVGscissor* s)
+{
+  if(!s) return;
+  if(std::equal(s->xform, s->xform + 6, _prevScissor.xform) &&
+     std::equal(s->extent, s->extent + 2, _prevScissor.extent)) return;
+  _prevScissor = *s;
+  _current.scissorChanges++;
+}
+
+void RenderStatsCollector::addWidgetStats(const void* widget, const RenderStats& s)
+{
+  _currentWidgets.push_back({widget, s});
+}
+
+void RenderStatsCollector::endFrame()
+{
+  _frame = _current;
+  _current = RenderStats{};
+
+  // merge the stats of Widgets drawn more than once in the frame.
+  std::sort(_currentWidgets.begin(), _currentWidgets.end(),
+            [](const WidgetStats& a, const WidgetStats& b) { return a.widget < b.widget; });
+  _frameWidgets.clear();
+  for(const auto& ws : _currentWidgets)
+  {
+    if(!_frameWidgets.empty() && (_frameWidgets.back().widget == ws.widget))
+    {
+      _frameWidgets.back().stats += ws.stats;
+    }
+    else
+    {
+      _frameWidgets.push_back(ws);
+    }
+  }
+  _currentWidgets.clear();
+
+  std::sort(_frameWidgets.begin(), _frameWidgets.end(), [](const WidgetStats& a, const WidgetStats& b) {
+    if(a.stats.drawCalls() != b.stats.drawCalls()) return a.stats.drawCalls() > b.stats.drawCalls();
+    return a.stats.vertices > b.stats.vertices;
+  });
+}
+
+} // namespace ml
@@ -0,0 +1,110 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+#include "nanovg.h"
+#include "MLPath.h"
+
+namespace ml {
+
+// counts of the work done by the nanovg rendering backend.
+struct RenderStats
+{
+  size_t fills{0};
+  size_t strokes{0};
+  size_t triangles{0};
+  size_t vertices{0};
+  size_t scissorChanges{0};
+  size_t textureCreates{0};
+  size_t textureUpdates{0};
+
+  // approximate: the area of each draw call's bounds, clipped to its scissor.
+  double pixelsCovered{0};
+
+  // Widgets that the View did not draw because nearer opaque Widgets hid them.
+  size_t widgetsOccluded{0};
+
+  size_t drawCalls() const { return fills + strokes + triangles; }
+
+  RenderStats& operator+=(const RenderStats& b);
+};
+
+RenderStats operator-(const RenderStats& a, const RenderStats& b);
+std::ostream& operator<<(std::ostream& out, const RenderStats& s);
+
+// the stats for one frame, with the costliest Widgets by name, first.
+// Stats for a View include the Widgets drawn inside it.
+struct RenderStatsReport
+{
+  RenderStats frame;
+  std::vector< std::pair< Path, RenderStats > > widgets;
+};
+
+// RenderStatsCollector: counts the calls made to the render callbacks of a
+// nanovg context, by wrapping the callbacks in the context's NVGparams. The
+// backend's userPtr is left alone so the backend's own utilities still work.
+//
+// Detaching puts the backend's callbacks back. Each attached context uses one
+// of a fixed number of slots, which is freed when the collector detaches or
+// the context is deleted.
+//
+// The stats for a frame are everything counted between two calls to endFrame().
+// The View brackets each drawWidget() call with getCurrentStats() and
+// addWidgetStats() so that the costs can be attributed to Widgets.
+class RenderStatsCollector
+{
+public:
+  struct WidgetStats
+  {
+    const void* widget;
+    RenderStats stats;
+  };
+
+  RenderStatsCollector();
+  ~RenderStatsCollector();
+
+  // wrap the render callbacks of the context, if not done already, and send
+  // their counts to this collector.
+  void attach(NVGcontext* nvg);
+
+  // stop counting and unwrap the context.
+  void detach();
+
+  bool isAttached() const { return _nvg != nullptr; }
+
+  const RenderStats& getCurrentStats() const { return _current; }
+  void addWidgetStats(const void* widget, const RenderStats& s);
+
+  // finish the current frame. The widget stats are merged and sorted, most
+  // draw calls first.
+  void endFrame();
+
+  const RenderStats& getFrameStats() const { return _frame; }
+  const std::vector< WidgetStats >& getFrameWidgetStats() const { return _frameWidgets; }
+
+  // called by the wrappers, and when the context is deleted or attached to another collector.
+  RenderStats& currentStats() { return _current; }
+  void noteScissor(const NVGscissor* s);
+  void forgetContext() { _nvg = nullptr; }
+
+  // the number of contexts wrapped by all collectors.
+  static size_t getNumWrappedContexts();
+
+private:
+  NVGcontext* _nvg{nullptr};
+  RenderStats _current;
+  RenderStats _frame;
+  std::vector< WidgetStats > _currentWidgets;
+  std::vector< WidgetStats > _frameWidgets;
+  NVGscissor _prevScissor{};
+};
+
+} // namespace ml
@@ -0,0 +1,157 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+#include "MLResourceLoader.h"
+#include "MLProfiler.h"
+
+namespace ml {
+
+ResourceLoader::ResourceLoader(size_t threads) : _numThreads(std::max(threads, size_t(1)))
+{
+}
+
+ResourceLoader::~ResourceLoader()
+{
+  {
+    std::lock_guard< std::mutex > lock(_jobsMutex);
+    _quitting = true;
+  }
+  _jobsCondition.notify_all();
+  for(auto& t : _workers)
+  {
+    t.join();
+  }
+}
+
+void ResourceLoader::loadRasterImage(Path name, const unsigned char* data, size_t dataBytes)
+{
+  {
+    std::lock_guard< std::mutex > lock(_readyMutex);
+    _pendingNames.push_back(name);
+  }
+  enqueueJob([=]()
+  {
+    ML_PROFILE_SCOPE("ResourceLoader::decodeRasterImage");
+    DecodedRaster r{name, _assets->getBitmap(data, dataBytes)};
+
+    std::lock_guard< std::mutex > lock(_readyMutex);
+    _readyRasters.push_back(std::move(r));
+  });
+}
+
+void ResourceLoader::loadVectorImage(Path name, const unsigned char* data, size_t dataBytes)
+{
+  {
+    std::lock_guard< std::mutex > lock(_readyMutex);
+    _pendingNames.push_back(name);
+  }
+  enqueueJob([=]()
+  {
+    ML_PROFILE_SCOPE("ResourceLoader::parseVectorImage");
+
+    // parsing needs no draw context.
+    auto image = ml::make_unique< VectorImage >(nullptr, _assets->getSVG(data, dataBytes));
+
+    std::lock_guard< std::mutex > lock(_readyMutex);
+    _readyVectors.push_back(DecodedVector{name, std::move(image)});
+  });
+}
+
+size_t ResourceLoader::installReadyResources(NativeDrawContext* nvg, DrawingResources& resources)
+{
+  std::vector< DecodedRaster > rasters;
+  std::vector< DecodedVector > vectors;
+  {
+    std::lock_guard< std::mutex > lock(_readyMutex);
+    rasters.swap(_readyRasters);
+    vectors.swap(_readyVectors);
+    
+    // a resource that failed to decode is no longer pending either: it is missing.
+    auto removePending = [&](Path name)
+    {
+      auto it = std::find(_pendingNames.begin(), _pendingNames.end(), name);
+      if(it != _pendingNames.end()) _pendingNames.erase(it);
+    };
+    for(const auto& r : rasters) removePending(r.name);
+    for(const auto& v : vectors) removePending(v.name);
+    resources.pending = _pendingNames;
+  }
+  if(rasters.empty() && vectors.empty()) return 0;
+
+  ML_PROFILE_SCOPE("ResourceLoader::installReadyResources");
+  for(auto& r : rasters)
+  {
+    if(r.bitmap)
+    {
+      resources.rasterImages[r.name] = ml::make_unique< RasterImage >(nvg, r.bitmap);
+    }
+  }
+  for(auto& v : vectors)
+  {
+    if(v.image && *v.image)
+    {
+      v.image->nvg_ = nvg;
+      resources.vectorImages[v.name] = std::move(v.image);
+    }
+  }
+
+  // installed images may replace existing ones.
+  resources.changed();
+  return rasters.size() + vectors.size();
+}
+
+size_t ResourceLoader::getPendingCount() const
+{
+  std::lock_guard< std::mutex > lock(_readyMutex);
+  return _pendingNames.size();
+}
+
+void ResourceLoader::waitUntilDecoded()
+{
+  std::unique_lock< std::mutex > lock(_jobsMutex);
+  _idleCondition.wait(lock, [this]() { return _jobs.empty() && !_jobsRunning; });
+}
+
+void ResourceLoader::enqueueJob(std::function< void() > job)
+{
+  {
+    std::lock_guard< std::mutex > lock(_jobsMutex);
+    _jobs.push_back(std::move(job));
+  }
+  if(_workers.empty())
+  {
+    for(size_t i = 0; i < _numThreads; ++i)
+    {
+      _workers.emplace_back([this]() { runWorker(); });
+    }
+  }
+  _jobsCondition.notify_one();
+}
+
+void ResourceLoader::runWorker()
+{
+  while(true)
+  {
+    std::function< void() > job;
+    {
+      std::unique_lock< std::mutex > lock(_jobsMutex);
+      _jobsCondition.wait(lock, [this]() { return _quitting || !_jobs.empty(); });
+      if(_quitting) return;
+      job = std::move(_jobs.front());
+      _jobs.pop_front();
+      _jobsRunning++;
+    }
+
+    job();
+
+    {
+      std::lock_guard< std::mutex > lock(_jobsMutex);
+      _jobsRunning--;
+    }
+    _idleCondition.notify_all();
+  }
+}
+
+} // namespace ml
@@ -0,0 +1,100 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+// ResourceLoader: decodes images on a pool of worker threads so that the
+// GUI thread does not have to wait for them before drawing the first frame.
+//
+// JPEG and PNG decoding and SVG parsing are done by the workers. Anything that
+// needs the draw context, like making a texture from decoded pixels, is done by
+// installReadyResources() on the render thread, which the AppView calls once per
+// frame. Until then, getRasterImage() and getVectorImage() return nullptr for a
+// resource, and its name is in DrawingResources::pending, so that Widgets can
+// draw a placeholder.
+//
+// The data given to load...() must stay valid until the resource is installed.
+// Embedded resources, which are static, are always OK.
+//
+// Decoding is done through a SharedAssetCache, so an image that another AppView
+// has already decoded is not decoded again.
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "MLDrawContext.h"
+
+namespace ml {
+
+class ResourceLoader
+{
+public:
+  explicit ResourceLoader(size_t threads = 2);
+  ~ResourceLoader();
+
+  // GUI thread, before any loads. Decode through the given cache, usually one
+  // shared by all AppViews. By default each ResourceLoader has its own.
+  void setSharedAssetCache(SharedAssetCache* p) { _assets = p ? p : &_ownAssets; }
+
+  // GUI thread. Start decoding a resource, to be added to the DrawingResources
+  // under the given name when it is ready.
+  void loadRasterImage(Path name, const unsigned char* data, size_t dataBytes);
+  void loadVectorImage(Path name, const unsigned char* data, size_t dataBytes);
+
+  // render thread. Add any decoded resources to r, making textures as needed,
+  // and set r.pending to the names of those still decoding. Returns the number
+  // of resources added.
+  size_t installReadyResources(NativeDrawContext* nvg, DrawingResources& r);
+
+  // the number of resources requested and not yet installed.
+  size_t getPendingCount() const;
+
+  // wait until all requested resources are decoded and ready to install.
+  void waitUntilDecoded();
+
+private:
+  struct DecodedRaster
+  {
+    Path name;
+    SharedAssetCache::BitmapPtr bitmap;
+  };
+
+  struct DecodedVector
+  {
+    Path name;
+    std::unique_ptr< VectorImage > image;
+  };
+
+  void enqueueJob(std::function< void() > job);
+  void runWorker();
+
+  SharedAssetCache _ownAssets;
+  SharedAssetCache* _assets{&_ownAssets};
+
+  // the workers are started by the first load.
+  size_t _numThreads;
+  std::vector< std::thread > _workers;
+  bool _quitting{false};
+
+  // jobs waiting for a worker, and the number running.
+  mutable std::mutex _jobsMutex;
+  std::condition_variable _jobsCondition;
+  std::condition_variable _idleCondition;
+  std::deque< std::function< void() > > _jobs;
+  size_t _jobsRunning{0};
+
+  // decoded resources waiting to be installed.
+  mutable std::mutex _readyMutex;
+  std::vector< DecodedRaster > _readyRasters;
+  std::vector< DecodedVector > _readyVectors;
+  std::vector< Path > _pendingNames;
+};
+
+} // namespace ml
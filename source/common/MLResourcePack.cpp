@@ -0,0 +1,266 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+#include <algorithm>
+#include <cstring>
+
+#include "MLResourcePack.h"
+#include "external/miniz/miniz.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ml {
+
+namespace {
+
+constexpr char kMagic[4]{'M', 'L', 'R', 'P'};
+constexpr size_t kHeaderSize{12};
+constexpr size_t kEntryFixedSize{4 + 4 + 8 + 8 + 8};
+constexpr size_t kDataAlignment{16};
+
+// bounds-checked little-endian reads, which leave p unchanged on failure.
+struct Reader
+{
+  const uint8_t* p;
+  const uint8_t* end;
+
+  bool has(size_t n) const { return size_t(end - p) >= n; }
+
+  template< typename T >
+  bool read(T& v)
+  {
+    if(!has(sizeof(T))) return false;
+    uint64_t r{0};
+    for(size_t i = 0; i < sizeof(T); ++i)
+    {
+      r |= uint64_t(p[i]) << (8*i);
+    }
+    v = T(r);
+    p += sizeof(T);
+    return true;
+  }
+};
+
+template< typename T >
+void writeLE(std::vector< uint8_t >& out, T v)
+{
+  for(size_t i = 0; i < sizeof(T); ++i)
+  {
+    out.push_back(uint8_t(uint64_t(v) >> (8*i)));
+  }
+}
+
+size_t alignUp(size_t n) { return (n + kDataAlignment - 1) & ~(kDataAlignment - 1); }
+
+} // namespace
+
+ResourcePack::ResourcePack(const uint8_t* data, size_t size) : _data(data), _size(size)
+{
+  readIndex();
+}
+
+std::unique_ptr< ResourcePack > ResourcePack::mapFile(const std::string& path)
+{
+  std::unique_ptr< ResourcePack > pack(new ResourcePack());
+
+#if defined(_WIN32)
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, nullptr);
+  if(file == INVALID_HANDLE_VALUE) return nullptr;
+  LARGE_INTEGER size;
+  if(!GetFileSizeEx(file, &size) || !size.QuadPart)
+  {
+    CloseHandle(file);
+    return nullptr;
+  }
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if(!mapping)
+  {
+    CloseHandle(file);
+    return nullptr;
+  }
+  pack->_fileHandle = file;
+  pack->_mapping = mapping;
+  pack->_data = static_cast< const uint8_t* >(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+  pack->_size = size_t(size.QuadPart);
+#else
+  int fd = open(path.c_str(), O_RDONLY);
+  if(fd < 0) return nullptr;
+  struct stat st;
+  if((fstat(fd, &st) != 0) || !st.st_size)
+  {
+    close(fd);
+    return nullptr;
+  }
+  void* p = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(p == MAP_FAILED) return nullptr;
+  pack->_mapping = p;
+  pack->_data = static_cast< const uint8_t* >(p);
+  pack->_size = size_t(st.st_size);
+#endif
+
+  if(!pack->_data) return nullptr;
+  pack->readIndex();
+  return pack;
+}
+
+ResourcePack::~ResourcePack()
+{
+#if defined(_WIN32)
+  if(_mapping)
+  {
+    UnmapViewOfFile(_data);
+    CloseHandle(static_cast< HANDLE >(_mapping));
+    CloseHandle(static_cast< HANDLE >(_fileHandle));
+  }
+#else
+  if(_mapping)
+  {
+    munmap(_mapping, _size);
+  }
+#endif
+}
+
+void ResourcePack::readIndex()
+{
+  _valid = false;
+  _entries.clear();
+
+  Reader r{_data, _data + _size};
+  if(!_data || !r.has(kHeaderSize) || std::memcmp(_data, kMagic, 4)) return;
+  r.p += 4;
+
+  uint32_t version{0}, count{0};
+  r.read(version);
+  r.read(count);
+  if(version != kVersion) return;
+
+  _entries.reserve(std::min(size_t(count), _size/kEntryFixedSize));
+  for(uint32_t i = 0; i < count; ++i)
+  {
+    Entry e;
+    uint32_t nameLength{0};
+    if(!r.read(nameLength) || !r.has(nameLength)) return;
+    e.name.assign(reinterpret_cast< const char* >(r.p), nameLength);
+    r.p += nameLength;
+    if(!r.has(kEntryFixedSize - 4)) return;
+    r.read(e.flags);
+    r.read(e.offset);
+    r.read(e.storedSize);
+    r.read(e.originalSize);
+
+    // every entry must be inside the blob, and the index must be sorted.
+    if((e.offset > _size) || (e.storedSize > _size - e.offset)) return;
+    if(!_entries.empty() && !(_entries.back().name < e.name)) return;
+    _entries.push_back(std::move(e));
+  }
+  _valid = true;
+}
+
+ResourcePack::Data ResourcePack::find(const std::string& name) const
+{
+  auto it = std::lower_bound(_entries.begin(), _entries.end(), name,
+                             [](const Entry& e, const std::string& n) { return e.name < n; });
+  if((it == _entries.end()) || (it->name != name)) return Data{};
+
+  const uint8_t* pStored = _data + it->offset;
+  if(!(it->flags & kCompressed))
+  {
+    return Data{pStored, size_t(it->storedSize)};
+  }
+
+  std::lock_guard< std::mutex > lock(_cacheMutex);
+  auto cached = _uncompressed.find(name);
+  if(cached == _uncompressed.end())
+  {
+    std::vector< uint8_t > out(it->originalSize);
+    mz_ulong outSize = mz_ulong(out.size());
+    if(mz_uncompress(out.data(), &outSize, pStored, mz_ulong(it->storedSize)) != MZ_OK ||
+       (outSize != it->originalSize))
+    {
+      return Data{};
+    }
+    cached = _uncompressed.emplace(name, std::move(out)).first;
+  }
+  return Data{cached->second.data(), cached->second.size()};
+}
+
+std::vector< uint8_t > ResourcePack::build(const std::vector< Input >& inputs, bool compress, float minSavings)
+{
+  std::vector< const Input* > sorted;
+  for(const auto& in : inputs)
+  {
+    sorted.push_back(&in);
+  }
+  std::sort(sorted.begin(), sorted.end(), [](const Input* a, const Input* b) { return a->name < b->name; });
+
+  // the stored bytes of each entry.
+  std::vector< std::vector< uint8_t > > stored(sorted.size());
+  std::vector< uint32_t > flags(sorted.size(), 0);
+  for(size_t i = 0; i < sorted.size(); ++i)
+  {
+    const auto& data = sorted[i]->data;
+    if(compress && !data.empty())
+    {
+      mz_ulong bound = mz_compressBound(mz_ulong(data.size()));
+      std::vector< uint8_t > c(bound);
+      if(mz_compress2(c.data(), &bound, data.data(), mz_ulong(data.size()), MZ_BEST_COMPRESSION) == MZ_OK &&
+         (bound < data.size()*(1.f - minSavings)))
+      {
+        c.resize(bound);
+        stored[i] = std::move(c);
+        flags[i] = kCompressed;
+        continue;
+      }
+    }
+    stored[i] = data;
+  }
+
+  size_t indexSize{0};
+  for(const auto* in : sorted)
+  {
+    indexSize += 4 + in->name.size() + kEntryFixedSize - 4;
+  }
+
+  std::vector< uint8_t > out;
+  for(char c : kMagic)
+  {
+    out.push_back(uint8_t(c));
+  }
+  writeLE(out, kVersion);
+  writeLE(out, uint32_t(sorted.size()));
+
+  size_t offset = alignUp(kHeaderSize + indexSize);
+  for(size_t i = 0; i < sorted.size(); ++i)
+  {
+    writeLE(out, uint32_t(sorted[i]->name.size()));
+    out.insert(out.end(), sorted[i]->name.begin(), sorted[i]->name.end());
+    writeLE(out, flags[i]);
+    writeLE(out, uint64_t(offset));
+    writeLE(out, uint64_t(stored[i].size()));
+    writeLE(out, uint64_t(sorted[i]->data.size()));
+    offset = alignUp(offset + stored[i].size());
+  }
+
+  for(const auto& s : stored)
+  {
+    out.resize(alignUp(out.size()), 0);
+    out.insert(out.end(), s.begin(), s.end());
+  }
+  return out;
+}
+
+} // namespace ml
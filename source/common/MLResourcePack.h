@@ -0,0 +1,102 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+// ResourcePack: a read-only archive of named resources in one blob, made at
+// build time by the mlvg-pack tool. The blob can be compiled into the binary or
+// memory-mapped from a file. Either way nothing is copied when the pack is
+// opened: entries are found through the index and read in place, and only
+// compressed entries are ever copied, when they are first asked for.
+//
+// Format, all integers little-endian:
+//   header:  "MLRP", u32 version, u32 entry count
+//   index:   per entry, sorted by name: u32 name length, name bytes,
+//            u32 flags, u64 offset, u64 stored size, u64 original size
+//   data:    each entry's bytes, at its offset from the start of the blob,
+//            16-byte aligned. If flags has kCompressed, the bytes are zlib data.
+//
+// This file depends only on the standard library and miniz, so that the
+// packing tool can be built without anything else.
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ml {
+
+class ResourcePack
+{
+public:
+  static constexpr uint32_t kVersion{1};
+  static constexpr uint32_t kCompressed{1};
+
+  // a resource's bytes. data is nullptr if the resource was not found.
+  struct Data
+  {
+    const uint8_t* data{nullptr};
+    size_t size{0};
+    explicit operator bool() const { return data != nullptr; }
+  };
+
+  // an input to build().
+  struct Input
+  {
+    std::string name;
+    std::vector< uint8_t > data;
+  };
+
+  // use a pack in memory, such as one compiled into the binary. The memory must
+  // outlive the ResourcePack.
+  ResourcePack(const uint8_t* data, size_t size);
+
+  // open a pack file by memory-mapping it. Returns nullptr on failure.
+  static std::unique_ptr< ResourcePack > mapFile(const std::string& path);
+
+  ~ResourcePack();
+
+  bool isValid() const { return _valid; }
+  size_t getNumEntries() const { return _entries.size(); }
+  const std::string& getEntryName(size_t i) const { return _entries[i].name; }
+
+  // find a resource by name and return its bytes, uncompressing it the first time
+  // if needed. The bytes stay valid for the life of the ResourcePack.
+  Data find(const std::string& name) const;
+
+  // make a pack from the inputs. Each input is compressed only if compress is set
+  // and compressing makes it smaller by at least minSavings, a fraction of its size.
+  static std::vector< uint8_t > build(const std::vector< Input >& inputs, bool compress, float minSavings = 0.1f);
+
+private:
+  struct Entry
+  {
+    std::string name;
+    uint32_t flags{0};
+    uint64_t offset{0};
+    uint64_t storedSize{0};
+    uint64_t originalSize{0};
+  };
+
+  ResourcePack() = default;
+  void readIndex();
+
+  const uint8_t* _data{nullptr};
+  size_t _size{0};
+  bool _valid{false};
+  std::vector< Entry > _entries;
+
+  // uncompressed copies of compressed entries, made on demand.
+  mutable std::mutex _cacheMutex;
+  mutable std::map< std::string, std::vector< uint8_t > > _uncompressed;
+
+  // platform data for a memory-mapped file.
+  void* _mapping{nullptr};
+  void* _fileHandle{nullptr};
+};
+
+} // namespace ml
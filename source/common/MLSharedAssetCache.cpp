@@ -0,0 +1,155 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "MLSharedAssetCache.h"
+
+// the implementation is compiled in nanovg.c.
+#include "stb_image.h"
+
+namespace ml {
+
+SharedAssetCache::Bitmap::~Bitmap()
+{
+  stbi_image_free(pixels);
+}
+
+uint64_t SharedAssetCache::hash(const uint8_t* data, size_t bytes)
+{
+  uint64_t h{14695981039346656037ULL};
+  for(size_t i = 0; i < bytes; ++i)
+  {
+    h = (h ^ data[i])*1099511628211ULL;
+  }
+  return (h ^ bytes)*1099511628211ULL;
+}
+
+SharedAssetCache::SVGPtr SharedAssetCache::parseSVG(const uint8_t* data, size_t bytes)
+{
+  // nsvgParse clobbers the text it reads, so parse a copy. There seems to be
+  // a bug in nanosvg that can read past the end: *2 is a safety net.
+  char* pTempData = static_cast< char* >(malloc(bytes*2));
+  if(!pTempData) return nullptr;
+  std::copy_n(data, bytes, pTempData);
+  NSVGimage* pImage = nsvgParse(pTempData, "px", 96);
+  free(pTempData);
+  return pImage ? SVGPtr(pImage, nsvgDelete) : nullptr;
+}
+
+template< typename T, typename Make >
+std::shared_ptr< T > SharedAssetCache::findOrMake(std::map< uint64_t, Entry< T > >& entries, const uint8_t* data,
+                                                  size_t bytes, Make make)
+{
+  uint64_t key = hash(data, bytes);
+  {
+    std::lock_guard< std::mutex > lock(_mutex);
+    auto it = entries.find(key);
+    if((it != entries.end()) && it->second.matches(data, bytes))
+    {
+      if(auto p = it->second.asset.lock()) return p;
+    }
+  }
+
+  // decode without the lock, so that other assets can be decoded at the same time.
+  std::shared_ptr< T > made = make();
+  if(!made) return nullptr;
+
+  std::lock_guard< std::mutex > lock(_mutex);
+  _decodeCount++;
+
+  auto& entry = entries[key];
+  if(!entry.asset.expired())
+  {
+    // if someone else made the same asset meanwhile, use theirs. If a
+    // different asset has the same hash, keep it and don't share this one.
+    if(!entry.matches(data, bytes)) return made;
+    if(auto p = entry.asset.lock()) return p;
+  }
+  entry.asset = made;
+  entry.data.assign(data, data + bytes);
+
+  // forget assets no one is using.
+  for(auto it = entries.begin(); it != entries.end();)
+  {
+    it = it->second.asset.expired() ? entries.erase(it) : std::next(it);
+  }
+  return made;
+}
+
+void SharedAssetCache::keepRecentBitmap(const BitmapPtr& p)
+{
+  auto it = std::find(_recentBitmaps.begin(), _recentBitmaps.end(), p);
+  if(it != _recentBitmaps.end())
+  {
+    _recentBitmaps.splice(_recentBitmaps.begin(), _recentBitmaps, it);
+    return;
+  }
+  _recentBitmaps.push_front(p);
+  _recentBitmapBytes += p->getSizeInBytes();
+  trimRecentBitmaps();
+}
+
+void SharedAssetCache::trimRecentBitmaps()
+{
+  while(!_recentBitmaps.empty() && (_recentBitmapBytes > _bitmapBudget))
+  {
+    _recentBitmapBytes -= _recentBitmaps.back()->getSizeInBytes();
+    _recentBitmaps.pop_back();
+  }
+}
+
+SharedAssetCache::BitmapPtr SharedAssetCache::getBitmap(const uint8_t* data, size_t bytes)
+{
+  BitmapPtr p = findOrMake(_bitmaps, data, bytes, [&]() -> BitmapPtr
+  {
+    auto b = std::make_shared< Bitmap >();
+    int components{0};
+    b->pixels = stbi_load_from_memory(data, int(bytes), &b->width, &b->height, &components, 4);
+    return b->pixels ? b : nullptr;
+  });
+  if(p)
+  {
+    std::lock_guard< std::mutex > lock(_mutex);
+    keepRecentBitmap(p);
+  }
+  return p;
+}
+
+SharedAssetCache::SVGPtr SharedAssetCache::getSVG(const uint8_t* data, size_t bytes)
+{
+  return findOrMake(_svgs, data, bytes, [&]() { return parseSVG(data, bytes); });
+}
+
+void SharedAssetCache::setBitmapBudget(size_t bytes)
+{
+  std::lock_guard< std::mutex > lock(_mutex);
+  _bitmapBudget = bytes;
+  trimRecentBitmaps();
+}
+
+size_t SharedAssetCache::getDecodeCount() const
+{
+  std::lock_guard< std::mutex > lock(_mutex);
+  return _decodeCount;
+}
+
+size_t SharedAssetCache::getLiveCount() const
+{
+  std::lock_guard< std::mutex > lock(_mutex);
+  size_t n{0};
+  for(const auto& e : _bitmaps)
+  {
+    n += !e.second.asset.expired();
+  }
+  for(const auto& e : _svgs)
+  {
+    n += !e.second.asset.expired();
+  }
+  return n;
+}
+
+} // namespace ml
@@ -0,0 +1,109 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+// SharedAssetCache: decoded images and parsed SVGs, shared by every AppView in
+// the process. Assets are found by a hash of their encoded data, checked
+// against the data itself, so an asset that is in the cache is not decoded again.
+//
+// An asset stays in the cache while any resource uses it. A RasterImage uses
+// its pixels only until its texture is made, so the cache also keeps the
+// bitmaps used most recently, up to a budget in bytes. An editor opened after
+// the last one closed gets those without decoding them again. Textures and
+// font atlases belong to each nanovg context and are not shared.
+//
+// AppViews share one cache through a SharedResourcePointer. All methods are
+// thread-safe, so ResourceLoader workers can decode through the cache.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "nanosvg.h"
+
+namespace ml {
+
+class SharedAssetCache
+{
+public:
+  static constexpr size_t kDefaultBitmapBudgetInBytes{64*1024*1024};
+
+  // decoded RGBA pixels.
+  struct Bitmap
+  {
+    int width{0};
+    int height{0};
+    unsigned char* pixels{nullptr};
+
+    Bitmap() = default;
+    Bitmap(const Bitmap&) = delete;
+    Bitmap& operator=(const Bitmap&) = delete;
+    ~Bitmap();
+
+    size_t getSizeInBytes() const { return size_t(width)*height*4; }
+  };
+
+  using BitmapPtr = std::shared_ptr< const Bitmap >;
+  using SVGPtr = std::shared_ptr< NSVGimage >;
+
+  // get the decoded pixels of a JPEG or PNG image in memory, decoding it only if
+  // no one is using it already. Returns nullptr if the data can't be decoded.
+  BitmapPtr getBitmap(const uint8_t* data, size_t bytes);
+
+  // get a parsed SVG image, parsing it only if no one is using it already.
+  // Returns nullptr if the data can't be parsed. The image must not be changed.
+  SVGPtr getSVG(const uint8_t* data, size_t bytes);
+
+  // the number of assets decoded or parsed so far, and the number alive now.
+  size_t getDecodeCount() const;
+  size_t getLiveCount() const;
+
+  // set the most bytes of bitmaps kept when no one is using them.
+  void setBitmapBudget(size_t bytes);
+
+  // parse an SVG image without the cache.
+  static SVGPtr parseSVG(const uint8_t* data, size_t bytes);
+
+  // a 64-bit FNV-1a hash of the data, combined with its size.
+  static uint64_t hash(const uint8_t* data, size_t bytes);
+
+private:
+  // an asset and the encoded data it was made from.
+  template< typename T >
+  struct Entry
+  {
+    std::weak_ptr< T > asset;
+    std::vector< uint8_t > data;
+
+    bool matches(const uint8_t* p, size_t bytes) const
+    {
+      return (data.size() == bytes) && std::equal(data.begin(), data.end(), p);
+    }
+  };
+
+  template< typename T, typename Make >
+  std::shared_ptr< T > findOrMake(std::map< uint64_t, Entry< T > >& entries, const uint8_t* data, size_t bytes,
+                                  Make make);
+
+  // keep a bitmap as the most recently used, and trim the rest to the budget.
+  // call with the lock held.
+  void keepRecentBitmap(const BitmapPtr& p);
+  void trimRecentBitmaps();
+
+  mutable std::mutex _mutex;
+  std::map< uint64_t, Entry< const Bitmap > > _bitmaps;
+  std::map< uint64_t, Entry< NSVGimage > > _svgs;
+  std::list< BitmapPtr > _recentBitmaps;
+  size_t _recentBitmapBytes{0};
+  size_t _bitmapBudget{kDefaultBitmapBudgetInBytes};
+  size_t _decodeCount{0};
+};
+
+} // namespace ml
@@ -0,0 +1,248 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+// SignalRing: a single-producer, single-consumer ring for a published signal.
+// The audio thread writes decimated blocks (one DSPVectorArray each) and the GUI
+// side copies them out. Each block has a sequence number, so a reader that
+// falls behind can tell how many blocks it missed. Writing never blocks and never
+// allocates, and reading copies each block once.
+//
+// Each slot of the ring is a seqlock: its sequence is odd while the producer is
+// writing it and even when it is complete. A reader copies a block and then checks
+// that the slot's sequence was the same, even value before and after, so a block
+// the producer wrote over during the copy is never returned.
+//
+// A SignalRing is made by the processor and handed to the GUI side once, by
+// a SignalRingTransport. After that, no messages are needed to move data.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "MLDSPOps.h"
+#include "MLSymbol.h"
+#include "MLTree.h"
+
+namespace ml {
+
+class SignalRing
+{
+public:
+  struct ReadResult
+  {
+    size_t blocksRead{0};
+    size_t blocksDropped{0};
+  };
+
+  // capacity is rounded up to a power of two blocks.
+  SignalRing(size_t channels, size_t capacityInBlocks) : _channels(channels)
+  {
+    size_t size{1};
+    while(size < capacityInBlocks) size <<= 1;
+    _mask = size - 1;
+    _blockSize = kFloatsPerDSPVector*channels;
+    _data.resize(size*_blockSize);
+    _slotSeqs.reset(new std::atomic< uint64_t >[size]);
+    for(size_t i = 0; i < size; ++i)
+    {
+      _slotSeqs[i].store(0, std::memory_order_relaxed);
+    }
+  }
+  ~SignalRing() = default;
+
+  size_t getNumChannels() const { return _channels; }
+  size_t getBlockSizeInFloats() const { return _blockSize; }
+  size_t getCapacityInBlocks() const { return _mask + 1; }
+
+  // producer. Write one block, overwriting the oldest if the ring is full.
+  template< size_t CHANNELS >
+  void write(const DSPVectorArray< CHANNELS >& v)
+  {
+    static_assert(CHANNELS > 0, "SignalRing: no channels");
+    if(CHANNELS != _channels) return;
+    write(v.getConstBuffer());
+  }
+
+  void write(const float* pBlock)
+  {
+    uint64_t seq = _writeSeq.load(std::memory_order_relaxed);
+    std::atomic< uint64_t >& slotSeq = _slotSeqs[seq & _mask];
+
+    // mark the slot as being written. The fence keeps the writes of the
+    // block from moving before the odd sequence.
+    slotSeq.store(seq*2 + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(_data.data() + (seq & _mask)*_blockSize, pBlock, _blockSize*sizeof(float));
+    slotSeq.store(seq*2 + 2, std::memory_order_release);
+
+    _writeSeq.store(seq + 1, std::memory_order_release);
+  }
+
+  // the sequence number of the next block to be written.
+  uint64_t getWriteSequence() const { return _writeSeq.load(std::memory_order_acquire); }
+
+  // consumer. Copy up to maxBlocks blocks from readSeq up to the newest into pDest,
+  // which must have room for maxBlocks*getBlockSizeInFloats() floats. readSeq is
+  // advanced past the blocks read. If the reader has fallen behind, the blocks it
+  // missed are skipped and counted. If the producer wrote over a block while it was
+  // being copied, the read stops there and the rest are counted as dropped on the
+  // next call. Only the first blocksRead blocks of pDest are valid.
+  ReadResult read(uint64_t& readSeq, float* pDest, size_t maxBlocks) const
+  {
+    ReadResult r;
+    uint64_t writeSeq = getWriteSequence();
+    skipOverrun(readSeq, writeSeq, r);
+
+    size_t n = std::min(size_t(writeSeq - readSeq), maxBlocks);
+    for(size_t i = 0; i < n; ++i)
+    {
+      if(!copyBlock(readSeq, pDest + i*_blockSize)) break;
+      readSeq++;
+      r.blocksRead++;
+    }
+    return r;
+  }
+
+private:
+  // copy the block at seq if it is still in the ring, returning false if it
+  // was written over before or during the copy.
+  bool copyBlock(uint64_t seq, float* pDest) const
+  {
+    const std::atomic< uint64_t >& slotSeq = _slotSeqs[seq & _mask];
+    uint64_t before = slotSeq.load(std::memory_order_acquire);
+    if(before != seq*2 + 2) return false;
+
+    std::memcpy(pDest, _data.data() + (seq & _mask)*_blockSize, _blockSize*sizeof(float));
+
+    // the fence keeps the reads of the block from moving after the second load.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slotSeq.load(std::memory_order_relaxed) == before;
+  }
+
+  void skipOverrun(uint64_t& readSeq, uint64_t writeSeq, ReadResult& r) const
+  {
+    // keep one block of slack for the block the producer may be writing now.
+    uint64_t capacity = getCapacityInBlocks();
+    if(writeSeq > readSeq + capacity - 1)
+    {
+      uint64_t newReadSeq = writeSeq - (capacity - 1);
+      r.blocksDropped = newReadSeq - readSeq;
+      readSeq = newReadSeq;
+    }
+  }
+
+  size_t _channels;
+  size_t _blockSize;
+  uint64_t _mask;
+  std::vector< float > _data;
+  std::unique_ptr< std::atomic< uint64_t >[] > _slotSeqs;
+  alignas(64) std::atomic< uint64_t > _writeSeq{0};
+};
+
+// SignalRingTransport: hands a processor's SignalRings to the GUI side.
+// A plugin format implements this on top of its own message channel.
+class SignalRingTransport
+{
+public:
+  virtual ~SignalRingTransport() = default;
+  virtual void publishRing(Symbol signalName, std::shared_ptr< SignalRing > ring) = 0;
+};
+
+// LocalSignalRingTransport: a stand-in transport for when the processor and the
+// GUI share an address space and a transport object, as in tests and standalone apps.
+class LocalSignalRingTransport : public SignalRingTransport
+{
+public:
+  void publishRing(Symbol signalName, std::shared_ptr< SignalRing > ring) override
+  {
+    _rings[Path(signalName)] = ring;
+  }
+
+  std::shared_ptr< SignalRing > getRing(Symbol signalName) const
+  {
+    return _rings[Path(signalName)];
+  }
+
+private:
+  Tree< std::shared_ptr< SignalRing > > _rings;
+};
+
+// SignalRingHandle: lets a transport that can only send plain data, like a
+// plugin's message channel, send a SignalRing by number. The handle keeps the
+// ring in a registry for the process until the handle is destroyed, and the
+// receiver finds the ring by the handle's id. If a message with the id is never
+// delivered, nothing leaks, and a receiver in another process finds nothing.
+class SignalRingHandle
+{
+public:
+  SignalRingHandle() = default;
+  explicit SignalRingHandle(std::shared_ptr< SignalRing > ring)
+  {
+    std::lock_guard< std::mutex > lock(getMutex());
+    _id = ++getNextID();
+    getRings()[_id] = ring;
+  }
+  ~SignalRingHandle() { reset(); }
+
+  SignalRingHandle(SignalRingHandle&& other) noexcept : _id(other._id) { other._id = 0; }
+  SignalRingHandle& operator=(SignalRingHandle&& other) noexcept
+  {
+    if(this != &other)
+    {
+      reset();
+      _id = other._id;
+      other._id = 0;
+    }
+    return *this;
+  }
+  SignalRingHandle(const SignalRingHandle&) = delete;
+  SignalRingHandle& operator=(const SignalRingHandle&) = delete;
+
+  // the id to send, never 0 for a handle made with a ring.
+  uint64_t getID() const { return _id; }
+
+  void reset()
+  {
+    if(!_id) return;
+    std::lock_guard< std::mutex > lock(getMutex());
+    getRings().erase(_id);
+    _id = 0;
+  }
+
+  // get the ring for an id, or nullptr if its handle is gone or was made in another process.
+  static std::shared_ptr< SignalRing > find(uint64_t id)
+  {
+    std::lock_guard< std::mutex > lock(getMutex());
+    auto it = getRings().find(id);
+    return (it != getRings().end()) ? it->second : nullptr;
+  }
+
+private:
+  static std::mutex& getMutex()
+  {
+    static std::mutex m;
+    return m;
+  }
+  static std::map< uint64_t, std::shared_ptr< SignalRing > >& getRings()
+  {
+    static std::map< uint64_t, std::shared_ptr< SignalRing > > rings;
+    return rings;
+  }
+  static uint64_t& getNextID()
+  {
+    static uint64_t nextID{0};
+    return nextID;
+  }
+
+  uint64_t _id{0};
+};
+
+} // namespace ml
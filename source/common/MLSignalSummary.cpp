@@ -0,0 +1,275 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "MLSignalSummary.h"
+
+namespace ml {
+
+namespace {
+
+size_t log2Int(size_t x)
+{
+  size_t r{0};
+  while((size_t(1) << (r + 1)) <= x) r++;
+  return r;
+}
+
+// level of the bins that are one DSPVector long.
+const size_t kBlockLevel = log2Int(kFloatsPerDSPVector);
+
+} // namespace
+
+SignalSummary::SignalSummary(size_t channels, size_t historyInSamples)
+{
+  size_t minHistory = std::max(size_t(512), size_t(kFloatsPerDSPVector*8));
+  _historySize = minHistory;
+  while(_historySize < historyInSamples) _historySize <<= 1;
+
+  // the top level has 8 bins.
+  _numLevels = log2Int(_historySize) - 2;
+
+  _channels.resize(channels);
+  for(auto& c : _channels)
+  {
+    c.raw.resize(_historySize);
+    c.levels.resize(_numLevels);
+    for(size_t k = 1; k < _numLevels; ++k)
+    {
+      size_t bins = _historySize >> k;
+      c.levels[k].mins.resize(bins);
+      c.levels[k].maxs.resize(bins);
+      c.levels[k].sumSqs.resize(bins);
+    }
+  }
+  clear();
+}
+
+void SignalSummary::clear()
+{
+  for(auto& c : _channels)
+  {
+    std::fill(c.raw.begin(), c.raw.end(), 0.f);
+    std::fill(c.staging, c.staging + kFloatsPerDSPVector, 0.f);
+    for(auto& l : c.levels)
+    {
+      std::fill(l.mins.begin(), l.mins.end(), 0.f);
+      std::fill(l.maxs.begin(), l.maxs.end(), 0.f);
+      std::fill(l.sumSqs.begin(), l.sumSqs.end(), 0.f);
+    }
+  }
+  _stagingFrames = 0;
+  _samplesProcessed = 0;
+}
+
+void SignalSummary::write(const float* pSamples, size_t frames)
+{
+  size_t i{0};
+  while(i < frames)
+  {
+    size_t n = std::min(frames - i, kFloatsPerDSPVector - _stagingFrames);
+    for(size_t c = 0; c < _channels.size(); ++c)
+    {
+      std::memcpy(_channels[c].staging + _stagingFrames, pSamples + c*frames + i, n*sizeof(float));
+    }
+    _stagingFrames += n;
+    i += n;
+
+    if(_stagingFrames == kFloatsPerDSPVector)
+    {
+      for(auto& c : _channels)
+      {
+        processBlock(c, c.staging);
+      }
+      _samplesProcessed += kFloatsPerDSPVector;
+      _stagingFrames = 0;
+    }
+  }
+}
+
+void SignalSummary::combineBins(const Level& src, size_t srcIdxA, size_t srcIdxB, Level& dest, size_t destIdx)
+{
+  size_t srcMask = src.mins.size() - 1;
+  size_t destMask = dest.mins.size() - 1;
+  size_t a = srcIdxA & srcMask;
+  size_t b = srcIdxB & srcMask;
+  size_t d = destIdx & destMask;
+  dest.mins[d] = std::min(src.mins[a], src.mins[b]);
+  dest.maxs[d] = std::max(src.maxs[a], src.maxs[b]);
+  dest.sumSqs[d] = src.sumSqs[a] + src.sumSqs[b];
+}
+
+void SignalSummary::processBlock(Channel& c, const float* pBlock)
+{
+  const uint64_t p = _samplesProcessed;
+
+  // level 0: raw samples
+  std::memcpy(c.raw.data() + (p & (_historySize - 1)), pBlock, kFloatsPerDSPVector*sizeof(float));
+
+  // level 1: pairs of samples
+  {
+    Level& l1 = c.levels[1];
+    size_t mask = l1.mins.size() - 1;
+    uint64_t firstBin = p >> 1;
+    for(size_t i = 0; i < kFloatsPerDSPVector/2; ++i)
+    {
+      float x0 = pBlock[i*2];
+      float x1 = pBlock[i*2 + 1];
+      size_t d = (firstBin + i) & mask;
+      l1.mins[d] = std::min(x0, x1);
+      l1.maxs[d] = std::max(x0, x1);
+      l1.sumSqs[d] = x0*x0 + x1*x1;
+    }
+  }
+
+  // levels 2 through kBlockLevel - 1: pairs of bins from the level below
+  for(size_t k = 2; k < kBlockLevel; ++k)
+  {
+    uint64_t firstBin = p >> k;
+    for(size_t i = 0; i < (kFloatsPerDSPVector >> k); ++i)
+    {
+      uint64_t j = firstBin + i;
+      combineBins(c.levels[k - 1], j*2, j*2 + 1, c.levels[k], j);
+    }
+  }
+
+  // level kBlockLevel: one bin for the whole DSPVector, reduced with SIMD.
+  {
+    SIMDVectorFloat vMin = vecLoad(pBlock);
+    SIMDVectorFloat vMax = vMin;
+    SIMDVectorFloat vSumSq = vecMul(vMin, vMin);
+    for(size_t i = kFloatsPerSIMDVector; i < kFloatsPerDSPVector; i += kFloatsPerSIMDVector)
+    {
+      SIMDVectorFloat v = vecLoad(pBlock + i);
+      vMin = vecMin(vMin, v);
+      vMax = vecMax(vMax, v);
+      vSumSq = vecAdd(vSumSq, vecMul(v, v));
+    }
+
+    alignas(16) float mins[kFloatsPerSIMDVector];
+    alignas(16) float maxs[kFloatsPerSIMDVector];
+    alignas(16) float sumSqs[kFloatsPerSIMDVector];
+    vecStore(mins, vMin);
+    vecStore(maxs, vMax);
+    vecStore(sumSqs, vSumSq);
+
+    float mn = mins[0], mx = maxs[0], ss = sumSqs[0];
+    for(size_t i = 1; i < kFloatsPerSIMDVector; ++i)
+    {
+      mn = std::min(mn, mins[i]);
+      mx = std::max(mx, maxs[i]);
+      ss += sumSqs[i];
+    }
+
+    Level& lb = c.levels[kBlockLevel];
+    size_t d = (p >> kBlockLevel) & (lb.mins.size() - 1);
+    lb.mins[d] = mn;
+    lb.maxs[d] = mx;
+    lb.sumSqs[d] = ss;
+  }
+
+  // higher levels: when a pair of bins is complete, combine it into the next level.
+  uint64_t j = p >> kBlockLevel;
+  for(size_t k = kBlockLevel + 1; k < _numLevels; ++k)
+  {
+    if(!(j & 1)) break;
+    combineBins(c.levels[k - 1], j - 1, j, c.levels[k], j >> 1);
+    j >>= 1;
+  }
+}
+
+void SignalSummary::accumulate(const Channel& c, size_t k, uint64_t firstBin, uint64_t lastBin,
+                               float& mn, float& mx, float& sumSq) const
+{
+  if(k == 0)
+  {
+    size_t mask = _historySize - 1;
+    for(uint64_t j = firstBin; j <= lastBin; ++j)
+    {
+      float x = c.raw[j & mask];
+      mn = std::min(mn, x);
+      mx = std::max(mx, x);
+      sumSq += x*x;
+    }
+  }
+  else
+  {
+    const Level& l = c.levels[k];
+    size_t mask = l.mins.size() - 1;
+    for(uint64_t j = firstBin; j <= lastBin; ++j)
+    {
+      size_t idx = j & mask;
+      mn = std::min(mn, l.mins[idx]);
+      mx = std::max(mx, l.maxs[idx]);
+      sumSq += l.sumSqs[idx];
+    }
+  }
+}
+
+size_t SignalSummary::getColumns(size_t channel, double startSample, double lengthInSamples,
+                                 size_t nColumns, Column* pDest) const
+{
+  if(channel >= _channels.size() || !nColumns) return 0;
+  const Channel& c = _channels[channel];
+
+  // choose the coarsest level with bins no longer than a column.
+  double samplesPerColumn = lengthInSamples/nColumns;
+  size_t k{0};
+  while((k + 1 < _numLevels) && (double(uint64_t(1) << (k + 1)) <= samplesPerColumn)) k++;
+
+  // valid samples are in [lo, hi).
+  const uint64_t hi = _samplesProcessed;
+  const uint64_t lo = (hi > _historySize) ? hi - _historySize : 0;
+
+  // above the block level, the newest bin may not be complete yet. Samples after the
+  // last complete bin are read from the block level.
+  const uint64_t completeEnd = (hi >> k) << k;
+
+  size_t validColumns{0};
+  for(size_t i = 0; i < nColumns; ++i)
+  {
+    Column& col = pDest[i];
+    double a = startSample + i*samplesPerColumn;
+    double b = a + samplesPerColumn;
+    int64_t ia = std::max(int64_t(std::floor(a)), int64_t(lo));
+    int64_t ib = std::min(int64_t(std::ceil(b)), int64_t(hi));
+    if(ib <= ia)
+    {
+      col = Column{};
+      continue;
+    }
+
+    float mn = std::numeric_limits< float >::max();
+    float mx = std::numeric_limits< float >::lowest();
+    float sumSq{0.f};
+    uint64_t ua = ia, ub = ib;
+
+    if(ub > completeEnd)
+    {
+      size_t kTail = std::min(k, kBlockLevel);
+      uint64_t ta = std::max(ua, completeEnd);
+      accumulate(c, kTail, ta >> kTail, (ub - 1) >> kTail, mn, mx, sumSq);
+      ub = std::max(ua, completeEnd);
+    }
+    if(ub > ua)
+    {
+      accumulate(c, k, ua >> k, (ub - 1) >> k, mn, mx, sumSq);
+    }
+
+    // the bins may cover a little more than the column. This only affects the RMS slightly.
+    col.min = mn;
+    col.max = mx;
+    col.rms = std::sqrt(sumSq/float(ib - ia));
+    col.valid = true;
+    validColumns++;
+  }
+  return validColumns;
+}
+
+} // namespace ml
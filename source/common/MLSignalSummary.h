@@ -0,0 +1,98 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+// SignalSummary: a multi-resolution summary of the recent history of a signal,
+// for scopes and waveform displays. For each channel, the raw samples and the
+// min, max and sum of squares over bins of 2, 4, 8 ... samples are kept in rings.
+// The summary is updated incrementally as samples arrive, one DSPVector at a time.
+//
+// A display asks for N columns over a range of samples and gets N min / max / RMS
+// values, reading only a few bins per column from the level that fits. So the
+// drawing cost follows the width of the display, not the number of samples.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "MLDSPOps.h"
+
+namespace ml {
+
+class SignalSummary
+{
+public:
+  struct Column
+  {
+    float min{0.f};
+    float max{0.f};
+    float rms{0.f};
+
+    // false if the column has no data in the summary's history.
+    bool valid{false};
+  };
+
+  // history is rounded up to a power of two samples, at least 512.
+  SignalSummary(size_t channels, size_t historyInSamples);
+  ~SignalSummary() = default;
+
+  size_t getNumChannels() const { return _channels.size(); }
+  size_t getHistoryInSamples() const { return _historySize; }
+  size_t getNumLevels() const { return _numLevels; }
+
+  // write frames of samples in channel-major order: all of channel 0, then all of
+  // channel 1 and so on. Samples are summarized when a whole DSPVector has arrived.
+  void write(const float* pSamples, size_t frames);
+
+  // the index of the next sample to be summarized. Sample indices count from the
+  // first sample written.
+  uint64_t getEndSample() const { return _samplesProcessed; }
+
+  // get columns over the sample range [startSample, startSample + lengthInSamples)
+  // for one channel. Returns the number of valid columns.
+  size_t getColumns(size_t channel, double startSample, double lengthInSamples,
+                    size_t nColumns, Column* pDest) const;
+
+  // get columns over the most recent samples.
+  size_t getRecentColumns(size_t channel, double lengthInSamples, size_t nColumns, Column* pDest) const
+  {
+    return getColumns(channel, double(_samplesProcessed) - lengthInSamples, lengthInSamples, nColumns, pDest);
+  }
+
+  void clear();
+
+private:
+  // the bins for one level of one channel, stored as a struct of arrays.
+  struct Level
+  {
+    std::vector< float > mins;
+    std::vector< float > maxs;
+    std::vector< float > sumSqs;
+  };
+
+  struct Channel
+  {
+    alignas(16) float staging[kFloatsPerDSPVector];
+    std::vector< float > raw;
+
+    // levels[k] has bins of 2^k samples. levels[0] is unused: raw samples are level 0.
+    std::vector< Level > levels;
+  };
+
+  void processBlock(Channel& c, const float* pBlock);
+  void combineBins(const Level& src, size_t srcIdxA, size_t srcIdxB, Level& dest, size_t destIdx);
+
+  // accumulate the bins of level k in [firstBin, lastBin].
+  void accumulate(const Channel& c, size_t k, uint64_t firstBin, uint64_t lastBin,
+                  float& mn, float& mx, float& sumSq) const;
+
+  std::vector< Channel > _channels;
+  size_t _historySize{0};
+  size_t _numLevels{0};
+  size_t _stagingFrames{0};
+  uint64_t _samplesProcessed{0};
+};
+
+} // namespace ml
@@ -0,0 +1,259 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#include "MLSpectrumAnalyzer.h"
+
+namespace ml {
+
+namespace {
+
+// round up to a power of two, at least two DSPVectors.
+size_t validFFTSize(size_t size)
+{
+  size_t r = kFloatsPerDSPVector*2;
+  while(r < size) r <<= 1;
+  return r;
+}
+
+// the number of input blocks copied from the ring at a time.
+constexpr size_t kMaxBlocksPerRead{16};
+
+} // namespace
+
+// ----------------------------------------------------------------
+// FFT
+
+FFT::FFT(size_t size) : _size(validFFTSize(size))
+{
+  size_t bits{0};
+  while((size_t(1) << bits) < _size) bits++;
+
+  _bitReverse.resize(_size);
+  for(size_t i = 0; i < _size; ++i)
+  {
+    uint32_t r{0};
+    for(size_t b = 0; b < bits; ++b)
+    {
+      r |= ((i >> b) & 1) << (bits - 1 - b);
+    }
+    _bitReverse[i] = r;
+  }
+
+  // twiddle k of the stage with span h is exp(-i*pi*k/h).
+  _twiddleRe.resize(_size);
+  _twiddleIm.resize(_size);
+  for(size_t h = 1; h < _size; h <<= 1)
+  {
+    for(size_t k = 0; k < h; ++k)
+    {
+      double theta = kPi*double(k)/double(h);
+      _twiddleRe[h + k] = float(std::cos(theta));
+      _twiddleIm[h + k] = float(-std::sin(theta));
+    }
+  }
+}
+
+void FFT::forward(float* re, float* im) const
+{
+  for(size_t i = 0; i < _size; ++i)
+  {
+    size_t j = _bitReverse[i];
+    if(i < j)
+    {
+      std::swap(re[i], re[j]);
+      std::swap(im[i], im[j]);
+    }
+  }
+
+  // stages with spans shorter than a SIMD vector.
+  size_t h = 1;
+  for(; h < kFloatsPerSIMDVector; h <<= 1)
+  {
+    const float* wr = _twiddleRe.data() + h;
+    const float* wi = _twiddleIm.data() + h;
+    for(size_t start = 0; start < _size; start += 2*h)
+    {
+      float* ar = re + start;
+      float* ai = im + start;
+      float* br = ar + h;
+      float* bi = ai + h;
+      for(size_t k = 0; k < h; ++k)
+      {
+        float tr = br[k]*wr[k] - bi[k]*wi[k];
+        float ti = br[k]*wi[k] + bi[k]*wr[k];
+        br[k] = ar[k] - tr;
+        bi[k] = ai[k] - ti;
+        ar[k] += tr;
+        ai[k] += ti;
+      }
+    }
+  }
+
+  // the remaining stages, one SIMD vector of butterflies at a time.
+  for(; h < _size; h <<= 1)
+  {
+    const float* wr = _twiddleRe.data() + h;
+    const float* wi = _twiddleIm.data() + h;
+    for(size_t start = 0; start < _size; start += 2*h)
+    {
+      float* ar = re + start;
+      float* ai = im + start;
+      float* br = ar + h;
+      float* bi = ai + h;
+      for(size_t k = 0; k < h; k += kFloatsPerSIMDVector)
+      {
+        SIMDVectorFloat vwr = vecLoadUnaligned(wr + k);
+        SIMDVectorFloat vwi = vecLoadUnaligned(wi + k);
+        SIMDVectorFloat vbr = vecLoadUnaligned(br + k);
+        SIMDVectorFloat vbi = vecLoadUnaligned(bi + k);
+        SIMDVectorFloat var = vecLoadUnaligned(ar + k);
+        SIMDVectorFloat vai = vecLoadUnaligned(ai + k);
+        SIMDVectorFloat tr = vecSub(vecMul(vbr, vwr), vecMul(vbi, vwi));
+        SIMDVectorFloat ti = vecAdd(vecMul(vbr, vwi), vecMul(vbi, vwr));
+        vecStoreUnaligned(br + k, vecSub(var, tr));
+        vecStoreUnaligned(bi + k, vecSub(vai, ti));
+        vecStoreUnaligned(ar + k, vecAdd(var, tr));
+        vecStoreUnaligned(ai + k, vecAdd(vai, ti));
+      }
+    }
+  }
+}
+
+// ----------------------------------------------------------------
+// SpectrumAnalyzer
+
+SpectrumAnalyzer::SpectrumAnalyzer(std::shared_ptr< SignalRing > input, size_t fftSize, size_t hop,
+                                   size_t outputCapacityInFrames) :
+  _input(input),
+  _fft(fftSize)
+{
+  size_t n = _fft.size();
+  _hop = std::max(size_t(1), (hop + kFloatsPerDSPVector - 1)/kFloatsPerDSPVector)*kFloatsPerDSPVector;
+  _output = std::make_shared< SignalRing >(getNumBins()/kFloatsPerDSPVector, outputCapacityInFrames);
+
+  _history.resize(n);
+  _re.resize(n);
+  _im.resize(n);
+  _magnitudes.resize(getNumBins());
+  _inputBlocks.resize(kMaxBlocksPerRead*_input->getBlockSizeInFloats());
+
+  // Hann window, with the magnitudes scaled so that a full-scale sine
+  // centered on a bin has a magnitude of 1.
+  _window.resize(n);
+  float windowSum{0.f};
+  for(size_t i = 0; i < n; ++i)
+  {
+    _window[i] = 0.5f - 0.5f*std::cos(kTwoPi*float(i)/float(n));
+    windowSum += _window[i];
+  }
+  _magnitudeScale = 2.f/windowSum;
+}
+
+size_t SpectrumAnalyzer::process()
+{
+  size_t frames{0};
+  const size_t n = _fft.size();
+  const size_t blockSize = _input->getBlockSizeInFloats();
+
+  while(true)
+  {
+    auto r = _input->read(_readSeq, _inputBlocks.data(), kMaxBlocksPerRead);
+
+    // after a gap the history is no longer continuous, so start again.
+    if(r.blocksDropped)
+    {
+      _inputBlocksDropped += r.blocksDropped;
+      _historyFilled = 0;
+      _samplesSinceFrame = 0;
+    }
+
+    for(size_t b = 0; b < r.blocksRead; ++b)
+    {
+      // channel 0 is the first DSPVector of each block.
+      const float* pSamples = _inputBlocks.data() + b*blockSize;
+      std::memmove(_history.data(), _history.data() + kFloatsPerDSPVector,
+                   (n - kFloatsPerDSPVector)*sizeof(float));
+      std::memcpy(_history.data() + n - kFloatsPerDSPVector, pSamples, kFloatsPerDSPVector*sizeof(float));
+      _historyFilled = std::min(n, _historyFilled + kFloatsPerDSPVector);
+      _samplesSinceFrame += kFloatsPerDSPVector;
+
+      if((_historyFilled == n) && (_samplesSinceFrame >= _hop))
+      {
+        analyzeFrame();
+        _samplesSinceFrame = 0;
+        frames++;
+      }
+    }
+
+    if(r.blocksRead < kMaxBlocksPerRead) break;
+  }
+  return frames;
+}
+
+void SpectrumAnalyzer::analyzeFrame()
+{
+  const size_t n = _fft.size();
+  for(size_t i = 0; i < n; ++i)
+  {
+    _re[i] = _history[i]*_window[i];
+  }
+  std::fill(_im.begin(), _im.end(), 0.f);
+  _fft.forward(_re.data(), _im.data());
+
+  for(size_t k = 0; k < getNumBins(); ++k)
+  {
+    _magnitudes[k] = std::sqrt(_re[k]*_re[k] + _im[k]*_im[k])*_magnitudeScale;
+  }
+
+  // if nobody is reading, this overwrites the oldest frame.
+  _output->write(_magnitudes.data());
+}
+
+// ----------------------------------------------------------------
+// AnalysisWorker
+
+void AnalysisWorker::add(std::shared_ptr< SpectrumAnalyzer > analyzer)
+{
+  std::lock_guard< std::mutex > lock(_analyzersMutex);
+  _analyzers.push_back(analyzer);
+}
+
+void AnalysisWorker::start(int periodInMs)
+{
+  if(_thread.joinable()) return;
+  _running = true;
+  _thread = std::thread(&AnalysisWorker::run, this, std::max(periodInMs, 1));
+}
+
+void AnalysisWorker::stop()
+{
+  _running = false;
+  if(_thread.joinable())
+  {
+    _thread.join();
+  }
+}
+
+void AnalysisWorker::run(int periodInMs)
+{
+  while(_running)
+  {
+    {
+      std::lock_guard< std::mutex > lock(_analyzersMutex);
+      for(auto& analyzer : _analyzers)
+      {
+        analyzer->process();
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(periodInMs));
+  }
+}
+
+} // namespace ml
@@ -0,0 +1,124 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+// Spectrum analysis for published signals, done off the audio thread.
+//
+// The processor writes raw frames to a SignalRing as for any published signal.
+// A SpectrumAnalyzer, run by an AnalysisWorker thread, reads the ring, windows
+// the frames and runs an FFT every hop samples, writing one frame of magnitudes
+// to its own output SignalRing. The output ring is published to the GUI side in
+// place of the raw one.
+//
+// Nothing waits on anything: if the worker falls behind, input blocks are dropped
+// and counted, and if nobody reads the output, its oldest frames are overwritten.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "MLSignalRing.h"
+
+namespace ml {
+
+// FFT: a radix-2 complex FFT on split real and imaginary arrays. Butterflies
+// that span at least one SIMD vector are done with SIMD operations.
+class FFT
+{
+public:
+  // size must be a power of two, at least 2*kFloatsPerSIMDVector.
+  explicit FFT(size_t size);
+  ~FFT() = default;
+
+  size_t size() const { return _size; }
+
+  // in-place forward transform of size() values.
+  void forward(float* re, float* im) const;
+
+private:
+  size_t _size;
+  std::vector< uint32_t > _bitReverse;
+
+  // twiddles for each stage, stored contiguously: the stage with span h
+  // has its h twiddles starting at offset h.
+  std::vector< float > _twiddleRe;
+  std::vector< float > _twiddleIm;
+};
+
+class SpectrumAnalyzer
+{
+public:
+  // The output has one block per frame. A block of a SignalRing is kFloatsPerDSPVector
+  // floats per channel, so the output ring has fftSize/2/kFloatsPerDSPVector channels,
+  // and fftSize must be a power of two, at least 2*kFloatsPerDSPVector. The hop is
+  // rounded up to a whole number of DSPVectors. Channel 0 of the input is analyzed.
+  SpectrumAnalyzer(std::shared_ptr< SignalRing > input, size_t fftSize, size_t hop,
+                   size_t outputCapacityInFrames = 16);
+  ~SpectrumAnalyzer() = default;
+
+  std::shared_ptr< SignalRing > getOutput() const { return _output; }
+  size_t getFFTSize() const { return _fft.size(); }
+  size_t getNumBins() const { return _fft.size()/2; }
+  size_t getHop() const { return _hop; }
+
+  // analyze any new input, writing one frame per hop to the output. Returns the
+  // number of frames written. Called by the worker thread only.
+  size_t process();
+
+  // the number of input blocks the analyzer missed because it fell behind.
+  size_t getInputBlocksDropped() const { return _inputBlocksDropped; }
+
+private:
+  void analyzeFrame();
+
+  std::shared_ptr< SignalRing > _input;
+  std::shared_ptr< SignalRing > _output;
+  FFT _fft;
+  size_t _hop;
+  uint64_t _readSeq{0};
+  size_t _inputBlocksDropped{0};
+
+  // the most recent fftSize input samples, oldest first, and the number of
+  // samples received since the last frame.
+  std::vector< float > _history;
+  size_t _historyFilled{0};
+  size_t _samplesSinceFrame{0};
+
+  std::vector< float > _window;
+  std::vector< float > _re;
+  std::vector< float > _im;
+  std::vector< float > _magnitudes;
+  std::vector< float > _inputBlocks;
+  float _magnitudeScale{1.f};
+};
+
+// AnalysisWorker: a thread that runs a set of SpectrumAnalyzers periodically.
+class AnalysisWorker
+{
+public:
+  AnalysisWorker() = default;
+  ~AnalysisWorker() { stop(); }
+
+  // analyzers may be added while the worker is running.
+  void add(std::shared_ptr< SpectrumAnalyzer > analyzer);
+
+  void start(int periodInMs);
+  void stop();
+  bool isRunning() const { return _thread.joinable(); }
+
+private:
+  void run(int periodInMs);
+
+  std::mutex _analyzersMutex;
+  std::vector< std::shared_ptr< SpectrumAnalyzer > > _analyzers;
+  std::atomic< bool > _running{false};
+  std::thread _thread;
+};
+
+} // namespace ml
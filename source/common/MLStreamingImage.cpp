@@ -0,0 +1,157 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "nanovg.h"
+#include "MLStreamingImage.h"
+
+namespace ml {
+
+namespace {
+
+bool overlapsOrTouches(const Rect& a, const Rect& b)
+{
+  return (a.left() <= b.right()) && (b.left() <= a.right()) &&
+    (a.top() <= b.bottom()) && (b.top() <= a.bottom());
+}
+
+// copy the pixels in r from one image buffer to another of the same size.
+void copyRect(const uint8_t* pSrc, uint8_t* pDest, size_t bytesPerRow, const Rect& r)
+{
+  size_t x = r.left(), y = r.top(), w = r.width(), h = r.height();
+  for(size_t row = y; row < y + h; ++row)
+  {
+    size_t offset = row*bytesPerRow + x*4;
+    std::memcpy(pDest + offset, pSrc + offset, w*4);
+  }
+}
+
+} // namespace
+
+// ----------------------------------------------------------------
+// DirtyRects
+
+void DirtyRects::add(Rect r)
+{
+  if(r.area() <= 0.f) return;
+
+  // merge r with every rect it touches. Growing r can make it touch
+  // rects it missed, so look again until nothing changes.
+  bool merged{true};
+  while(merged)
+  {
+    merged = false;
+    for(auto it = _rects.begin(); it != _rects.end(); ++it)
+    {
+      if(overlapsOrTouches(r, *it))
+      {
+        r = unionRects(r, *it);
+        _rects.erase(it);
+        merged = true;
+        break;
+      }
+    }
+  }
+  _rects.push_back(r);
+
+  if(_rects.size() > kMaxRects)
+  {
+    Rect bounds = _rects[0];
+    for(const auto& b : _rects)
+    {
+      bounds = unionRects(bounds, b);
+    }
+    _rects.clear();
+    _rects.push_back(bounds);
+  }
+}
+
+void DirtyRects::add(const DirtyRects& b)
+{
+  for(const auto& r : b._rects)
+  {
+    add(r);
+  }
+}
+
+float DirtyRects::getArea() const
+{
+  float a{0.f};
+  for(const auto& r : _rects)
+  {
+    a += r.area();
+  }
+  return a;
+}
+
+// ----------------------------------------------------------------
+// StreamingRasterImage
+
+StreamingRasterImage::StreamingRasterImage(NVGcontext* nvg, int width, int height, int imageFlags) :
+  _nvg(nvg), _width(std::max(width, 1)), _height(std::max(height, 1))
+{
+  _pixels.resize(getBytesPerRow()*_height);
+  _staging.resize(_pixels.size());
+  _handle = nvgCreateImageRGBA(_nvg, _width, _height, imageFlags, _staging.data());
+}
+
+StreamingRasterImage::~StreamingRasterImage()
+{
+  // NOTE
+  // like a DrawableImage, this must be deleted before the nvg context is.
+  if(_handle > 0)
+  {
+    nvgDeleteImage(_nvg, _handle);
+  }
+}
+
+void StreamingRasterImage::setDirty(Rect r)
+{
+  // snap outwards to whole pixels and clip to the image.
+  float left = std::floor(r.left());
+  float top = std::floor(r.top());
+  float right = std::ceil(r.right());
+  float bottom = std::ceil(r.bottom());
+  Rect snapped(left, top, right - left, bottom - top);
+  _dirty.add(intersectRects(snapped, Rect(0, 0, _width, _height)));
+}
+
+void StreamingRasterImage::publish()
+{
+  if(_dirty.empty()) return;
+
+  std::lock_guard< std::mutex > lock(_stagingMutex);
+  for(const auto& r : _dirty.getRects())
+  {
+    copyRect(_pixels.data(), _staging.data(), getBytesPerRow(), r);
+  }
+  _stagingDirty.add(_dirty);
+  _dirty.clear();
+}
+
+size_t StreamingRasterImage::upload()
+{
+  if(_handle <= 0) return 0;
+
+  std::lock_guard< std::mutex > lock(_stagingMutex);
+  if(_stagingDirty.empty()) return 0;
+
+  // the backends' texture update takes the whole image and a sub-rect to copy from it.
+  // nvgUpdateImage() only updates the whole image, so we call the backend directly.
+  NVGparams* params = nvgInternalParams(_nvg);
+  size_t bytes{0};
+  for(const auto& r : _stagingDirty.getRects())
+  {
+    params->renderUpdateTexture(params->userPtr, _handle, r.left(), r.top(), r.width(), r.height(), _staging.data());
+    bytes += size_t(r.area())*4;
+  }
+  _stagingDirty.clear();
+  return bytes;
+}
+
+} // namespace ml
@@ -0,0 +1,87 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "MLMath2D.h"
+
+// DrawContext.h includes the native headers, so we just declare this here.
+struct NVGcontext;
+
+namespace ml {
+
+// DirtyRects: the parts of an image that have changed, as a short list of
+// rects in pixels. A rect that overlaps or touches one already in the list is
+// merged with it, and if the list is full, all the rects are merged into
+// their bounding rect, so the list never has more than kMaxRects.
+class DirtyRects
+{
+public:
+  static constexpr size_t kMaxRects{8};
+
+  void add(Rect r);
+  void add(const DirtyRects& b);
+  void clear() { _rects.clear(); }
+  bool empty() const { return _rects.empty(); }
+  const std::vector< Rect >& getRects() const { return _rects; }
+  float getArea() const;
+
+private:
+  std::vector< Rect > _rects;
+};
+
+// StreamingRasterImage: an RGBA image whose pixels are made at runtime, for things
+// like waveform thumbnails and visualizers.
+//
+// The writer draws into its own copy of the pixels, marks what it changed with
+// setDirty(), and calls publish(). This copies just the dirty pixels to a
+// staging buffer. Once per frame, the AppView calls upload() on the render
+// thread, which sends just the rects that changed to the texture. The writer can
+// be on another thread: the two only share the staging buffer, and then only
+// while copying dirty pixels.
+class StreamingRasterImage
+{
+public:
+  StreamingRasterImage(NVGcontext* nvg, int width, int height, int imageFlags = 0);
+  ~StreamingRasterImage();
+
+  int getHandle() const { return _handle; }
+  int getWidth() const { return _width; }
+  int getHeight() const { return _height; }
+  explicit operator bool() const { return _handle > 0; }
+
+  // writer. The pixels are 4 bytes each, top row first.
+  uint8_t* getPixels() { return _pixels.data(); }
+  size_t getBytesPerRow() const { return _width*4; }
+
+  // writer. Mark a rect of pixels as changed. The rect is clipped to the image.
+  void setDirty(Rect r);
+
+  // writer. Make the changes so far available to upload().
+  void publish();
+
+  // render thread, outside of a frame. Upload any published changes to the texture,
+  // returning the number of bytes uploaded.
+  size_t upload();
+
+private:
+  NVGcontext* _nvg{nullptr};
+  int _handle{0};
+  int _width{0};
+  int _height{0};
+
+  std::vector< uint8_t > _pixels;
+  DirtyRects _dirty;
+
+  std::mutex _stagingMutex;
+  std::vector< uint8_t > _staging;
+  DirtyRects _stagingDirty;
+};
+
+} // namespace ml
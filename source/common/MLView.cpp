@@ -7,6 +7,7 @@
 
 #include "MLView.h"
 #include "MLDSPProjections.h"
+#include "MLProfiler.h"
 
 
 using namespace ml;
@@ -27,6 +28,64 @@ void View::setDirty(bool d)
   _dirty = d;
 }
 
+Rect View::getVisibleRect() const
+{
+  // before the View is laid out, don't cull anything.
+  if(!hasProperty("bounds"))
+  {
+    constexpr float kBig{1e6f};
+    return Rect(-kBig, -kBig, kBig*2, kBig*2);
+  }
+
+  Rect bounds = getBounds();
+  Rect r(0, 0, bounds.width(), bounds.height());
+
+  // undo the transform made in draw(): scale around the center, then move.
+  if(hasProperty("scale"))
+  {
+    float s = getFloatProperty("scale");
+    if(s > 0.f)
+    {
+      r = alignCenterToPoint(Rect(0, 0, r.width()/s, r.height()/s), r.center());
+    }
+  }
+  if(hasProperty("position"))
+  {
+    r = translate(r, -matrixToVec2(getMatrixProperty("position")));
+  }
+  return r;
+}
+
+Vec2 View::viewToWidgetCoords(Vec2 p) const
+{
+  if(!hasProperty("bounds")) return p;
+  Rect bounds = getBounds();
+  
+  // the same transform as getVisibleRect().
+  if(hasProperty("scale"))
+  {
+    float s = getFloatProperty("scale");
+    if(s > 0.f)
+    {
+      Vec2 c(bounds.width()*0.5f, bounds.height()*0.5f);
+      p = Vec2(c.x() + (p.x() - c.x())/s, c.y() + (p.y() - c.y())/s);
+    }
+  }
+  if(hasProperty("position"))
+  {
+    Vec2 position = matrixToVec2(getMatrixProperty("position"));
+    p = Vec2(p.x() - position.x(), p.y() - position.y());
+  }
+  return p;
+}
+
+bool View::isOnScreen(const Widget& w, const Rect& visibleRect) const
+{
+  // Widgets without bounds yet may be about to get them.
+  if(!w.hasProperty("bounds")) return true;
+  return bool(intersectRects(w.getBounds(), visibleRect));
+}
+
 // slow reverse lookup of Widget name, for debugging only!
 Path View::_widgetPointerToName(Widget* wPtr)
 {
@@ -41,13 +100,14 @@ Path View::_widgetPointerToName(Widget* wPtr)
 }
 
 // Process GUI events in this View and keep track of the stillDown widget.
-// TODO allow scale and offset of view
+// The event is moved into the coordinates of the Widgets, as they are drawn.
 MessageList View::processGUIEvent(const GUICoordinates& gc, GUIEvent e)
 {
   constexpr bool kDebug{false};
   constexpr float kDragRepositionDistance{1.0f};
   MessageList r;
   
+  e.position = viewToWidgetCoords(e.position);
   auto wvec = findWidgetsForEvent(e);
   if(wvec.size() > 0)
   {
@@ -59,6 +119,7 @@ MessageList View::processGUIEvent(const GUICoordinates& gc, GUIEvent e)
   if(_stillDownWidget)
   {
     auto messagesFromWidget = (_stillDownWidget->processGUIEvent(gc, e));
+    _stillDownWidget->markInputTime(e.enqueueTime);
     
     // DEBUG
     if(kDebug)
@@ -86,6 +147,8 @@ MessageList View::processGUIEvent(const GUICoordinates& gc, GUIEvent e)
       
       if (messagesFromWidget.size() > 0)
       {
+        w->markInputTime(e.enqueueTime);
+        
         if(kDebug)
         {
           auto widgetName = _widgetPointerToName(w);
@@ -112,6 +175,7 @@ MessageList View::processGUIEvent(const GUICoordinates& gc, GUIEvent e)
 
 MessageList View::animate(int elapsedTimeInMs, ml::DrawContext dc)
 {
+  ML_PROFILE_SCOPE("View::animate");
   MessageList v;
   
   // TEST
@@ -123,6 +187,7 @@ MessageList View::animate(int elapsedTimeInMs, ml::DrawContext dc)
     framesSinceTick = 0;
   }
   
+  Rect visibleRect = getVisibleRect();
   forEachChild< Widget >
   (_widgets,
    [&](Widget& w) {
@@ -132,6 +197,11 @@ MessageList View::animate(int elapsedTimeInMs, ml::DrawContext dc)
       std::cout << "YIKES!\n";
       return;
     }
+    if(!isOnScreen(w, visibleRect) && !w.getBoolPropertyWithDefault("animate_offscreen", false))
+    {
+      return;
+    }
+    w.updateVisibleState(dc);
     // std::cout << "anim" << wAddr << "\n";
     auto retList = w.animate(elapsedTimeInMs, dc);
     v.append(retList); }
@@ -148,6 +218,7 @@ MessageList View::animate(int elapsedTimeInMs, ml::DrawContext dc)
 
 void View::draw(ml::DrawContext dc)
 {
+  ML_PROFILE_SCOPE("View::draw");
   _frameCounter++;
   
   framesSinceTick++;
@@ -190,13 +261,21 @@ void View::draw(ml::DrawContext dc)
   }
 
 
+  _exposed.clear();
   setDirty(false);
 }
 
+// e.position is in the coordinates of the Widgets.
 std::vector< Widget* > View::findWidgetsForEvent(const GUIEvent& e)
 {
   std::vector< Widget* > widgetsForEvent;
   
+  // nothing can be hit where the View can't be seen.
+  if(!within(e.position, getVisibleRect()))
+  {
+    return widgetsForEvent;
+  }
+  
   forEachChild< Widget >
   (_widgets, [&](Widget& w)
    {
@@ -224,16 +303,43 @@ std::vector< Widget* > View::findWidgetsForEvent(const GUIEvent& e)
 // if widget is a view, it may draw sub-widgets.
 void View::drawWidget(const ml::DrawContext& dc, Widget* w)
 {
+  ML_PROFILE_SCOPE("View::drawWidget");
   NativeDrawContext* nvg = getNativeContext(dc);
   Rect widgetBounds = getPixelBounds(dc, *w);
   
+  RenderStats statsBefore;
+  if(dc.pRenderStats)
+  {
+    statsBefore = dc.pRenderStats->getCurrentStats();
+  }
+  
   nvgSave(nvg);
   nvgIntersectScissor(nvg, widgetBounds);
   nvgTranslate(nvg, getTopLeft(widgetBounds));
   w->draw(dc);
   w->setDirty(false);
+  w->_visibleState = w->getVisibleState(dc);
   nvgRestore(nvg);
   
+  // the Widget's old area, if it moved, has now been redrawn.
+  if(w->hasProperty("previous_bounds"))
+  {
+    w->setProperty("previous_bounds", rectToMatrix(w->getBounds()));
+  }
+  
+  // attribute the rendering work done since statsBefore to the Widget.
+  if(dc.pRenderStats)
+  {
+    dc.pRenderStats->addWidgetStats(w, dc.pRenderStats->getCurrentStats() - statsBefore);
+  }
+  
+  // report the input time to be measured when this frame is presented.
+  if(dc.pLatencyMonitor && (w->_inputTime != InputTime{}))
+  {
+    dc.pLatencyMonitor->widgetDrawn(w->_inputTime);
+  }
+  w->_inputTime = InputTime{};
+  
   bool kShowWidgetBounds = dc.pProperties->getBoolPropertyWithDefault("draw_widget_bounds", false);
   if(kShowWidgetBounds)
   {
@@ -277,9 +383,149 @@ void View::drawBackgroundWidget(const ml::DrawContext& dc, Widget* w)
 }
 
 
+namespace {
+
+// true if a covers all of b.
+bool covers(const Rect& a, const Rect& b)
+{
+  return (a.area() > 0.) && (a.left() <= b.left()) && (a.top() <= b.top()) &&
+    (a.right() >= b.right()) && (a.bottom() >= b.bottom());
+}
+
+// the pixels a Widget paints opaquely, rounded as its scissor is in drawWidget().
+Rect getOpaquePixelBounds(const DrawContext& dc, const Widget& w)
+{
+  Rect r = w.getOpaqueBounds();
+  return (r.area() > 0.) ? roundToInt(dc.coords.gridToPixel(r)) : Rect();
+}
+
+// the most rects that damage is repaired in before they are merged into one.
+constexpr size_t kMaxRepairRects{8};
+
+// merge rects to repair damage in. A Widget touching more than one rect, such
+// as a Widget spanning several bands of a region, would be drawn once in each,
+// so the rects it touches are merged into their bounds, as are any rects that
+// then overlap, until each Widget touches at most one rect. Past
+// kMaxRepairRects, all are merged into one.
+std::vector< Rect > mergeRepairRects(std::vector< Rect > rects, const std::vector< Rect >& widgetPixelBounds)
+{
+  std::vector< size_t > touching;
+  bool merged{true};
+  while(merged && (rects.size() > 1))
+  {
+    merged = false;
+    for(const Rect& bounds : widgetPixelBounds)
+    {
+      touching.clear();
+      for(size_t i = 0; i < rects.size(); ++i)
+      {
+        if(intersectRects(bounds, rects[i])) touching.push_back(i);
+      }
+      if(touching.size() > 1)
+      {
+        Rect enclosing = rects[touching[0]];
+        for(size_t i = touching.size() - 1; i > 0; --i)
+        {
+          enclosing = rectEnclosing(enclosing, rects[touching[i]]);
+          rects.erase(rects.begin() + touching[i]);
+        }
+        rects[touching[0]] = enclosing;
+        merged = true;
+      }
+    }
+    
+    for(size_t i = 0; i < rects.size(); ++i)
+    {
+      for(size_t j = rects.size() - 1; j > i; --j)
+      {
+        if(intersectRects(rects[i], rects[j]))
+        {
+          rects[i] = rectEnclosing(rects[i], rects[j]);
+          rects.erase(rects.begin() + j);
+          merged = true;
+        }
+      }
+    }
+  }
+  
+  if(rects.size() > kMaxRepairRects)
+  {
+    Rect enclosing = rects[0];
+    for(const Rect& r : rects)
+    {
+      enclosing = rectEnclosing(enclosing, r);
+    }
+    rects = {enclosing};
+  }
+  return rects;
+}
+
+bool touchesAny(const Rect& bounds, const std::vector< Rect >& rects)
+{
+  return std::any_of(rects.begin(), rects.end(), [&](const Rect& r) { return bool(intersectRects(bounds, r)); });
+}
+
+} // namespace
+
+// remove the Widgets that are hidden completely by nearer opaque Widgets
+// from a list sorted in drawing order. If clipPixels is not empty, only the
+// part of each Widget inside it needs to be hidden. A removed Widget is not
+// dirty any more: if whatever hides it moves, its old area will be redrawn.
+void View::cullOccludedWidgets(const DrawContext& dc, std::vector< Widget* >& widgets, const Rect& clipPixels)
+{
+  struct Occluder
+  {
+    float z;
+    Rect pixels;
+  };
+  std::vector< Occluder > occluders;
+  for(auto w : widgets)
+  {
+    Rect r = getOpaquePixelBounds(dc, *w);
+    if(r.area() > 0.)
+    {
+      occluders.push_back(Occluder{w->getFloatProperty("z"), r});
+    }
+  }
+  if(occluders.empty()) return;
+  
+  size_t occludedCount{0};
+  auto isOccluded = [&](Widget* w)
+  {
+    float z = w->getFloatProperty("z");
+    Rect pixels = getPixelBounds(dc, *w);
+    if(clipPixels.area() > 0.)
+    {
+      pixels = intersectRects(pixels, clipPixels);
+    }
+    for(const auto& o : occluders)
+    {
+      // a lower z is nearer. With equal z, the drawing order is not defined.
+      if((o.z < z) && covers(o.pixels, pixels))
+      {
+        w->setDirty(false);
+        if(w->hasProperty("previous_bounds"))
+        {
+          w->setProperty("previous_bounds", rectToMatrix(w->getBounds()));
+        }
+        occludedCount++;
+        return true;
+      }
+    }
+    return false;
+  };
+  widgets.erase(std::remove_if(widgets.begin(), widgets.end(), isOccluded), widgets.end());
+  
+  if(dc.pRenderStats)
+  {
+    dc.pRenderStats->currentStats().widgetsOccluded += occludedCount;
+  }
+}
+
 void View::drawAllWidgets(ml::DrawContext dc)
 {
   std::vector< Widget* > visibleWidgets;
+  Rect visibleRect = getVisibleRect();
   
   forEachChild< Widget >
   (_widgets, [&](Widget& w)
@@ -288,13 +534,16 @@ void View::drawAllWidgets(ml::DrawContext dc)
     bool visible = w.getBoolProperty("visible");
     if((visible)&&(w.hasProperty("bounds")))
     {
-      // TODO if bounds intersects view bounds
-      visibleWidgets.push_back(&w);
+      if(isOnScreen(w, visibleRect))
+      {
+        visibleWidgets.push_back(&w);
+      }
     }
   });
   
   // draw all widgets in z order.
   std::sort(visibleWidgets.begin(), visibleWidgets.end(), [&](Widget* a, Widget* b){ return (a->getProperty("z").getFloatValue() > b->getProperty("z").getFloatValue());} );
+  cullOccludedWidgets(dc, visibleWidgets);
   
   for(auto w : visibleWidgets)
   {
@@ -302,41 +551,108 @@ void View::drawAllWidgets(ml::DrawContext dc)
   }
 }
 
-struct WidgetGroup
+std::vector< View::Repair > View::getRepairs(const DrawContext& dc)
 {
-  Rect bounds;
-  std::vector< Widget* > widgets;
-
-  WidgetGroup(Widget& w)
+  // the damaged area is the current and previous pixel bounds of each dirty
+  // Widget, grown by a pixel for antialiasing, and any area a resize exposed.
+  // Dirty Widgets off screen stay dirty until they are drawn.
+  Rect visibleRect = getVisibleRect();
+  Region damage;
+  forEachChild< Widget >
+  (_widgets, [&](Widget& w)
+   {
+    if(w.getBoolProperty("visible") && w.isDirty() && isOnScreen(w, visibleRect))
+    {
+      damage.add(grow(getPixelBounds(dc, w), 1));
+      if(w.hasProperty("previous_bounds"))
+      {
+        Rect previousBounds = w.getRectProperty("previous_bounds");
+        damage.add(grow(roundToInt(dc.coords.gridToPixel(previousBounds)), 1));
+      }
+    }
+  }
+   );
+  for(const Rect& r : _exposed.getRects())
   {
-    bounds = getCurrentAndPreviousBounds(w);
-    widgets.push_back(&w);
+    damage.add(r);
   }
-  ~WidgetGroup() = default;
+  if(damage.isEmpty()) return {};
   
-  void add(Widget* w)
+  // the visible Widgets, in z order.
+  std::vector< Widget* > visibleWidgets;
+  forEachChild< Widget >
+  (_widgets, [&](Widget& w)
+   {
+    if(w.getBoolProperty("visible") && w.hasProperty("bounds"))
+    {
+      visibleWidgets.push_back(&w);
+    }
+  }
+   );
+  std::sort(visibleWidgets.begin(), visibleWidgets.end(), [&](Widget* a, Widget* b) {
+    return (a->getProperty("z").getFloatValue() > b->getProperty("z").getFloatValue());
+  } );
+  std::vector< Rect > visiblePixelBounds;
+  visiblePixelBounds.reserve(visibleWidgets.size());
+  for(auto w : visibleWidgets)
   {
-    if(std::find(widgets.begin(), widgets.end(), w) == widgets.end())
-      widgets.push_back(w);
+    visiblePixelBounds.push_back(getPixelBounds(dc, *w));
   }
   
-  void addAndExpand(Widget* w)
+  // merged rects can cover Widgets that the damage did not touch. Those are
+  // painted over too, so they must be drawn, and they may touch more rects.
+  // Collect the Widgets touching the rects and merge again until no more
+  // Widgets are added.
+  std::vector< Rect > rects = damage.getRects();
+  std::vector< Rect > touchingPixelBounds;
+  size_t previousCount{~size_t(0)};
+  while(true)
   {
-    if(std::find(widgets.begin(), widgets.end(), w) == widgets.end())
-      widgets.push_back(w);
-    bounds = rectEnclosing(bounds, w->getBounds());
+    touchingPixelBounds.clear();
+    for(const Rect& bounds : visiblePixelBounds)
+    {
+      if(touchesAny(bounds, rects))
+      {
+        touchingPixelBounds.push_back(bounds);
+      }
+    }
+    if(touchingPixelBounds.size() == previousCount) break;
+    previousCount = touchingPixelBounds.size();
+    rects = mergeRepairRects(std::move(rects), touchingPixelBounds);
   }
   
-  void mergeWithGroup(const WidgetGroup& wg2)
+  std::vector< Repair > repairs(rects.size());
+  for(size_t i = 0; i < rects.size(); ++i)
   {
-    for(Widget* w2 : wg2.widgets)
+    repairs[i].pixels = rects[i];
+    for(size_t j = 0; j < visibleWidgets.size(); ++j)
     {
-      if(std::find(widgets.begin(), widgets.end(), w2) == widgets.end())
-        widgets.push_back(w2);
+      if(intersectRects(visiblePixelBounds[j], rects[i]))
+      {
+        repairs[i].widgets.push_back(visibleWidgets[j]);
+      }
     }
-    bounds = rectEnclosing(bounds, wg2.bounds);
   }
-};
+  return repairs;
+}
+
+bool View::exposeResizedArea(const DrawContext& dc, Vec2 previousSizeInPixels)
+{
+  // a background image is stretched to the size of the View, so all of it changes.
+  if(_backgroundImage.get(dc)) return false;
+  
+  Vec2 size = dc.coords.viewSizeInPixels;
+  Vec2 previous = previousSizeInPixels;
+  if(size.x() > previous.x())
+  {
+    _exposed.add(Rect(previous.x(), 0, size.x() - previous.x(), size.y()));
+  }
+  if(size.y() > previous.y())
+  {
+    _exposed.add(Rect(0, previous.y(), size.x(), size.y() - previous.y()));
+  }
+  return true;
+}
 
 void View::drawDirtyWidgets(ml::DrawContext dc)
 {
@@ -359,118 +675,55 @@ void View::drawDirtyWidgets(ml::DrawContext dc)
     }
   }
 
-  std::vector< WidgetGroup > widgetGroups;
-  
-  // clear needsDraw flags
-  forEachChild< Widget >
-  (_widgets, [&](Widget& w)
-   { w._needsDraw = false; }
-   );
-  
-  size_t sweepIters{0};
-  forEachChild< Widget >
-  (_widgets, [&](Widget& w)
-   {
-      if(w.getBoolProperty("visible") && w.isDirty())
+  // repair each rect of the damage on its own, so that the background and
+  // Widgets are only drawn near where something changed, not over the bounds
+  // of everything that changed. Each Widget is in at most one repair rect,
+  // so it is drawn at most once.
+  for(auto& repair : getRepairs(dc))
+  {
+    ML_PROFILE_SCOPE("DamageRect");
+    
+    const Rect& damageRect = repair.pixels;
+    std::vector< Widget* >& widgetsInRect = repair.widgets;
+    cullOccludedWidgets(dc, widgetsInRect, damageRect);
+    
+    // if one opaque Widget covers the rect, it paints over everything the
+    // background would, and the background is not needed.
+    bool needsBackground{true};
+    for(auto w : widgetsInRect)
+    {
+      if(covers(getOpaquePixelBounds(dc, *w), damageRect))
       {
-        WidgetGroup newGroup(w);
-        w._needsDraw = true;
-        
-        while(1)
-        {
-          sweepIters++;
-          bool changed{false};
-          // if new group overlaps any Widgets w2 that are not marked as
-          // needing drawing, add w2 to the group.
-          forEachChild< Widget >
-          (_widgets, [&](Widget& w2)
-           {
-            // if newGroup intersects visible w2, add to group
-            
-            // safety in case widget has not received bounds property yet
-            Rect w2Bounds = w2.getRectProperty("bounds");
-            
-            if((!w2._needsDraw) && w2.getBoolProperty("visible") && intersectRects(newGroup.bounds, w2Bounds))
-            {
-              w2._needsDraw = true;
-              newGroup.addAndExpand(&w2);
-              changed = true;
-            }
-          }
-           );
-            
-          // if new group overlaps any other group wg2, merge wg2 into new group
-          // and delete wg2 from list
-          for(auto it = widgetGroups.begin(); it != widgetGroups.end(); )
-          {
-            WidgetGroup& wg2 = *it;
-            if(intersectRects(newGroup.bounds, wg2.bounds))
-            {
-              newGroup.mergeWithGroup(wg2);
-              it = widgetGroups.erase(it);
-              changed = true;
-            }
-            else
-            {
-              it++;
-            }
-          }
-          
-          // if no groups can grow any more, we are done collecting.
-          if(!changed) break;
-        }
-        
-        // add new group to the group list
-        widgetGroups.push_back(newGroup);
+        needsBackground = false;
+        break;
       }
-   }
-   );
-  
-  // for each widget group,
-  
-//  int g{0};
-//  std::cout << "drawing groups: -------------\n";
-  
-  for(auto& wg : widgetGroups)
-  {
-    // sort the widgets by z
-    std::sort(wg.widgets.begin(), wg.widgets.end(), [&](Widget* a, Widget* b) {
-      return (a->getProperty("z").getFloatValue() > b->getProperty("z").getFloatValue());
-    } );
+    }
     
-    // draw background under this group's rect
-    auto groupBounds = dc.coords.gridToPixel(wg.bounds);
-    groupBounds = grow(groupBounds, 1);
-
     nvgSave(nvg);
-    nvgIntersectScissor(nvg, groupBounds);
-
-    drawBackground(dc, groupBounds);
-
-//    std::cout << "         group: " << g++ << " -------------\n";
-
-    for(auto w : wg.widgets)
+    nvgIntersectScissor(nvg, damageRect);
+    
+    if(needsBackground)
     {
-//      std::cout << "              widget: " << (unsigned long)w << "\n";
-
+      drawBackground(dc, damageRect);
+    }
+    
+    for(auto w : widgetsInRect)
+    {
+      // everything under the rect is being painted again, so a Widget drawn
+      // here must draw all of itself, even if it is a View with only some
+      // dirty Widgets.
+      w->setDirty(true);
       drawWidget(dc, w);
-
     }
     
     nvgRestore(nvg);
   }
-  
-  /*
-  if(widgetGroups.size()  > 0)
-  {
-    std::cout << "drawing: " << sweepIters << " iters, " << widgetGroups.groups.size() << " groups\n";
-  }
-  */
 }
 
 // draw a rectangle of the background.
 void View::drawBackground(DrawContext dc, ml::Rect nativeRect)
 {
+  ML_PROFILE_SCOPE("View::drawBackground");
   NativeDrawContext* nvg = getNativeContext(dc);
   
   Vec2 pixelSize = dc.coords.viewSizeInPixels;
@@ -506,7 +759,7 @@ void View::drawBackground(DrawContext dc, ml::Rect nativeRect)
   
   // get image
   NVGpaint paintPattern;
-  auto pr = getRasterImage(dc, "background");
+  auto pr = _backgroundImage.get(dc);
   if(pr)
   {
     paintPattern = nvgImagePattern(nvg, -u, -u, dc.coords.viewSizeInPixels.x() + u, dc.coords.viewSizeInPixels.y() + u, 0, pr->handle, 1.0f);
@@ -528,6 +781,13 @@ void View::drawBackground(DrawContext dc, ml::Rect nativeRect)
     nvgFillPaint(nvg, paintPattern);
     nvgFill(nvg);
     
+    // a background image that is still loading is shown by a placeholder.
+    // A View without one just has the background color.
+    if(!pr && dc.pResources->isPending(_backgroundImage.getName()))
+    {
+      drawPendingResource(dc, nativeRect);
+    }
+    
     // draw background Widgets intersecting rect
     for(const auto& w : _backgroundWidgets)
     {
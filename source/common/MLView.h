@@ -37,9 +37,36 @@ namespace ml
 		void draw(DrawContext d) override;
 
 		// View interface
+		//
+		// the part of this View that can be seen, in the grid coordinates of its
+		// Widgets, allowing for the "scale" and "position" properties. Widgets
+		// outside it are not drawn, hit or animated. Widgets that move themselves
+		// into view in animate() should set the property "animate_offscreen".
+		Rect getVisibleRect() const;
+		bool isOnScreen(const Widget& w, const Rect& visibleRect) const;
+
+		// convert a point in this View's own grid coordinates, as events arrive,
+		// to the grid coordinates of its Widgets by undoing "scale" and "position".
+		Vec2 viewToWidgetCoords(Vec2 p) const;
+
 		void drawWidget(const DrawContext& dc, Widget* w);
 		void drawAllWidgets(DrawContext dc);
 		void drawDirtyWidgets(DrawContext dc);
+		void cullOccludedWidgets(const DrawContext& dc, std::vector< Widget* >& widgets, const Rect& clipPixels = Rect());
+
+		// a rect of damage in pixels to repair, and the visible Widgets touching
+		// it in drawing order. Each Widget touches at most one Repair.
+		struct Repair
+		{
+			Rect pixels;
+			std::vector< Widget* > widgets;
+		};
+		std::vector< Repair > getRepairs(const DrawContext& dc);
+
+		// after the size of the View in pixels changes, with what was drawn kept
+		// in place at the top left, repair the newly exposed area in the next
+		// draw(). Returns false if everything must be redrawn instead.
+		bool exposeResizedArea(const DrawContext& dc, Vec2 previousSizeInPixels);
 
 	private:
 		void drawBackgroundWidget(const DrawContext& dc, Widget* w);
@@ -47,6 +74,8 @@ namespace ml
 		Path _widgetPointerToName(Widget* w);
 		std::vector< Widget* > findWidgetsForEvent(const GUIEvent& e);
 		virtual void drawBackground(DrawContext dc, Rect nativeRect);
+		ResourceHandle< RasterImage > _backgroundImage{ Path("background") };
+		Region _exposed;
 		size_t _frameCounter{ 0 };
 		int framesSinceTick{ 0 };
 		int testCounter{ 0 };
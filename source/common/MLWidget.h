@@ -45,8 +45,24 @@ namespace ml {
         // true if the Widget needs to be redrawn.
         bool _dirty{ true };
 
-        // internal flag for View
-        bool _needsDraw{ false };
+        // the time the earliest input event that changed this Widget since it
+        // was last drawn was queued, or zero if none. Used to measure input latency.
+        InputTime _inputTime{};
+
+        void markInputTime(InputTime t)
+        {
+            if (t == InputTime{}) return;
+            if ((_inputTime == InputTime{}) || (t < _inputTime))
+            {
+                _inputTime = t;
+            }
+        }
+
+        // the visible state when the Widget was last drawn. See getVisibleState().
+        uint64_t _visibleState{ 0 };
+
+        // true if a parameter has changed since the visible state was last checked.
+        bool _checkVisibleState{ false };
 
     protected:
 
@@ -78,15 +94,24 @@ namespace ml {
         bool isDirty() { return _dirty; }
 
         // default implementation of Widget::handleMessage:
-        // set a param value or an internal property and mark self as dirty.
+        // set a param value or an internal property. A new property marks the
+        // Widget dirty. A new param value marks it to be checked by
+        // updateVisibleState(), and dirty only if it looks different.
         void handleMessage(Message msg, MessageList* /* replyPtr */) override
         {
             switch (hash(head(msg.address)))
             {
             case(hash("set_param")):
             {
-                setParamValue(tail(msg.address), msg.value);
-                _dirty = true;
+                // a new value is only drawn if it looks different, which is
+                // checked in updateVisibleState() before the next frame.
+                Path paramName = tail(msg.address);
+                Value previousValue = getParamValue(paramName);
+                _params.setFromNormalizedValue(paramName, msg.value);
+                if (!(getParamValue(paramName) == previousValue))
+                {
+                    _checkVisibleState = true;
+                }
                 break;
             }
             case(hash("set_prop")):
@@ -178,6 +203,8 @@ namespace ml {
         virtual MessageList processGUIEvent(const GUICoordinates& gc, GUIEvent e) { return MessageList{}; }
 
         // process data from a published Signal, for signal viewers. Most Widgets don't implement this.
+        // sigType is "signal" for frames of a signal, with one row per channel, or
+        // "spectrum" for frames of magnitudes, with one row per frame.
         virtual void processPublishedSignal(Value sigVal, Symbol sigType) {}
 
         // called by the editor each frame just before drawing. This allows Widgets to
@@ -189,6 +216,26 @@ namespace ml {
         // to show or hide itself in its animate() method. 
         virtual MessageList animate(int elapsedTimeInMs, DrawContext d) { return MessageList{}; }
 
+        // a hash of what the Widget shows, quantized so that changes too small to
+        // see give the same value: a dial might quantize its indicator to whole
+        // pixels of travel at its current radius. A Widget that implements this is
+        // only redrawn for a new parameter value that changes it. The default of 0
+        // means unknown, and every new value is drawn.
+        virtual uint64_t getVisibleState(const DrawContext& d) { return 0; }
+
+        // called by the View before animate(). If a parameter has changed, mark
+        // the Widget dirty if it no longer looks as it was last drawn.
+        void updateVisibleState(const DrawContext& d)
+        {
+            if (!_checkVisibleState) return;
+            _checkVisibleState = false;
+            uint64_t s = getVisibleState(d);
+            if ((s == 0) || (s != _visibleState))
+            {
+                _dirty = true;
+            }
+        }
+
         // give Widgets a chance to do things like make internal buffers on resize.
         virtual void resize(DrawContext d) {}
 
@@ -197,6 +244,15 @@ namespace ml {
         // the context will be restored to its current state after the call.
         virtual void draw(DrawContext d) {}
 
+        // the area, in the View's grid coordinates, that draw() paints completely
+        // with opaque colors. The View doesn't draw Widgets hidden behind it, or the
+        // background under it. By default a Widget covers its bounds if it has the
+        // property "opaque" and nothing otherwise.
+        virtual ml::Rect getOpaqueBounds() const
+        {
+            return getBoolPropertyWithDefault("opaque", false) ? getBounds() : ml::Rect();
+        }
+
         // property helpers
         inline ml::Rect getRectProperty(Path p, ml::Rect r = Rect()) const { return matrixToRect(getMatrixPropertyWithDefault(p, rectToMatrix(r))); }
         inline void setRectProperty(Path p, ml::Rect r) { setProperty(p, rectToMatrix(r)); }
@@ -227,6 +283,19 @@ namespace ml {
         return roundToInt(dc.coords.gridToPixel(w.getBounds()));
     }
 
+    // combine a value into a visible state hash, starting from kVisibleStateSeed.
+    constexpr uint64_t kVisibleStateSeed{ 14695981039346656037ULL };
+    inline uint64_t combineVisibleState(uint64_t h, uint64_t v) { return (h ^ v)*1099511628211ULL; }
+
+    inline uint64_t combineVisibleState(uint64_t h, const char* text)
+    {
+        while (text && *text)
+        {
+            h = combineVisibleState(h, uint64_t(uint8_t(*text++)));
+        }
+        return h;
+    }
+
     inline ml::Rect getCurrentAndPreviousBounds(const Widget& w)
     {
         // not needed? w.hasProperty("bounds")
@@ -27,3 +27,4 @@
 #include "MLSVGButtonBasic.h"
 #include "MLTextButtonBasic.h"
 #include "MLToggleButtonBasic.h"
+#include "MLVirtualListView.h"
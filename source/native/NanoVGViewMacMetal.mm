@@ -36,6 +36,7 @@
 #include "MLGUICoordinates.h"
 #include "MLGUIEvent.h"
 #include "MLDrawContext.h"
+#include "MLProfiler.h"
 
 Vec2 NSPointToVec2(NSPoint p)
 {
@@ -409,6 +410,7 @@ Vec2 makeDelta(CGFloat x, CGFloat y)
   id<MTLDevice> _device;
   NVGcontext* _nvg;
   AppView* appView_; // non-owning pointer
+  std::unique_ptr< FramebufferPool > _framebuffers;
   std::unique_ptr< DrawableImage > _backingLayer;
   Vec2 _nativeSize;
   Vec2 _systemSize;
@@ -432,6 +434,7 @@ Vec2 makeDelta(CGFloat x, CGFloat y)
       NSLog(@"Could not create nanovg.");
       return self;
     }
+    _framebuffers = std::make_unique< FramebufferPool >(_nvg);
     
     appView_ = nullptr;
     displayScale = scale;
@@ -447,7 +450,12 @@ Vec2 makeDelta(CGFloat x, CGFloat y)
 
 -(void)dealloc
 {
+  if(appView_)
+  {
+    appView_->setFramebufferPool(nullptr);
+  }
   _backingLayer = nullptr;
+  _framebuffers = nullptr;
   if(_nvg)
   {
     nvgDeleteMTL(_nvg);
@@ -485,11 +493,12 @@ Vec2 makeDelta(CGFloat x, CGFloat y)
     nvgEndFrame(_nvg);
       
     // blit backing layer to main layer
+    ML_PROFILE_SCOPE("present");
     drawToImage(nullptr);
     nvgBeginFrame(_nvg, w, h, 1.0f);
     
-    // get image pattern for 1:1 blit
-    NVGpaint img = nvgImagePattern(_nvg, 0, 0, w, h, 0, _backingLayer->_buf->image, 1.0f);
+    // get image pattern for 1:1 blit of the part of the layer in use
+    NVGpaint img = drawableImagePattern(_nvg, *_backingLayer);
         
     // blit the image
     nvgSave(_nvg);
@@ -502,6 +511,7 @@ Vec2 makeDelta(CGFloat x, CGFloat y)
     
     // end main update
     nvgEndFrame(_nvg);
+    appView_->framePresented();
   }
 }
 
@@ -523,17 +533,18 @@ Vec2 makeDelta(CGFloat x, CGFloat y)
   needsResize = false;
   _nativeSize = _systemSize*displayScale;
     
-  Vec2 layerSize(0, 0);
-  if(_backingLayer.get()) layerSize = Vec2(_backingLayer->width, _backingLayer->height);
-  
-  if(_nativeSize != layerSize)
+  // get a framebuffer at least as big as the new size from the pool. When
+  // shrinking, or growing within the same bucket, the layer is kept as is.
+  bool contentsKept{false};
+  if(_framebuffers)
   {
-    _backingLayer = std::make_unique< DrawableImage >(_nvg, _nativeSize.x(), _nativeSize.y());
+    contentsKept = _framebuffers->resize(_backingLayer, _nativeSize.x(), _nativeSize.y());
   }
   
   if(appView_ && _nvg)
   {
-    appView_->viewResized(_nvg, _nativeSize, displayScale);
+    appView_->setFramebufferPool(_framebuffers.get());
+    appView_->viewResized(_nvg, _nativeSize, displayScale, contentsKept);
   }
 }
 
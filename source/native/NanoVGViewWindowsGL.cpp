@@ -23,6 +23,7 @@
 
 #include "MLAppView.h"
 #include "MLPlatformView.h"
+#include "MLProfiler.h"
 
 enum DeviceScaleMode
 {
@@ -149,6 +150,7 @@ struct PlatformView::Impl
     HGLRC openGLContext_{ nullptr };
     NVGcontext* nvg_{ nullptr };
     ml::AppView* appView_{ nullptr };
+    std::unique_ptr< FramebufferPool > framebuffers_;
     std::unique_ptr< DrawableImage > nvgBackingLayer_;
     CRITICAL_SECTION drawLock_{ nullptr };
     int targetFPS_{ 30 };
@@ -650,6 +652,7 @@ bool PlatformView::Impl::createOpenGLContext(HWND hwnd)
 
     nvg_ = nvgCreateGL3(NVG_ANTIALIAS);
     if (!nvg_) return false;
+    framebuffers_ = std::make_unique< FramebufferPool >(nvg_);
 
     return true;
 }
@@ -658,7 +661,12 @@ void PlatformView::Impl::destroyOpenGLContext()
 {
     if (nvg_)
     {
+        if (appView_)
+        {
+            appView_->setFramebufferPool(nullptr);
+        }
         nvgBackingLayer_ = nullptr;
+        framebuffers_ = nullptr;
 
         // delete nanovg
         lockContext();
@@ -758,6 +766,7 @@ void PlatformView::Impl::resizeIfNeeded()
         }
 
         backingLayerSize_ = newSystemSize_ * backingScale_;
+        bool contentsKept{ false };
 
         // resize window, GL, nanovg  
         if (windowHandle_)
@@ -767,10 +776,12 @@ void PlatformView::Impl::resizeIfNeeded()
             makeContextCurrent();
             SetWindowPos(windowHandle_, NULL, 0, 0, backingLayerSize_.x(), backingLayerSize_.y(), flags);
 
-            // resize main backing layer
-            if (nvg_)
+            // resize main backing layer. The pool keeps its framebuffer when
+            // shrinking, so a live resize stops allocating once warmed up. A
+            // kept framebuffer keeps what was drawn to it.
+            if (framebuffers_)
             {
-                nvgBackingLayer_ = std::make_unique< DrawableImage >(nvg_, backingLayerSize_.x(), backingLayerSize_.y());
+                contentsKept = framebuffers_->resize(nvgBackingLayer_, backingLayerSize_.x(), backingLayerSize_.y());
             }
             unlockContext();
         }
@@ -778,7 +789,8 @@ void PlatformView::Impl::resizeIfNeeded()
         // notify the renderer
         if (appView_)
         {
-            appView_->viewResized(nvg_, backingLayerSize_, backingScale_);
+            appView_->setFramebufferPool(framebuffers_.get());
+            appView_->viewResized(nvg_, backingLayerSize_, backingScale_, contentsKept && kDoubleBufferView);
         }
 
         // change current size and scale 
@@ -860,13 +872,14 @@ void PlatformView::Impl::handlePaint()
     {
         if (!nvgBackingLayer_) return;
         auto pBackingLayer = nvgBackingLayer_.get();
-        NVGpaint img = nvgImagePattern(nvg_, 0, 0, w, h, 0, pBackingLayer->_buf->image, 1.0f);
+        NVGpaint img = drawableImagePattern(nvg_, *pBackingLayer);
 
         drawToImage(pBackingLayer);
         nvgBeginFrame(nvg_, w, h, 1.0f);
         appView_->render(nvg_);
         nvgEndFrame(nvg_);
 
+        ML_PROFILE_SCOPE("present");
         drawToImage(nullptr);
         glViewport(0, 0, w, h);
         glClearColor(0.f, 0.f, 0.f, 0.f);
@@ -897,6 +910,7 @@ void PlatformView::Impl::handlePaint()
     ValidateRect(windowHandle_, NULL);
 
     swapBuffers();
+    appView_->framePresented();
 
     return;
 }
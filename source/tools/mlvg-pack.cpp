@@ -0,0 +1,145 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+// mlvg-pack: make a ResourcePack from a list of files. Run by the
+// create_resource_pack() CMake function at build time.
+//
+// usage: mlvg-pack [--compress] [--output <file.mlrp>] [--embed <file.c>] <input files>
+//
+// --compress: compress each entry with zlib, where that saves at least 10%.
+// --output: write the pack as a binary file, to be memory-mapped at runtime.
+// --embed: write the pack as a C++ source file defining resources::pack and
+//   resources::pack_size, to be compiled into the binary.
+//
+// Each entry is named by its input's file name without the extension, so
+// "resources/vignette.jpg" is found as "vignette".
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "MLResourcePack.h"
+
+using namespace ml;
+
+namespace {
+
+bool readFile(const std::string& path, std::vector< uint8_t >& data)
+{
+  FILE* f = fopen(path.c_str(), "rb");
+  if(!f) return false;
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  data.resize(size_t(std::max(size, 0L)));
+  bool ok = (size >= 0) && (fread(data.data(), 1, data.size(), f) == data.size());
+  fclose(f);
+  return ok;
+}
+
+std::string entryName(const std::string& path)
+{
+  size_t slash = path.find_last_of("/\\");
+  std::string name = (slash == std::string::npos) ? path : path.substr(slash + 1);
+  size_t dot = name.find_last_of('.');
+  return (dot == std::string::npos || dot == 0) ? name : name.substr(0, dot);
+}
+
+bool writeBinary(const std::string& path, const std::vector< uint8_t >& pack)
+{
+  FILE* f = fopen(path.c_str(), "wb");
+  if(!f) return false;
+  bool ok = fwrite(pack.data(), 1, pack.size(), f) == pack.size();
+  return (fclose(f) == 0) && ok;
+}
+
+// write the pack as one array. The text is made in a buffer with a lookup table,
+// which is much faster than the string operations CMake would need for the same job.
+bool writeEmbedded(const std::string& path, const std::vector< uint8_t >& pack)
+{
+  static const char* kHex = "0123456789abcdef";
+  constexpr size_t kBytesPerLine{32};
+
+  std::string text;
+  text.reserve(pack.size()*5 + 256);
+  text += "// generated by mlvg-pack. Do not edit.\n\n";
+  text += "namespace resources\n{\n";
+  text += "alignas(16) const unsigned char pack[] = {\n";
+  for(size_t i = 0; i < pack.size(); ++i)
+  {
+    uint8_t b = pack[i];
+    text += '0';
+    text += 'x';
+    text += kHex[b >> 4];
+    text += kHex[b & 15];
+    text += ',';
+    if((i % kBytesPerLine) == kBytesPerLine - 1) text += '\n';
+  }
+  text += "};\nconst unsigned pack_size = sizeof(pack);\n}\n";
+
+  std::vector< uint8_t > bytes(text.begin(), text.end());
+  return writeBinary(path, bytes);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  bool compress{false};
+  std::string outputPath, embedPath;
+  std::vector< ResourcePack::Input > inputs;
+  std::set< std::string > names;
+
+  for(int i = 1; i < argc; ++i)
+  {
+    std::string arg(argv[i]);
+    if(arg == "--compress")
+    {
+      compress = true;
+    }
+    else if((arg == "--output" || arg == "--embed") && (i + 1 < argc))
+    {
+      ((arg == "--output") ? outputPath : embedPath) = argv[++i];
+    }
+    else
+    {
+      ResourcePack::Input in;
+      in.name = entryName(arg);
+      if(!names.insert(in.name).second)
+      {
+        fprintf(stderr, "mlvg-pack: more than one input is named %s\n", in.name.c_str());
+        return 1;
+      }
+      if(!readFile(arg, in.data))
+      {
+        fprintf(stderr, "mlvg-pack: could not read %s\n", arg.c_str());
+        return 1;
+      }
+      inputs.push_back(std::move(in));
+    }
+  }
+
+  if(outputPath.empty() && embedPath.empty())
+  {
+    fprintf(stderr, "usage: mlvg-pack [--compress] [--output <file.mlrp>] [--embed <file.c>] <input files>\n");
+    return 1;
+  }
+
+  auto pack = ResourcePack::build(inputs, compress);
+  if(!outputPath.empty() && !writeBinary(outputPath, pack))
+  {
+    fprintf(stderr, "mlvg-pack: could not write %s\n", outputPath.c_str());
+    return 1;
+  }
+  if(!embedPath.empty() && !writeEmbedded(embedPath, pack))
+  {
+    fprintf(stderr, "mlvg-pack: could not write %s\n", embedPath.c_str());
+    return 1;
+  }
+  return 0;
+}
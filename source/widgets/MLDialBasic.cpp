@@ -86,6 +86,7 @@ void DialBasic::setupParams()
     }
   }
   
+  _font.setName(Path(getTextPropertyWithDefault("font", "d_din")));
   Widget::setupParams();
 }
 
@@ -251,6 +252,28 @@ MessageList DialBasic::animate(int elapsedTimeInMs, ml::DrawContext dc)
   return r;
 }
 
+// the indicator angle in whole pixels of travel at the outline radius, and
+// the number shown. Host automation that moves the value by less than a pixel
+// and doesn't change the number doesn't redraw the dial.
+uint64_t DialBasic::getVisibleState(const ml::DrawContext& dc)
+{
+  Path paramName{getTextProperty("param")};
+  bool enabled = getBoolPropertyWithDefault("enabled", true);
+  float normalizedValue = enabled ? _params.getNormalizedFloatValue(paramName) : 0.f;
+  float a0 = getFloatPropertyWithDefault("a0", kTwoPi*0.375f);
+  float a1 = getFloatPropertyWithDefault("a1", kTwoPi);
+  float r1 = dc.coords.gridSizeInPixels*getFloatPropertyWithDefault("size", 1.0f)*0.85f;
+  
+  uint64_t h = combineVisibleState(kVisibleStateSeed, enabled);
+  h = combineVisibleState(h, uint64_t(int64_t(std::lround(lerp(a0, a1, normalizedValue)*r1))));
+  if(enabled && getBoolPropertyWithDefault("draw_number", true))
+  {
+    float plainValue = _params.getRealFloatValue(paramName);
+    h = combineVisibleState(h, textUtils::formatNumber(plainValue, 2, 2, false).getText());
+  }
+  return h;
+}
+
 void DialBasic::draw(ml::DrawContext dc)
 {
   // get parameter value
@@ -434,8 +457,7 @@ void DialBasic::draw(ml::DrawContext dc)
       TextFragment numText;
       numText = textUtils::formatNumber(currentPlainValue, digits, precision, doSign);
       
-      auto fontFace = getTextPropertyWithDefault("font", "d_din");
-      auto font = getFontResource(dc, Path(fontFace));
+      auto font = _font.get(dc);
       if(font)
       {
         nvgFontFaceId(nvg, font->handle);
@@ -23,6 +23,7 @@ class DialBasic : public Widget
   bool _doEndScroll{false};
   std::vector< float > _normDetents;
   Vec2 _clickAndHoldStartPosition;
+  ResourceHandle< FontResource > _font;
 
 public:
   DialBasic(WithValues p) : Widget(p) {}
@@ -33,4 +34,5 @@ public:
   MessageList processGUIEvent(const GUICoordinates& gc, GUIEvent e) override;
   MessageList animate(int elapsedTimeInMs, ml::DrawContext dc) override;
   void draw(ml::DrawContext d) override;
+  uint64_t getVisibleState(const ml::DrawContext& d) override;
 };
@@ -10,6 +10,12 @@
 
 using namespace ml;
 
+void DrawableImageView::setupParams()
+{
+    _image.setName(Path(getTextProperty("image_name")));
+    Widget::setupParams();
+}
+
 MessageList DrawableImageView::animate(int elapsedTimeInMs, ml::DrawContext dc)
 {
     MessageList r;
@@ -85,7 +91,7 @@ void DrawableImageView::draw(ml::DrawContext dc)
 {
     NativeDrawContext* nvg = getNativeContext(dc);
     Rect bounds = getLocalBounds(dc, *this);
-    auto pImage = getDrawableImage(dc, Path(getTextProperty("image_name")));
+    auto pImage = _image.get(dc);
 
     if (pImage)
     {
@@ -18,6 +18,7 @@ using namespace ml;
 class DrawableImageView : public Widget
 {
 	bool _initialized{ false };
+	ResourceHandle< DrawableImage > _image;
 
 public:
 	DrawableImageView(WithValues p) : Widget(p)
@@ -26,6 +27,7 @@ public:
 	}
 
 	// Widget implementation
+	void setupParams() override;
 	MessageList animate(int elapsedTimeInMs, ml::DrawContext dc) override;
 	void draw(ml::DrawContext d) override;
 	virtual MessageList processGUIEvent(const GUICoordinates& gc, GUIEvent e) override { return MessageList(); }
@@ -25,4 +25,8 @@ void Panel::draw(ml::DrawContext dc)
   }
 }
 
-
+Rect Panel::getOpaqueBounds() const
+{
+  bool opaque = getBoolPropertyWithDefault("enabled", true) && getBoolPropertyWithDefault("opaque_bg", false);
+  return opaque ? getBounds() : Rect();
+}
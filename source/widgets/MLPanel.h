@@ -9,6 +9,13 @@
 
 using namespace ml;
 
+// A filled rectangle.
+//
+// properties:
+// color: the fill color. (panel_bg from the drawing properties)
+// enabled: if false, nothing is drawn. (true)
+// opaque_bg: the fill color is opaque, so Widgets behind the panel and the
+// View's background under it need not be drawn. (false)
 class Panel : public Widget
 {  
 public:
@@ -16,5 +23,6 @@ public:
 
   // Widget implementation
   void draw(ml::DrawContext d) override;
+  Rect getOpaqueBounds() const override;
 
 };
@@ -0,0 +1,82 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+#include <sstream>
+
+#include "MLRenderStatsView.h"
+
+using namespace ml;
+
+void RenderStatsView::setupParams()
+{
+  _font.setName(Path(getTextPropertyWithDefault("font", "d_din")));
+  Widget::setupParams();
+}
+
+void RenderStatsView::receiveNamedRawPointer(Path name, void* ptr)
+{
+  if(name == "render_stats")
+  {
+    _pReport = static_cast< const RenderStatsReport* >(ptr);
+  }
+}
+
+MessageList RenderStatsView::animate(int elapsedTimeInMs, DrawContext dc)
+{
+  // stats change every frame.
+  if(_pReport)
+  {
+    _dirty = true;
+  }
+  return MessageList{};
+}
+
+void RenderStatsView::draw(ml::DrawContext dc)
+{
+  NativeDrawContext* nvg = getNativeContext(dc);
+  Rect bounds = getLocalBounds(dc, *this);
+  int gridSizeInPixels = dc.coords.gridSizeInPixels;
+
+  auto font = _font.get(dc);
+  if(!font || !_pReport) return;
+
+  size_t maxWidgets = getFloatPropertyWithDefault("max_widgets", 8);
+  float textSize = gridSizeInPixels*getFloatPropertyWithDefault("text_size", 0.2f);
+  float lineHeight = textSize*1.2f;
+
+  nvgBeginPath(nvg);
+  nvgRect(nvg, bounds);
+  nvgFillColor(nvg, getColorPropertyWithDefault("color", rgba(0, 0, 0, 0.75)));
+  nvgFill(nvg);
+
+  nvgFontFaceId(nvg, font->handle);
+  nvgFontSize(nvg, textSize);
+  nvgFillColor(nvg, getColorPropertyWithDefault("text_color", rgba(1, 1, 1, 1)));
+
+  Vec2 textPos(bounds.left() + textSize*0.5f, bounds.top() + lineHeight*0.5f);
+  auto drawLine = [&](const RenderStats& s, TextFragment name)
+  {
+    std::ostringstream line;
+    line << s.drawCalls() << " calls, " << s.vertices << " verts, " << size_t(s.pixelsCovered) << " px";
+    if(s.textureCreates || s.textureUpdates)
+    {
+      line << ", tex " << s.textureCreates << "/" << s.textureUpdates;
+    }
+    if(s.widgetsOccluded)
+    {
+      line << ", " << s.widgetsOccluded << " occluded";
+    }
+    drawText(nvg, textPos, TextFragment(name, ": ", TextFragment(line.str().c_str())));
+    textPos += Vec2(0, lineHeight);
+  };
+
+  drawLine(_pReport->frame, "frame");
+  size_t n = std::min(_pReport->widgets.size(), maxWidgets);
+  for(size_t i = 0; i < n; ++i)
+  {
+    const auto& ws = _pReport->widgets[i];
+    drawLine(ws.second, pathToText(ws.first));
+  }
+}
@@ -0,0 +1,29 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+#pragma once
+
+#include "MLWidget.h"
+
+using namespace ml;
+
+// A debugging overlay that shows the RenderStatsReport of an AppView:
+// totals for the last frame and the costliest Widgets. The AppView must send
+// a pointer to its report with receiveNamedRawPointer("render_stats", ptr).
+class RenderStatsView : public Widget
+{
+public:
+  RenderStatsView(WithValues p) : Widget(p) {}
+
+  // Widget implementation
+  void setupParams() override;
+  void receiveNamedRawPointer(Path name, void* ptr) override;
+  MessageList animate(int elapsedTimeInMs, DrawContext dc) override;
+  void draw(ml::DrawContext d) override;
+
+private:
+  const RenderStatsReport* _pReport{nullptr};
+  ResourceHandle< FontResource > _font;
+};
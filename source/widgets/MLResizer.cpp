@@ -26,8 +26,8 @@ MessageList Resizer::processGUIEvent(const GUICoordinates& gc, GUIEvent e)
     _dragStart = eventScreenPos;
     _dragDelta = Vec2(0, 0);
 
-    // this ValueChange does nothing but indicate that we got the event
-    reqList.push_back({"ack"});
+    // show a scaled preview while dragging, instead of laying out every step.
+    reqList.push_back({"do/begin_live_resize"});
   }
   else if(type == "drag")
   {
@@ -67,8 +67,7 @@ MessageList Resizer::processGUIEvent(const GUICoordinates& gc, GUIEvent e)
   else if(type == "up")
   {
     engaged = false;
-    // this ValueChange does nothing but indicate that we got the event
-    reqList.push_back({"ack"});
+    reqList.push_back({"do/end_live_resize"});
   }
   
   if(wasEngaged != engaged) _dirty = true;
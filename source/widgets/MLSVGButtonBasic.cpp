@@ -7,6 +7,12 @@
 
 using namespace ml;
 
+void SVGButtonBasic::setupParams()
+{
+  _image.setName(Path(getTextProperty("image")));
+  Widget::setupParams();
+}
+
 MessageList SVGButtonBasic::processGUIEvent(const GUICoordinates& gc, GUIEvent e)
 {
   MessageList r{};
@@ -73,7 +79,7 @@ void SVGButtonBasic::draw(ml::DrawContext dc)
   nvgSave(nvg);
   if(opacity < 1.0f) { nvgGlobalAlpha(nvg, opacity); }
   
-  auto image = getVectorImage(dc, getTextProperty("image"));
+  auto image = _image.get(dc);
   
   if(image)
   {
@@ -99,7 +105,7 @@ void SVGButtonBasic::draw(ml::DrawContext dc)
   }
   else
   {
-    auto font = getFontResource(dc, "d_din");
+    auto font = _font.get(dc);
     if(!font) return;
     float textSize = gridSizeInPixels*0.5f;
     nvgFontFaceId(nvg, font->handle);
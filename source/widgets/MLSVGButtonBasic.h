@@ -13,12 +13,14 @@ class SVGButtonBasic : public Widget
 {
   bool _down{false};
   bool _initialized{false};
-  NSVGimage* _image{nullptr};
+  ResourceHandle< VectorImage > _image;
+  ResourceHandle< FontResource > _font{Path("d_din")};
   
 public:
   SVGButtonBasic(WithValues p) : Widget(p) {}
 
   // Widget implementation
+  void setupParams() override;
   MessageList processGUIEvent(const GUICoordinates& gc, GUIEvent e) override;
   void draw(ml::DrawContext d) override;
 
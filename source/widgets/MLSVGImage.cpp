@@ -10,11 +10,17 @@
 
 using namespace ml;
 
+void SVGImage::setupParams()
+{
+  _image.setName(Path(getTextProperty("image_name")));
+  Widget::setupParams();
+}
+
 void SVGImage::draw(ml::DrawContext dc)
 {
   NativeDrawContext* nvg = getNativeContext(dc);
   Rect bounds = getLocalBounds(dc, *this);
-  auto image = getVectorImage(dc, Path(getTextProperty("image_name")));
+  auto image = _image.get(dc);
      
   if(image)
   {
@@ -41,4 +47,8 @@ void SVGImage::draw(ml::DrawContext dc)
     }
     nvgRestore(nvg);
   }
+  else
+  {
+    drawMissingResource(dc, bounds, _image.getName());
+  }
 }
@@ -24,6 +24,10 @@ public:
   SVGImage(WithValues p) : Widget(p) {}
 
   // Widget implementation
+  void setupParams() override;
   void draw(ml::DrawContext d) override;
   virtual MessageList processGUIEvent(const GUICoordinates& gc, GUIEvent e) override {return MessageList();}
+
+private:
+  ResourceHandle< VectorImage > _image;
 };
@@ -0,0 +1,141 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+#include "MLSignalView.h"
+
+using namespace ml;
+
+void SignalView::processPublishedSignal(Value sigVal, Symbol sigType)
+{
+  // the value is a Matrix with one row of frames per channel.
+  Matrix m = sigVal.getMatrixValue();
+  size_t frames = m.getWidth();
+  size_t channels = m.getHeight();
+  if(!frames || !channels) return;
+
+  if(!_summary || (_summary->getNumChannels() != channels))
+  {
+    size_t history = getFloatPropertyWithDefault("history", 65536);
+    _summary = ml::make_unique< SignalSummary >(channels, history);
+  }
+  _summary->write(m.getConstBuffer(), frames);
+  _newData = true;
+}
+
+uint64_t SignalView::_readColumns(const DrawContext& dc)
+{
+  Rect bounds = getLocalBounds(dc, *this);
+  size_t channel = getFloatPropertyWithDefault("channel", 0);
+  double samplesShown = getFloatPropertyWithDefault("samples_shown", 2048);
+  size_t nColumns = std::max(int(bounds.width()), 1);
+  _columns.resize(nColumns);
+  if(!_summary->getRecentColumns(channel, samplesShown, nColumns, _columns.data()))
+  {
+    _columns.clear();
+    return 0;
+  }
+
+  bool showRms = getBoolPropertyWithDefault("show_rms", false);
+  float yScale = bounds.height()*0.5f;
+  auto toPixels = [&](float v) { return uint64_t(int64_t(std::lround(v*yScale))); };
+  uint64_t h = combineVisibleState(kVisibleStateSeed, nColumns);
+  for(const auto& col : _columns)
+  {
+    h = combineVisibleState(h, col.valid);
+    if(!col.valid) continue;
+    h = combineVisibleState(h, toPixels(col.min));
+    h = combineVisibleState(h, toPixels(col.max));
+    if(showRms)
+    {
+      h = combineVisibleState(h, toPixels(col.rms));
+    }
+  }
+  return h;
+}
+
+MessageList SignalView::animate(int elapsedTimeInMs, DrawContext dc)
+{
+  // read the columns when there is new data, or when something else will
+  // redraw us, such as a new size or property.
+  if(_summary && (_newData || _dirty))
+  {
+    _newData = false;
+    uint64_t state = _readColumns(dc);
+    if(state != _columnsState)
+    {
+      _columnsState = state;
+      _dirty = true;
+    }
+  }
+  return MessageList{};
+}
+
+void SignalView::resize(DrawContext dc)
+{
+  // a full redraw may follow a resize before the next animate(), so read the
+  // columns at the new size now.
+  if(_summary)
+  {
+    _columnsState = _readColumns(dc);
+  }
+}
+
+void SignalView::draw(ml::DrawContext dc)
+{
+  NativeDrawContext* nvg = getNativeContext(dc);
+  Rect bounds = getLocalBounds(dc, *this);
+  if(!_summary || _columns.empty()) return;
+
+  size_t nColumns = _columns.size();
+  float yCenter = bounds.center().y();
+  float yScale = -bounds.height()*0.5f;
+  float columnWidth = bounds.width()/nColumns;
+
+  // fill the min / max band: along the tops of the valid columns, then back
+  // along the bottoms.
+  auto drawBand = [&](NVGcolor color, float (*top)(const SignalSummary::Column&),
+                      float (*bottom)(const SignalSummary::Column&))
+  {
+    nvgBeginPath(nvg);
+    bool started{false};
+    for(size_t i = 0; i < nColumns; ++i)
+    {
+      const auto& col = _columns[i];
+      if(!col.valid) continue;
+      float x = bounds.left() + (i + 0.5f)*columnWidth;
+      float y = yCenter + top(col)*yScale;
+      if(!started)
+      {
+        nvgMoveTo(nvg, x, y);
+        started = true;
+      }
+      else
+      {
+        nvgLineTo(nvg, x, y);
+      }
+    }
+    for(size_t i = nColumns; i-- > 0; )
+    {
+      const auto& col = _columns[i];
+      if(!col.valid) continue;
+      float x = bounds.left() + (i + 0.5f)*columnWidth;
+      nvgLineTo(nvg, x, yCenter + bottom(col)*yScale);
+    }
+    nvgClosePath(nvg);
+    nvgFillColor(nvg, color);
+    nvgFill(nvg);
+  };
+
+  drawBand(getColorPropertyWithDefault("color", rgba(1, 1, 1, 1)),
+           [](const SignalSummary::Column& c) { return c.max; },
+           [](const SignalSummary::Column& c) { return c.min; });
+
+  if(getBoolPropertyWithDefault("show_rms", false))
+  {
+    drawBand(getColorPropertyWithDefault("rms_color", rgba(1, 1, 1, 0.5)),
+             [](const SignalSummary::Column& c) { return c.rms; },
+             [](const SignalSummary::Column& c) { return -c.rms; });
+  }
+}
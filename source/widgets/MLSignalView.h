@@ -0,0 +1,48 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "MLWidget.h"
+#include "MLSignalSummary.h"
+
+using namespace ml;
+
+// A scope / waveform view of a published signal. Incoming frames are added to
+// a SignalSummary, and each frame the view draws one min / max column per pixel
+// of its width over the most recent "samples_shown" samples, so the drawing cost
+// does not depend on how many samples are shown. The columns are read in
+// animate(), and the view is only redrawn if they move by a whole pixel.
+//
+// properties:
+// signal_name: the published signal to view.
+// samples_shown: the length of the visible range in samples. (2048)
+// history: the length of the summary's history in samples. (65536)
+// channel: the channel to draw. (0)
+// show_rms: if true, the RMS is drawn over the min / max band. (false)
+class SignalView : public Widget
+{
+public:
+  SignalView(WithValues p) : Widget(p) {}
+
+  // Widget implementation
+  void processPublishedSignal(Value sigVal, Symbol sigType) override;
+  MessageList animate(int elapsedTimeInMs, DrawContext dc) override;
+  void resize(DrawContext dc) override;
+  void draw(ml::DrawContext d) override;
+
+private:
+  // read the columns to draw at the current size, and return a hash of their
+  // pixel positions.
+  uint64_t _readColumns(const DrawContext& dc);
+
+  std::unique_ptr< SignalSummary > _summary;
+  std::vector< SignalSummary::Column > _columns;
+  uint64_t _columnsState{0};
+  bool _newData{false};
+};
@@ -0,0 +1,139 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+#include "MLSpectrogramView.h"
+
+using namespace ml;
+
+namespace {
+
+uint8_t toByte(float f) { return uint8_t(ml::clamp(f, 0.f, 1.f)*255.f + 0.5f); }
+
+} // namespace
+
+void SpectrogramView::processPublishedSignal(Value sigVal, Symbol sigType)
+{
+  Matrix m = sigVal.getMatrixValue();
+  size_t bins = m.getWidth();
+  size_t frames = m.getHeight();
+  if(!bins || !frames) return;
+
+  if(bins != _bins)
+  {
+    _pendingFrames.clear();
+    _bins = bins;
+  }
+  _pendingFrames.insert(_pendingFrames.end(), m.getConstBuffer(), m.getConstBuffer() + bins*frames);
+
+  // animate() may not run for a while, for example when the Widget is off
+  // screen. Only a history of frames can be shown, so drop any older ones.
+  size_t history = _image ? _image->getWidth() : size_t(getFloatPropertyWithDefault("history", 512));
+  size_t maxFloats = std::max(history, size_t(1))*_bins;
+  if(_pendingFrames.size() > maxFloats)
+  {
+    _pendingFrames.erase(_pendingFrames.begin(), _pendingFrames.end() - maxFloats);
+  }
+}
+
+MessageList SpectrogramView::animate(int elapsedTimeInMs, DrawContext dc)
+{
+  if(!_bins || _pendingFrames.empty()) return MessageList{};
+
+  if(!_image)
+  {
+    // the image repeats in x, so the ring can be drawn with one pattern.
+    int history = getFloatPropertyWithDefault("history", 512);
+    int imageHeight = getFloatPropertyWithDefault("image_height", 256);
+    _image = ml::make_unique< StreamingRasterImage >(getNativeContext(dc), history, imageHeight, NVG_IMAGE_REPEATX);
+    _writeColumn = 0;
+  }
+  int width = _image->getWidth();
+  int rows = _image->getHeight();
+
+  float nyquist = getFloatPropertyWithDefault("sample_rate", 48000.f)*0.5f;
+  float minFreq = ml::clamp(getFloatPropertyWithDefault("min_freq", 20.f), 1.f, nyquist*0.5f);
+  float minDb = getFloatPropertyWithDefault("min_db", -96.f);
+  float maxDb = getFloatPropertyWithDefault("max_db", 0.f);
+  float dbRange = std::max(maxDb - minDb, 1.f);
+  NVGcolor color = getColorPropertyWithDefault("color", rgba(1, 1, 1, 1));
+  NVGcolor background = getColorPropertyWithDefault("background", rgba(0, 0, 0, 1));
+
+  // the range of bins shown by each row of the image, counting up from the bottom.
+  float octaves = std::log2(nyquist/minFreq);
+  auto binAtRow = [&](float row)
+  {
+    float f = minFreq*std::pow(2.f, octaves*row/rows);
+    return f/nyquist*_bins;
+  };
+  _rowBins.resize(rows);
+  for(int row = 0; row < rows; ++row)
+  {
+    size_t b0 = std::min(size_t(binAtRow(row)), _bins - 1);
+    size_t b1 = std::min(std::max(size_t(binAtRow(row + 1)), b0 + 1), _bins);
+    _rowBins[row] = std::make_pair(b0, b1);
+  }
+
+  // if more frames arrived than fit in the image, skip the oldest.
+  int frames = _pendingFrames.size()/_bins;
+  int newColumns = std::min(frames, width);
+  const float* pFirst = _pendingFrames.data() + (frames - newColumns)*_bins;
+
+  // write each new frame into a column of pixels, wrapping around the ring.
+  uint8_t* pPixels = _image->getPixels();
+  size_t bytesPerRow = _image->getBytesPerRow();
+  for(int c = 0; c < newColumns; ++c)
+  {
+    const float* pFrame = pFirst + c*_bins;
+    int x = (_writeColumn + c) % width;
+    for(int row = 0; row < rows; ++row)
+    {
+      float mag{0.f};
+      for(size_t b = _rowBins[row].first; b < _rowBins[row].second; ++b)
+      {
+        mag = std::max(mag, pFrame[b]);
+      }
+      float db = 20.f*std::log10(std::max(mag, 1e-9f));
+      float amount = ml::clamp((db - minDb)/dbRange, 0.f, 1.f);
+      NVGcolor pixelColor = lerp(background, color, amount);
+
+      uint8_t* p = pPixels + (rows - 1 - row)*bytesPerRow + x*4;
+      p[0] = toByte(pixelColor.r);
+      p[1] = toByte(pixelColor.g);
+      p[2] = toByte(pixelColor.b);
+      p[3] = toByte(pixelColor.a);
+    }
+  }
+
+  // mark the new columns, in at most two runs, and send them to the texture.
+  int firstRun = std::min(newColumns, width - _writeColumn);
+  _image->setDirty(Rect(_writeColumn, 0, firstRun, rows));
+  if(newColumns > firstRun)
+  {
+    _image->setDirty(Rect(0, 0, newColumns - firstRun, rows));
+  }
+  _writeColumn = (_writeColumn + newColumns) % width;
+  _image->publish();
+  _image->upload();
+
+  _pendingFrames.clear();
+  _dirty = true;
+  return MessageList{};
+}
+
+void SpectrogramView::draw(ml::DrawContext dc)
+{
+  NativeDrawContext* nvg = getNativeContext(dc);
+  Rect bounds = getLocalBounds(dc, *this);
+  if(!_image) return;
+
+  // one pattern, offset so that the oldest column is at the left edge.
+  float xScale = bounds.width()/_image->getWidth();
+  NVGpaint p = nvgImagePattern(nvg, bounds.left() - _writeColumn*xScale, bounds.top(), bounds.width(), bounds.height(),
+                               0, _image->getHandle(), 1.0f);
+  nvgBeginPath(nvg);
+  nvgRect(nvg, bounds);
+  nvgFillPaint(nvg, p);
+  nvgFill(nvg);
+}
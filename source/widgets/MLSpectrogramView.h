@@ -0,0 +1,55 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "MLWidget.h"
+
+using namespace ml;
+
+// A scrolling spectrogram of the magnitude frames of a published spectrum.
+// The signal value is a Matrix with one frame per row, oldest first. Each frame
+// is written as one column of pixels into a StreamingRasterImage used as a ring,
+// and only the new columns are uploaded to the texture, so each animation frame
+// costs the same however long the history is. The whole image is drawn as one
+// image fill.
+//
+// properties:
+// history: the number of frames shown. (512)
+// image_height: the height of the image in pixels. (256)
+// sample_rate: the sample rate of the analyzed signal. (48000)
+// min_freq: the frequency at the bottom edge in Hz. (20)
+// min_db: the magnitude drawn as the background color in dB. (-96)
+// max_db: the magnitude drawn as the full color in dB. (0)
+// color: the color of full magnitude.
+// background: the color of silence.
+class SpectrogramView : public Widget
+{
+public:
+  SpectrogramView(WithValues p) : Widget(p) {}
+
+  // Widget implementation
+  void processPublishedSignal(Value sigVal, Symbol sigType) override;
+  MessageList animate(int elapsedTimeInMs, DrawContext dc) override;
+  void draw(ml::DrawContext d) override;
+
+private:
+  std::unique_ptr< StreamingRasterImage > _image;
+
+  // the next column of the image to be written.
+  int _writeColumn{0};
+
+  // the first and last + 1 bins shown by each row, counting up from the bottom.
+  std::vector< std::pair< size_t, size_t > > _rowBins;
+
+  // frames received since the last animate(), one after another, up to the
+  // width of the image.
+  std::vector< float > _pendingFrames;
+  size_t _bins{0};
+};
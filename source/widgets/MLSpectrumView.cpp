@@ -0,0 +1,109 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+#include "MLSpectrumView.h"
+
+using namespace ml;
+
+void SpectrumView::processPublishedSignal(Value sigVal, Symbol sigType)
+{
+  // keep the newest frame.
+  Matrix m = sigVal.getMatrixValue();
+  size_t bins = m.getWidth();
+  size_t frames = m.getHeight();
+  if(!bins || !frames) return;
+
+  const float* pNewest = m.getConstBuffer() + (frames - 1)*bins;
+  _magnitudes.assign(pNewest, pNewest + bins);
+  _newData = true;
+}
+
+uint64_t SpectrumView::_makeCurve(const DrawContext& dc)
+{
+  Rect bounds = getLocalBounds(dc, *this);
+  size_t bins = _magnitudes.size();
+  _curve.clear();
+  if(!bins) return 0;
+
+  float nyquist = getFloatPropertyWithDefault("sample_rate", 48000.f)*0.5f;
+  float minFreq = ml::clamp(getFloatPropertyWithDefault("min_freq", 20.f), 1.f, nyquist*0.5f);
+  float minDb = getFloatPropertyWithDefault("min_db", -96.f);
+  float maxDb = getFloatPropertyWithDefault("max_db", 0.f);
+  float dbRange = std::max(maxDb - minDb, 1.f);
+
+  // the bin, as a float, at a horizontal position.
+  float octaves = std::log2(nyquist/minFreq);
+  auto binAtX = [&](float x)
+  {
+    float f = minFreq*std::pow(2.f, octaves*x/bounds.width());
+    return f/nyquist*bins;
+  };
+
+  // one point per pixel column, at the largest magnitude of the bins it covers.
+  int nColumns = std::max(int(bounds.width()), 1);
+  uint64_t h = combineVisibleState(kVisibleStateSeed, uint64_t(nColumns));
+  for(int i = 0; i < nColumns; ++i)
+  {
+    size_t b0 = std::min(size_t(binAtX(i)), bins - 1);
+    size_t b1 = std::min(std::max(size_t(binAtX(i + 1)), b0 + 1), bins);
+    float mag{0.f};
+    for(size_t b = b0; b < b1; ++b)
+    {
+      mag = std::max(mag, _magnitudes[b]);
+    }
+
+    float db = 20.f*std::log10(std::max(mag, 1e-9f));
+    float y = bounds.bottom() - ml::clamp((db - minDb)/dbRange, 0.f, 1.f)*bounds.height();
+    _curve.push_back(y);
+    h = combineVisibleState(h, uint64_t(int64_t(std::lround(y))));
+  }
+  return h;
+}
+
+MessageList SpectrumView::animate(int elapsedTimeInMs, DrawContext dc)
+{
+  // make the curve when there is new data, or when something else will
+  // redraw us, such as a new size or property.
+  if(_newData || _dirty)
+  {
+    _newData = false;
+    uint64_t state = _makeCurve(dc);
+    if(state != _curveState)
+    {
+      _curveState = state;
+      _dirty = true;
+    }
+  }
+  return MessageList{};
+}
+
+void SpectrumView::draw(ml::DrawContext dc)
+{
+  NativeDrawContext* nvg = getNativeContext(dc);
+  Rect bounds = getLocalBounds(dc, *this);
+  if(_curve.empty()) return;
+
+  int gridSizeInPixels = dc.coords.gridSizeInPixels;
+  float strokeWidthMul = getFloatPropertyWithDefault("stroke_width", getFloat(dc, "common_stroke_width"));
+  float strokeWidth = gridSizeInPixels*strokeWidthMul;
+
+  nvgBeginPath(nvg);
+  for(size_t i = 0; i < _curve.size(); ++i)
+  {
+    float x = bounds.left() + i + 0.5f;
+    float y = _curve[i];
+    if(i == 0)
+    {
+      nvgMoveTo(nvg, x, y);
+    }
+    else
+    {
+      nvgLineTo(nvg, x, y);
+    }
+  }
+  nvgStrokeWidth(nvg, strokeWidth);
+  nvgStrokeColor(nvg, getColorPropertyWithDefault("color", rgba(1, 1, 1, 1)));
+  nvgStroke(nvg);
+}
@@ -0,0 +1,46 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+#pragma once
+
+#include <vector>
+
+#include "MLWidget.h"
+
+using namespace ml;
+
+// A view of the magnitude frames of a published spectrum, made by a
+// SpectrumAnalyzer. The signal value is a Matrix with one frame per row, oldest
+// first; only the newest frame is drawn. Frequency is drawn on a log scale and
+// magnitude in dB. The curve is made in animate(), and the view is only
+// redrawn if it moves by a whole pixel.
+//
+// properties:
+// sample_rate: the sample rate of the analyzed signal. (48000)
+// min_freq: the frequency at the left edge in Hz. (20)
+// min_db: the magnitude at the bottom edge in dB. (-96)
+// max_db: the magnitude at the top edge in dB. (0)
+// stroke_width: the width of the curve in grid units. (common_stroke_width)
+// color: the color of the curve.
+class SpectrumView : public Widget
+{
+public:
+  SpectrumView(WithValues p) : Widget(p) {}
+
+  // Widget implementation
+  void processPublishedSignal(Value sigVal, Symbol sigType) override;
+  MessageList animate(int elapsedTimeInMs, DrawContext dc) override;
+  void draw(ml::DrawContext d) override;
+
+private:
+  // make the curve for the newest frame at the current size, one point per
+  // pixel column, and return a hash of its pixel positions.
+  uint64_t _makeCurve(const DrawContext& dc);
+
+  std::vector< float > _magnitudes;
+  std::vector< float > _curve;
+  uint64_t _curveState{0};
+  bool _newData{false};
+};
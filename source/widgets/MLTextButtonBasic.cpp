@@ -61,7 +61,7 @@ void TextButtonBasic::draw(ml::DrawContext dc)
   Rect bounds = getLocalBounds(dc, *this);
   int gridSizeInPixels = dc.coords.gridSizeInPixels;
 
-  auto font = getFontResource(dc, "d_din");
+  auto font = _font.get(dc);
   if(!font) return;
 
   float opacity = getFloatPropertyWithDefault("opacity", 1.0f);
@@ -12,6 +12,7 @@ using namespace ml;
 class TextButtonBasic : public Widget
 {
   bool _down{false};
+  ResourceHandle< FontResource > _font{Path("d_din")};
   
 public:
   TextButtonBasic(WithValues p) : Widget(p) {}
@@ -8,16 +8,21 @@
 
 using namespace ml;
 
+void TextLabelBasic::setupParams()
+{
+  _font.setName(Path(getTextPropertyWithDefault("font", "d_din")));
+  Widget::setupParams();
+}
+
 void TextLabelBasic::draw(ml::DrawContext dc)
 {
   NativeDrawContext* nvg = getNativeContext(dc);
   Rect bounds = getLocalBounds(dc, *this);
   int gridSizeInPixels = dc.coords.gridSizeInPixels;
   
-  auto fontFace = getTextPropertyWithDefault("font", "d_din");
   auto text = getTextProperty("text");
   
-  auto font = getFontResource(dc, Path(fontFace));
+  auto font = _font.get(dc);
   if(!font) return;
   
   float textSize = gridSizeInPixels*getFloatPropertyWithDefault("text_size", 0.25f);
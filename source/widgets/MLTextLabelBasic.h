@@ -15,6 +15,10 @@ public:
   TextLabelBasic(WithValues p) : Widget(p) {}
 
   // Widget implementation
+  void setupParams() override;
   MessageList processGUIEvent(const GUICoordinates& gc, GUIEvent e) override { return MessageList(); }
   void draw(ml::DrawContext d) override;
+
+private:
+  ResourceHandle< FontResource > _font;
 };
@@ -0,0 +1,201 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+#include <algorithm>
+#include <cmath>
+
+#include "MLVirtualListView.h"
+
+using namespace ml;
+
+void VirtualListView::setItems(size_t count, MakeRowFn makeRow, BindRowFn bindRow)
+{
+  _makeRow = makeRow;
+  _bindRow = bindRow;
+  _itemCount = count;
+
+  // rows made by the old function may be a different kind of Widget.
+  _rows.clear();
+  _stillDownRow = nullptr;
+  _dirty = true;
+}
+
+void VirtualListView::setItemCount(size_t count)
+{
+  if(count == _itemCount) return;
+  _itemCount = count;
+  for(auto& row : _rows)
+  {
+    row.item = kNoItem;
+  }
+  _dirty = true;
+}
+
+float VirtualListView::_getRowHeight() const
+{
+  return std::max(getFloatPropertyWithDefault("row_height", 0.5f), 0.01f);
+}
+
+float VirtualListView::_getMaxScroll() const
+{
+  float rowsShown = getBounds().height()/_getRowHeight();
+  return std::max(float(_itemCount) - rowsShown, 0.f);
+}
+
+void VirtualListView::_updateRows(DrawContext dc)
+{
+  if(!_makeRow || !_bindRow) return;
+
+  Rect bounds = getBounds();
+  float rowHeight = _getRowHeight();
+
+  // a partial row can show at the top and at the bottom.
+  size_t rowsNeeded = std::min(size_t(std::ceil(bounds.height()/rowHeight)) + 1, _itemCount);
+  if(rowsNeeded != _rows.size())
+  {
+    _rows.clear();
+    _stillDownRow = nullptr;
+    for(size_t i = 0; i < rowsNeeded; ++i)
+    {
+      _rows.push_back(Row{_makeRow(), kNoItem});
+    }
+  }
+  if(_rows.empty()) return;
+
+  float scroll = getFloatPropertyWithDefault("scroll", 0.f);
+  float clampedScroll = ml::clamp(scroll, 0.f, _getMaxScroll());
+  if(clampedScroll != scroll)
+  {
+    setProperty("scroll", clampedScroll);
+    scroll = clampedScroll;
+  }
+
+  size_t first = size_t(scroll);
+  size_t n = _rows.size();
+  for(size_t i = first; i < first + n; ++i)
+  {
+    Row& row = _rows[i % n];
+    if(i >= _itemCount)
+    {
+      row.item = kNoItem;
+      continue;
+    }
+
+    Widget& w = *row.widget;
+    Rect rowBounds(bounds.left(), bounds.top() + (i - scroll)*rowHeight, bounds.width(), rowHeight);
+    Rect oldBounds = w.getBounds();
+    if(rowBounds != oldBounds)
+    {
+      w.setBounds(rowBounds);
+      if((rowBounds.width() != oldBounds.width()) || (rowBounds.height() != oldBounds.height()))
+      {
+        w.resize(dc);
+      }
+      w.setDirty(true);
+    }
+    if(row.item != i)
+    {
+      _bindRow(w, i);
+      row.item = i;
+      w.setDirty(true);
+    }
+  }
+}
+
+Widget* VirtualListView::_findRow(Vec2 p)
+{
+  if(!within(p, getBounds())) return nullptr;
+  Widget* found{nullptr};
+  _forEachVisibleRow([&](Widget& w)
+  {
+    if(within(p, w.getBounds())) found = &w;
+  });
+  return found;
+}
+
+MessageList VirtualListView::processGUIEvent(const GUICoordinates& gc, GUIEvent e)
+{
+  MessageList r{};
+
+  if(e.type == "scroll")
+  {
+    // a positive delta scrolls up, toward the first item.
+    float scroll = getFloatPropertyWithDefault("scroll", 0.f);
+    float speed = getFloatPropertyWithDefault("scroll_speed", 1.f);
+    float newScroll = ml::clamp(scroll - e.delta.y()*speed, 0.f, _getMaxScroll());
+    if(newScroll != scroll)
+    {
+      setProperty("scroll", newScroll);
+      _dirty = true;
+    }
+    return r;
+  }
+
+  // send other events to the row under them, or to the row that got the
+  // last down event until it gets an up.
+  Widget* row = _stillDownRow ? _stillDownRow : _findRow(e.position);
+  if(!row) return r;
+
+  r = row->processGUIEvent(gc, e);
+  if(e.type == "down")
+  {
+    _stillDownRow = r.size() > 0 ? row : nullptr;
+  }
+  else if(e.type == "up")
+  {
+    _stillDownRow = nullptr;
+  }
+
+  if(row->isDirty())
+  {
+    _dirty = true;
+  }
+  return r;
+}
+
+MessageList VirtualListView::animate(int elapsedTimeInMs, DrawContext dc)
+{
+  MessageList r{};
+  _updateRows(dc);
+
+  _forEachVisibleRow([&](Widget& w)
+  {
+    w.updateVisibleState(dc);
+    r.append(w.animate(elapsedTimeInMs, dc));
+    if(w.isDirty())
+    {
+      _dirty = true;
+    }
+  });
+  return r;
+}
+
+void VirtualListView::resize(DrawContext dc)
+{
+  for(auto& row : _rows)
+  {
+    row.widget->resize(dc);
+  }
+}
+
+void VirtualListView::draw(ml::DrawContext dc)
+{
+  NativeDrawContext* nvg = getNativeContext(dc);
+
+  // the context origin is at our top left, and each row is drawn with the
+  // origin at its own top left, as View does for its Widgets.
+  Vec2 origin = getTopLeft(getPixelBounds(dc, *this));
+  _forEachVisibleRow([&](Widget& w)
+  {
+    Rect rowBounds = translate(getPixelBounds(dc, w), -origin);
+    nvgSave(nvg);
+    nvgIntersectScissor(nvg, rowBounds);
+    nvgTranslate(nvg, getTopLeft(rowBounds));
+    w.draw(dc);
+    w.setDirty(false);
+    w._visibleState = w.getVisibleState(dc);
+    nvgRestore(nvg);
+  });
+}
@@ -0,0 +1,89 @@
+// mlvg: GUI library for madronalib apps and plugins
+// Copyright (C) 2019-2022 Madrona Labs LLC
+// This software is provided 'as-is', without any express or implied warranty.
+// See LICENSE.txt for details.
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "MLWidget.h"
+
+using namespace ml;
+
+// A scrolling list of any number of items, like a preset browser or a long
+// list of parameters. Only the rows that are on screen exist: they are made
+// by a MakeRowFn as needed and shown an item by a BindRowFn. When the list
+// scrolls, rows that go off one edge are bound to the items coming on at the
+// other, so drawing, animating and scrolling cost the same for 100 items as
+// for 100,000.
+//
+// The rows are owned by the list, not by the View. Their bounds are in the
+// grid coordinates of the View, like the bounds of the list itself, so they
+// get events in the same coordinates any other Widget would.
+//
+// properties:
+// row_height: the height of each row in grid units. (0.5)
+// scroll: the item at the top of the list. May be fractional. (0)
+// scroll_speed: the rows scrolled by one unit of scroll wheel delta. (1)
+class VirtualListView : public Widget
+{
+public:
+  using MakeRowFn = std::function< std::unique_ptr< Widget >() >;
+  using BindRowFn = std::function< void(Widget& row, size_t item) >;
+
+  VirtualListView(WithValues p) : Widget(p) {}
+
+  // set the number of items and how to make and bind rows for them.
+  void setItems(size_t count, MakeRowFn makeRow, BindRowFn bindRow);
+
+  // change the number of items, rebinding the rows on screen.
+  void setItemCount(size_t count);
+  size_t getItemCount() const { return _itemCount; }
+
+  // the number of row Widgets that exist, which depends only on the height of the list.
+  size_t getNumRows() const { return _rows.size(); }
+
+  // Widget implementation
+  MessageList processGUIEvent(const GUICoordinates& gc, GUIEvent e) override;
+  MessageList animate(int elapsedTimeInMs, DrawContext dc) override;
+  void resize(DrawContext dc) override;
+  void draw(ml::DrawContext d) override;
+
+private:
+  struct Row
+  {
+    std::unique_ptr< Widget > widget;
+
+    // the item shown, or kNoItem.
+    size_t item;
+  };
+  static constexpr size_t kNoItem{~size_t(0)};
+
+  float _getRowHeight() const;
+  float _getMaxScroll() const;
+
+  // make enough rows to fill the list, then bind and place the ones on screen.
+  // the row for item i is always _rows[i % _rows.size()], so scrolling by one
+  // row binds one row.
+  void _updateRows(DrawContext dc);
+
+  // call fn for each row showing an item.
+  template< typename Fn > void _forEachVisibleRow(Fn fn)
+  {
+    for(auto& row : _rows)
+    {
+      if(row.item != kNoItem) fn(*row.widget);
+    }
+  }
+
+  Widget* _findRow(Vec2 p);
+
+  MakeRowFn _makeRow;
+  BindRowFn _bindRow;
+  size_t _itemCount{0};
+  std::vector< Row > _rows;
+  Widget* _stillDownRow{nullptr};
+};
@@ -0,0 +1,92 @@
+#include <cstring>
+#include <sstream>
+
+#include "MLDrawContext.h"
+#include "catch.hpp"
+#include "madronalib.h"
+
+using namespace ml;
+
+namespace {
+
+const char* kTestSVG =
+  "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"40\" height=\"30\">"
+  "<rect x=\"0\" y=\"0\" width=\"40\" height=\"30\" fill=\"#ff0000\"/></svg>";
+
+// vector images need no draw context.
+std::unique_ptr< VectorImage > makeTestImage(bool regenerable, uint32_t lastUsedFrame)
+{
+  auto p = std::make_unique< VectorImage >(nullptr, reinterpret_cast< const unsigned char* >(kTestSVG),
+                                           strlen(kTestSVG) + 1);
+  p->regenerable = regenerable;
+  p->lastUsedFrame = lastUsedFrame;
+  return p;
+}
+
+} // namespace
+
+TEST_CASE("mlvg/drawingresources/usage", "[drawingresources]")
+{
+  DrawingResources resources;
+  resources.vectorImages["a"] = makeTestImage(false, 0);
+  resources.vectorImages["b"] = makeTestImage(true, 0);
+  resources.blobs["c"] = std::make_unique< ResourceBlob >(1000);
+
+  auto usage = resources.getUsage();
+  REQUIRE(usage.vectorImages.count == 2);
+  REQUIRE(usage.vectorImages.size.cpuBytes > 0);
+  REQUIRE(usage.vectorImages.size.gpuBytes == 0);
+  REQUIRE(usage.vectorImages.regenerableBytes == usage.vectorImages.size.cpuBytes/2);
+  REQUIRE(usage.blobs.count == 1);
+  REQUIRE(usage.blobs.size.cpuBytes == 1000);
+  REQUIRE(usage.total().cpuBytes == usage.vectorImages.size.cpuBytes + 1000);
+
+  std::ostringstream dump;
+  resources.dumpResourceUsage(dump);
+  REQUIRE(dump.str().find("vector images: 2") != std::string::npos);
+}
+
+TEST_CASE("mlvg/drawingresources/evict", "[drawingresources]")
+{
+  DrawingResources resources;
+  resources.frame = 100;
+  resources.vectorImages["old"] = makeTestImage(true, 10);
+  resources.vectorImages["older"] = makeTestImage(true, 5);
+  resources.vectorImages["recent"] = makeTestImage(true, 99);
+  resources.vectorImages["kept"] = makeTestImage(false, 0);
+  size_t imageBytes = resources.vectorImages["kept"]->getSize().total();
+
+  // no budget, no eviction.
+  REQUIRE(resources.evictToBudget() == 0);
+
+  // a budget of two images evicts the least recently used one.
+  resources.budgetInBytes = imageBytes*2;
+  uint32_t generation = resources.generation;
+  REQUIRE(resources.evictToBudget() == imageBytes);
+  REQUIRE(!resources.vectorImages["older"]);
+  REQUIRE(resources.vectorImages["old"]);
+  REQUIRE(resources.generation != generation);
+
+  // images used in the last frame and images that are not regenerable are
+  // never evicted, even if over budget.
+  resources.budgetInBytes = 1;
+  REQUIRE(resources.evictToBudget() == imageBytes);
+  REQUIRE(!resources.vectorImages["old"]);
+  REQUIRE(resources.vectorImages["recent"]);
+  REQUIRE(resources.vectorImages["kept"]);
+  REQUIRE(resources.evictToBudget() == 0);
+}
+
+TEST_CASE("mlvg/drawingresources/framebufferpool", "[drawingresources]")
+{
+  // framebuffers are made in whole buckets.
+  REQUIRE(FramebufferPool::bucketSize(0) == FramebufferPool::kBucketSize);
+  REQUIRE(FramebufferPool::bucketSize(FramebufferPool::kBucketSize) == FramebufferPool::kBucketSize);
+  REQUIRE(FramebufferPool::bucketSize(FramebufferPool::kBucketSize + 1) == FramebufferPool::kBucketSize*2);
+
+  FramebufferPool::Stats s;
+  REQUIRE(s.hitRate() == 0.f);
+  s.hits = 3;
+  s.misses = 1;
+  REQUIRE(s.hitRate() == 0.75f);
+}
@@ -0,0 +1,120 @@
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "MLGUIEventQueue.h"
+#include "catch.hpp"
+#include "madronalib.h"
+
+using namespace ml;
+
+TEST_CASE("mlvg/guieventqueue/coalesce", "[guieventqueue]")
+{
+  GUIEventQueue q(16);
+  REQUIRE(q.getCapacity() == 16);
+
+  q.push(GUIEvent{"down", Vec2(1, 1)});
+  for(int i = 0; i < 5; ++i)
+  {
+    q.push(GUIEvent{"drag", Vec2(i, i*2)});
+  }
+  q.push(GUIEvent{"up", Vec2(4, 8)});
+  for(int i = 0; i < 3; ++i)
+  {
+    q.push(GUIEvent{"scroll", Vec2(), Vec2(0, 1)});
+  }
+  REQUIRE(q.elementsAvailable() == 10);
+
+  std::vector< GUIEvent > popped;
+  GUIEvent e;
+  while(q.pop(e))
+  {
+    popped.push_back(e);
+  }
+
+  REQUIRE(popped.size() == 4);
+  REQUIRE(popped[0].type == "down");
+  REQUIRE(popped[1].type == "drag");
+  REQUIRE(popped[1].position == Vec2(4, 8));
+  REQUIRE(popped[2].type == "up");
+  REQUIRE(popped[3].type == "scroll");
+  REQUIRE(popped[3].delta == Vec2(0, 3));
+  REQUIRE(q.getRawEventCount() == 10);
+  REQUIRE(q.getCoalescedEventCount() == 4);
+
+  // coalesced events keep the earliest enqueue time.
+  REQUIRE(popped[1].enqueueTime <= popped[1].dequeueTime);
+
+  // drags with different modifiers are kept separate.
+  q.push(GUIEvent{"drag", Vec2(1, 1), Vec2(), shiftModifier});
+  q.push(GUIEvent{"drag", Vec2(2, 2), Vec2(), 0});
+  int n{0};
+  while(q.pop(e)) n++;
+  REQUIRE(n == 2);
+}
+
+TEST_CASE("mlvg/guieventqueue/full", "[guieventqueue]")
+{
+  GUIEventQueue q(4);
+  for(int i = 0; i < 4; ++i)
+  {
+    REQUIRE(q.push(GUIEvent{"down"}));
+  }
+  REQUIRE(!q.push(GUIEvent{"down"}));
+}
+
+TEST_CASE("mlvg/guieventqueue/threads", "[guieventqueue]")
+{
+  // one thread pushes down / drag / up gestures while another pops them.
+  // the order of downs and ups must be kept.
+  GUIEventQueue q(256);
+  constexpr int kGestures{1000};
+  constexpr int kDragsPerGesture{20};
+
+  std::thread producer([&]()
+  {
+    for(int i = 0; i < kGestures; ++i)
+    {
+      while(!q.push(GUIEvent{"down", Vec2(i, 0)})) std::this_thread::yield();
+      for(int j = 0; j < kDragsPerGesture; ++j)
+      {
+        while(!q.push(GUIEvent{"drag", Vec2(i, j)})) std::this_thread::yield();
+      }
+      while(!q.push(GUIEvent{"up", Vec2(i, 0)})) std::this_thread::yield();
+    }
+  });
+
+  int downs{0}, ups{0};
+  bool ordered{true};
+  while(ups < kGestures)
+  {
+    GUIEvent e;
+    if(q.pop(e))
+    {
+      if(e.type == "down")
+      {
+        ordered &= (downs == ups) && (e.position.x() == downs);
+        downs++;
+      }
+      else if(e.type == "up")
+      {
+        ordered &= (downs == ups + 1);
+        ups++;
+      }
+      else if(e.type == "drag")
+      {
+        ordered &= (downs == ups + 1);
+      }
+    }
+    else
+    {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+
+  REQUIRE(ordered);
+  REQUIRE(q.getRawEventCount() == kGestures*(kDragsPerGesture + 2));
+  REQUIRE(q.getCoalescedEventCount() <= q.getRawEventCount());
+}
@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <vector>
+
+#include "MLLayout.h"
+#include "catch.hpp"
+
+using namespace ml;
+
+namespace {
+
+bool contains(const std::vector< Path >& v, Path p) { return std::find(v.begin(), v.end(), p) != v.end(); }
+
+} // namespace
+
+TEST_CASE("mlvg/layout/rules", "[layout]")
+{
+  Layout layout;
+  Rect dial(0, 0, 2, 2);
+  layout.setViewSize(Vec2(16, 9));
+  layout.anchor("a", dial, Vec2(0, 0), Vec2(1, 1));
+  layout.anchor("b", dial, Vec2(1, 1), Vec2(-1, -1));
+  layout.under("a_label", "a", Rect(0, 0, 2, 0.5), Vec2(0, 0.25));
+  layout.anchor("area", Rect(0, 0, 8, 4), Vec2(0.5f, 0.5f), Vec2(), Vec2(0, 0));
+  layout.grid("cell", "area", 1, 1, 4, 2);
+  layout.grid("small", "area", 3, 0, 4, 2, Rect(0, 0, 1, 1));
+  layout.fixed("f", Rect(1, 2, 3, 4));
+
+  auto moved = layout.solve();
+  REQUIRE(moved.size() == layout.getNumRules());
+  REQUIRE(layout.getBounds("a") == Rect(0, 0, 2, 2));
+  REQUIRE(layout.getBounds("b") == Rect(14, 7, 2, 2));
+  REQUIRE(layout.getBounds("a_label") == Rect(0, 2, 2, 0.5));
+  REQUIRE(layout.getBounds("area") == Rect(8, 4.5, 8, 4));
+  REQUIRE(layout.getBounds("cell") == Rect(10, 6.5, 2, 2));
+  REQUIRE(layout.getBounds("small") == Rect(14.5, 5, 1, 1));
+  REQUIRE(layout.getBounds("f") == Rect(1, 2, 3, 4));
+  REQUIRE(layout.getBounds("missing") == Rect());
+  REQUIRE(!layout.needsSolve());
+}
+
+TEST_CASE("mlvg/layout/incremental", "[layout]")
+{
+  Layout layout;
+  Rect dial(0, 0, 2, 2);
+  layout.setViewSize(Vec2(16, 9));
+  layout.anchor("left", dial, Vec2(0, 0), Vec2(1, 1));
+  layout.under("left_label", "left", Rect(0, 0, 2, 0.5));
+  layout.anchor("right", dial, Vec2(1, 0), Vec2(-1, 1));
+  layout.under("right_label", "right", Rect(0, 0, 2, 0.5));
+  layout.fixed("f", Rect(1, 2, 3, 4));
+  layout.solve();
+
+  // nothing changed, nothing to solve.
+  REQUIRE(layout.solve().empty());
+  REQUIRE(layout.getSolvedCount() == 0);
+
+  // a wider view moves only what is anchored to the right, and what follows it.
+  layout.setViewSize(Vec2(20, 9));
+  auto moved = layout.solve();
+  REQUIRE(moved.size() == 2);
+  REQUIRE(contains(moved, "right"));
+  REQUIRE(contains(moved, "right_label"));
+  REQUIRE(layout.getBounds("right_label") == Rect(18, 1.75, 2, 0.5));
+
+  // the anchored rules are solved again, but their dependents only if they moved.
+  REQUIRE(layout.getSolvedCount() == 3);
+
+  // changing a rule solves it and what follows it.
+  layout.anchor("left", dial, Vec2(0, 0), Vec2(2, 1));
+  moved = layout.solve();
+  REQUIRE(moved.size() == 2);
+  REQUIRE(layout.getBounds("left_label").left() == 1);
+
+  // setting a rule to what it was moves nothing.
+  layout.fixed("f", Rect(1, 2, 3, 4));
+  REQUIRE(layout.solve().empty());
+}
+
+TEST_CASE("mlvg/layout/references", "[layout]")
+{
+  Layout layout;
+  layout.setViewSize(Vec2(16, 9));
+
+  // a rule can only refer to rects declared before it. Others are rejected.
+  REQUIRE(!layout.under("label", "dial", Rect(0, 0, 2, 0.5)));
+  REQUIRE(!layout.hasRule("label"));
+  layout.anchor("dial", Rect(0, 0, 2, 2), Vec2(0.5f, 0.5f));
+  REQUIRE(layout.under("label", "dial", Rect(0, 0, 2, 0.5)));
+  layout.solve();
+  REQUIRE(layout.getBounds("label") == Rect(7, 5.25, 2, 0.5));
+
+  // a rule can't be changed to refer to itself or to a later rect, and
+  // keeps its old rule.
+  REQUIRE(!layout.under("dial", "dial", Rect(0, 0, 2, 2)));
+  REQUIRE(!layout.under("dial", "label", Rect(0, 0, 2, 2)));
+  REQUIRE(!layout.grid("dial", "nothing", 0, 0, 1, 1));
+  layout.setViewSize(Vec2(18, 9));
+  layout.solve();
+  REQUIRE(layout.getBounds("dial") == Rect(8, 3.5, 2, 2));
+  REQUIRE(layout.getBounds("label") == Rect(8, 5.25, 2, 0.5));
+
+  // when a rule changes its reference, it stops following the old one.
+  layout.fixed("a", Rect(0, 0, 1, 1));
+  layout.fixed("b", Rect(4, 4, 1, 1));
+  layout.under("c", "a", Rect(0, 0, 1, 1));
+  layout.solve();
+  layout.under("c", "b", Rect(0, 0, 1, 1));
+  layout.solve();
+  REQUIRE(layout.getBounds("c") == Rect(4, 4.5, 1, 1));
+  layout.fixed("a", Rect(2, 2, 1, 1));
+  auto moved = layout.solve();
+  REQUIRE(moved.size() == 1);
+  REQUIRE(layout.getBounds("c") == Rect(4, 4.5, 1, 1));
+
+  layout.clear();
+  REQUIRE(layout.getNumRules() == 0);
+  REQUIRE(!layout.hasRule("a"));
+}
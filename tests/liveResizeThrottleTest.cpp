@@ -0,0 +1,67 @@
+#include <chrono>
+
+#include "MLLiveResizeThrottle.h"
+#include "catch.hpp"
+
+using namespace ml;
+using namespace std::chrono;
+
+namespace {
+
+constexpr double kInterval{100}, kTimeout{1000};
+
+} // namespace
+
+TEST_CASE("mlvg/liveresize/throttle", "[liveresize]")
+{
+  LiveResizeThrottle t;
+  auto t0 = steady_clock::now();
+  auto at = [&](int ms) { return t0 + milliseconds(ms); };
+
+  // not live resizing: a request is laid out on the next update.
+  t.request(at(0));
+  REQUIRE(t.update(at(0), kInterval, kTimeout));
+  REQUIRE(!t.update(at(1), kInterval, kTimeout));
+
+  // live resizing: at most one layout per interval, however many requests.
+  t.begin(at(200));
+  int layouts{0};
+  for(int ms = 200; ms < 700; ms += 10)
+  {
+    t.request(at(ms));
+    layouts += t.update(at(ms), kInterval, kTimeout);
+  }
+  REQUIRE(layouts == 5);
+
+  // the last request waits for the interval, then is laid out.
+  REQUIRE(t.isPending());
+  REQUIRE(!t.update(at(695), kInterval, kTimeout));
+  REQUIRE(t.update(at(700), kInterval, kTimeout));
+  REQUIRE(!t.isPending());
+
+  // ending the live resize lays out a pending request right away.
+  t.request(at(710));
+  t.end();
+  REQUIRE(t.update(at(710), kInterval, kTimeout));
+}
+
+TEST_CASE("mlvg/liveresize/timeout", "[liveresize]")
+{
+  LiveResizeThrottle t;
+  auto t0 = steady_clock::now();
+  auto at = [&](int ms) { return t0 + milliseconds(ms); };
+
+  // if the end of a resize is lost, the live resize ends after the timeout.
+  t.begin(at(0));
+  t.request(at(500));
+  REQUIRE(t.update(at(500), kInterval, kTimeout));
+  REQUIRE(!t.update(at(1400), kInterval, kTimeout));
+  REQUIRE(t.isActive());
+  REQUIRE(!t.update(at(1500), kInterval, kTimeout));
+  REQUIRE(!t.isActive());
+
+  // and a begin with no requests after it times out too.
+  t.begin(at(2000));
+  t.update(at(3000), kInterval, kTimeout);
+  REQUIRE(!t.isActive());
+}
@@ -0,0 +1,105 @@
+#include "MLParameterRamps.h"
+#include "catch.hpp"
+#include "madronalib.h"
+
+using namespace ml;
+
+TEST_CASE("mlvg/parameterramps/values", "[parameterramps]")
+{
+  ParameterRamps ramps;
+  ramps.resize(2);
+  ramps.setValue(0, 440.f);
+  ramps.setValue(1, 0.5f);
+
+  ramps.beginBlock(0);
+  ramps.processVector(0);
+  REQUIRE(ramps.getRamp(0)[0] == 440.f);
+  REQUIRE(ramps.getRamp(0)[kFloatsPerDSPVector - 1] == 440.f);
+  REQUIRE(ramps.getValue(1) == 0.5f);
+
+  // setting a value discards pending points.
+  ramps.beginBlock(kFloatsPerDSPVector);
+  ramps.addPoint(0, kFloatsPerDSPVector + 16, 0.f);
+  ramps.setValue(0, 220.f);
+  ramps.processVector(kFloatsPerDSPVector);
+  REQUIRE(ramps.getRamp(0)[0] == 220.f);
+  REQUIRE(ramps.getRamp(0)[kFloatsPerDSPVector - 1] == 220.f);
+  REQUIRE(ramps.getValue(0) == 220.f);
+
+  // out of range IDs are ignored.
+  ramps.setValue(2, 1.f);
+  ramps.addPoint(2, 0, 1.f);
+  REQUIRE(ramps.getValue(2) == 0.f);
+}
+
+TEST_CASE("mlvg/parameterramps/ramps", "[parameterramps]")
+{
+  constexpr uint64_t n = kFloatsPerDSPVector;
+  ParameterRamps ramps;
+  ramps.resize(1);
+  ramps.setValue(0, 0.f);
+
+  // a point one vector ahead ramps one unit per sample and lands on the point.
+  ramps.beginBlock(0);
+  ramps.addPoint(0, n, float(n));
+  ramps.processVector(0);
+  bool exact{true};
+  for(size_t i = 0; i < n; ++i)
+  {
+    exact &= (ramps.getRamp(0)[i] == float(i));
+  }
+  REQUIRE(exact);
+  REQUIRE(ramps.getValue(0) == float(n - 1));
+
+  // the ramp is complete at the point, and the value holds after it.
+  ramps.beginBlock(n);
+  ramps.processVector(n);
+  REQUIRE(ramps.getRamp(0)[0] == float(n));
+  REQUIRE(ramps.getRamp(0)[n - 1] == float(n));
+  ramps.processVector(n*2);
+  REQUIRE(ramps.getValue(0) == float(n));
+
+  // a point in a later block holds the old value until the block starts,
+  // then ramps to the point and holds.
+  uint64_t blockStart = n*4;
+  ramps.beginBlock(blockStart);
+  ramps.addPoint(0, blockStart + 32, 0.f);
+  ramps.processVector(n*3);
+  REQUIRE(ramps.getRamp(0)[n - 1] == float(n));
+  ramps.processVector(blockStart);
+  REQUIRE(ramps.getRamp(0)[0] == float(n));
+  REQUIRE(ramps.getRamp(0)[16] == float(n)*0.5f);
+  REQUIRE(ramps.getRamp(0)[32] == 0.f);
+  REQUIRE(ramps.getRamp(0)[n - 1] == 0.f);
+  REQUIRE(ramps.getValue(0) == 0.f);
+
+  // two points in one vector.
+  blockStart = n*5;
+  ramps.beginBlock(blockStart);
+  ramps.addPoint(0, blockStart + 10, 10.f);
+  ramps.addPoint(0, blockStart + 20, 0.f);
+  ramps.processVector(blockStart);
+  REQUIRE(ramps.getRamp(0)[5] == 5.f);
+  REQUIRE(ramps.getRamp(0)[10] == 10.f);
+  REQUIRE(ramps.getRamp(0)[15] == 5.f);
+  REQUIRE(ramps.getRamp(0)[20] == 0.f);
+}
+
+TEST_CASE("mlvg/parameterramps/overflow", "[parameterramps]")
+{
+  // when there is no room for more points, the newest is replaced,
+  // so the ramp still ends at the last value sent.
+  ParameterRamps ramps;
+  ramps.resize(1);
+  ramps.setValue(0, 0.f);
+  ramps.beginBlock(0);
+  for(size_t t = 1; t <= ParameterRamps::kMaxPointsPerParam + 8; ++t)
+  {
+    ramps.addPoint(0, t, float(t));
+  }
+  ramps.processVector(0);
+  float last = ParameterRamps::kMaxPointsPerParam + 8;
+  REQUIRE(ramps.getRamp(0)[20] == 20.f);
+  REQUIRE(ramps.getRamp(0)[size_t(last)] == last);
+  REQUIRE(ramps.getValue(0) == last);
+}
@@ -0,0 +1,83 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "MLParameterSnapshot.h"
+#include "catch.hpp"
+#include "madronalib.h"
+
+using namespace ml;
+
+TEST_CASE("mlvg/parametersnapshot/basic", "[parametersnapshot]")
+{
+  ParameterSnapshot snapshot(3);
+  const float* p = snapshot.acquire();
+  REQUIRE(p[0] == 0.f);
+
+  snapshot.setValue(0, 440.f);
+  snapshot.setValue(2, 0.5f);
+
+  // nothing is visible before publish()
+  REQUIRE(snapshot.acquire()[0] == 0.f);
+
+  snapshot.publish();
+  p = snapshot.acquire();
+  REQUIRE(p[0] == 440.f);
+  REQUIRE(p[2] == 0.5f);
+
+  // publishing twice before a read gives the newest values.
+  snapshot.setValue(0, 220.f);
+  snapshot.publish();
+  snapshot.setValue(0, 110.f);
+  snapshot.publish();
+  p = snapshot.acquire();
+  REQUIRE(p[0] == 110.f);
+  REQUIRE(p[2] == 0.5f);
+
+  // with nothing new, the reader keeps the same values.
+  REQUIRE(snapshot.acquire() == p);
+}
+
+TEST_CASE("mlvg/parametersnapshot/threads", "[parametersnapshot][threads]")
+{
+  // the writer hammers parameter changes while the reader acts like an audio
+  // callback, acquiring once per vector. Each snapshot written has values
+  // n, n + 1, n + 2 ... so that the reader can check it is never torn and
+  // never goes back in time. Run this under ThreadSanitizer with ML_TSAN.
+  constexpr size_t kParams{64};
+  constexpr int kWrites{200000};
+  ParameterSnapshot snapshot(kParams);
+  std::atomic< bool > done{false};
+
+  std::thread writer([&]()
+  {
+    for(int n = 1; n <= kWrites; ++n)
+    {
+      for(size_t i = 0; i < kParams; ++i)
+      {
+        snapshot.setValue(i, float(n + i));
+      }
+      snapshot.publish();
+    }
+    done = true;
+  });
+
+  bool intact{true};
+  bool inOrder{true};
+  float prev{0.f};
+  while(!done)
+  {
+    const float* p = snapshot.acquire();
+    for(size_t i = 1; i < kParams; ++i)
+    {
+      intact &= (p[i] == p[0] + i);
+    }
+    inOrder &= (p[0] >= prev);
+    prev = p[0];
+  }
+  writer.join();
+
+  REQUIRE(intact);
+  REQUIRE(inOrder);
+  REQUIRE(snapshot.acquire()[0] == float(kWrites));
+}
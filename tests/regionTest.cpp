@@ -0,0 +1,64 @@
+#include <vector>
+
+#include "MLMath2D.h"
+#include "catch.hpp"
+
+using namespace ml;
+
+TEST_CASE("mlvg/region/union", "[region]")
+{
+  Region r;
+  REQUIRE(r.isEmpty());
+  REQUIRE(Region(Rect(0, 0, 0, 10)).isEmpty());
+
+  // two small rects at opposite corners stay two rects.
+  r.add(Rect(0, 0, 10, 10));
+  r.add(Rect(90, 90, 10, 10));
+  REQUIRE(r.getNumRects() == 2);
+  REQUIRE(r.area() == 200);
+  REQUIRE(r.getBounds() == Rect(0, 0, 100, 100));
+
+  // a tall rect between them adds only its own area.
+  r.add(Rect(45, 0, 10, 100));
+  REQUIRE(r.area() == 200 + 1000);
+  REQUIRE(!r.intersects(Rect(20, 20, 20, 20)));
+  REQUIRE(r.intersects(Rect(50, 50, 1, 1)));
+
+  // touching rects merge.
+  Region s(Rect(0, 0, 10, 10));
+  s.add(Rect(10, 0, 10, 10));
+  s.add(Rect(0, 10, 20, 10));
+  REQUIRE(s == Region(Rect(0, 0, 20, 20)));
+  REQUIRE(s.getRects().size() == 1);
+
+  // overlapping rects are split into non-overlapping ones of the same area.
+  Region t(Rect(0, 0, 10, 10));
+  t.add(Rect(5, 5, 10, 10));
+  REQUIRE(t.area() == 175);
+  float sum{0};
+  for(auto rect : t.getRects())
+  {
+    sum += rect.area();
+  }
+  REQUIRE(sum == 175);
+}
+
+TEST_CASE("mlvg/region/intersect-subtract", "[region]")
+{
+  Region a(Rect(0, 0, 10, 10));
+  Region b(Rect(5, 5, 10, 10));
+
+  REQUIRE(a.intersect(b) == Region(Rect(5, 5, 5, 5)));
+  REQUIRE(a.subtract(b).area() == 75);
+  REQUIRE(!a.subtract(b).intersects(Rect(5, 5, 5, 5)));
+  REQUIRE(a.subtract(a).isEmpty());
+  REQUIRE(a.intersect(Region(Rect(20, 20, 1, 1))).isEmpty());
+
+  // a hole.
+  Region ring = Region(Rect(0, 0, 30, 30)).subtract(Region(Rect(10, 10, 10, 10)));
+  REQUIRE(ring.area() == 800);
+  REQUIRE(ring.getNumRects() == 4);
+  REQUIRE(!ring.contains(Rect(5, 5, 10, 10)));
+  REQUIRE(ring.contains(Rect(0, 0, 30, 10)));
+  REQUIRE(ring.unionWith(Region(Rect(10, 10, 10, 10))) == Region(Rect(0, 0, 30, 30)));
+}
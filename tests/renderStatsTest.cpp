@@ -0,0 +1,107 @@
+#include "MLRenderStats.h"
+#include "catch.hpp"
+
+using namespace ml;
+
+namespace {
+
+// a nanovg backend that draws nothing and counts what it is asked to do.
+struct NullBackend
+{
+  int textures{0};
+  int fills{0};
+  int deletes{0};
+};
+
+int nullCreate(void*) { return 1; }
+int nullCreateTexture(void* u, int, int, int, int, const unsigned char*) { return ++static_cast< NullBackend* >(u)->textures; }
+int nullDeleteTexture(void*, int) { return 1; }
+int nullUpdateTexture(void*, int, int, int, int, int, const unsigned char*) { return 1; }
+int nullGetTextureSize(void*, int, int* w, int* h) { *w = *h = 1; return 1; }
+void nullViewport(void*, float, float, float) {}
+void nullCancel(void*) {}
+void nullFlush(void*) {}
+void nullFill(void* u, NVGpaint*, NVGcompositeOperationState, NVGscissor*, float, const float*, const NVGpath*, int)
+{
+  static_cast< NullBackend* >(u)->fills++;
+}
+void nullStroke(void*, NVGpaint*, NVGcompositeOperationState, NVGscissor*, float, float, const NVGpath*, int) {}
+void nullTriangles(void*, NVGpaint*, NVGcompositeOperationState, NVGscissor*, const NVGvertex*, int, float) {}
+void nullDelete(void* u) { static_cast< NullBackend* >(u)->deletes++; }
+
+NVGcontext* createNullContext(NullBackend* backend)
+{
+  NVGparams params{};
+  params.userPtr = backend;
+  params.edgeAntiAlias = 1;
+  params.renderCreate = nullCreate;
+  params.renderCreateTexture = nullCreateTexture;
+  params.renderDeleteTexture = nullDeleteTexture;
+  params.renderUpdateTexture = nullUpdateTexture;
+  params.renderGetTextureSize = nullGetTextureSize;
+  params.renderViewport = nullViewport;
+  params.renderCancel = nullCancel;
+  params.renderFlush = nullFlush;
+  params.renderFill = nullFill;
+  params.renderStroke = nullStroke;
+  params.renderTriangles = nullTriangles;
+  params.renderDelete = nullDelete;
+  return nvgCreateInternal(&params);
+}
+
+void fillRect(NVGcontext* nvg)
+{
+  nvgBeginFrame(nvg, 100, 100, 1);
+  nvgBeginPath(nvg);
+  nvgRect(nvg, 10, 10, 20, 20);
+  nvgFill(nvg);
+  nvgEndFrame(nvg);
+}
+
+} // namespace
+
+TEST_CASE("mlvg/renderstats/attach", "[renderstats]")
+{
+  NullBackend backend;
+  NVGcontext* nvg = createNullContext(&backend);
+  REQUIRE(nvg);
+
+  RenderStatsCollector collector;
+  collector.attach(nvg);
+  REQUIRE(RenderStatsCollector::getNumWrappedContexts() == 1);
+  fillRect(nvg);
+  REQUIRE(collector.getCurrentStats().fills == 1);
+  REQUIRE(collector.getCurrentStats().pixelsCovered > 0);
+  REQUIRE(backend.fills == 1);
+
+  // detaching puts the backend back and frees the slot.
+  collector.detach();
+  REQUIRE(nvgInternalParams(nvg)->renderFill == nullFill);
+  REQUIRE(RenderStatsCollector::getNumWrappedContexts() == 0);
+  fillRect(nvg);
+  REQUIRE(collector.getCurrentStats().fills == 1);
+  REQUIRE(backend.fills == 2);
+
+  nvgDeleteInternal(nvg);
+  REQUIRE(backend.deletes == 1);
+}
+
+TEST_CASE("mlvg/renderstats/delete", "[renderstats]")
+{
+  // a host opening and closing editors many times, deleting each context
+  // while it is still attached, does not run out of slots.
+  RenderStatsCollector collector;
+  for(int i = 0; i < 200; ++i)
+  {
+    NullBackend backend;
+    NVGcontext* nvg = createNullContext(&backend);
+    collector.attach(nvg);
+    fillRect(nvg);
+    REQUIRE(collector.isAttached());
+    nvgDeleteInternal(nvg);
+    REQUIRE(backend.deletes == 1);
+    REQUIRE(!collector.isAttached());
+  }
+  REQUIRE(collector.getCurrentStats().fills == 200);
+  REQUIRE(RenderStatsCollector::getNumWrappedContexts() == 0);
+}
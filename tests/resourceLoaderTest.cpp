@@ -0,0 +1,82 @@
+#include <cstring>
+
+#include "MLResourceLoader.h"
+#include "catch.hpp"
+#include "madronalib.h"
+
+using namespace ml;
+
+namespace {
+
+const char* kTestSVG =
+  "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"40\" height=\"30\">"
+  "<rect x=\"0\" y=\"0\" width=\"40\" height=\"30\" fill=\"#ff0000\"/></svg>";
+
+} // namespace
+
+TEST_CASE("mlvg/resourceloader/decode", "[resourceloader]")
+{
+  // no draw context is needed for vector images or for images that fail to decode.
+  DrawingResources resources;
+  ResourceLoader loader(2);
+  REQUIRE(loader.getPendingCount() == 0);
+
+  const unsigned char* pSVG = reinterpret_cast< const unsigned char* >(kTestSVG);
+  const unsigned char kNotAnImage[] = {1, 2, 3, 4};
+  loader.loadVectorImage("box", pSVG, strlen(kTestSVG) + 1);
+  loader.loadRasterImage("bad", kNotAnImage, sizeof(kNotAnImage));
+  REQUIRE(loader.getPendingCount() == 2);
+
+  // resources not yet installed are pending, so that Widgets can draw placeholders.
+  size_t installed = loader.installReadyResources(nullptr, resources);
+  REQUIRE(resources.pending.size() == 2 - installed);
+
+  loader.waitUntilDecoded();
+  REQUIRE(loader.installReadyResources(nullptr, resources) == 2 - installed);
+  REQUIRE(loader.getPendingCount() == 0);
+
+  // one that failed to decode is no longer pending, but missing.
+  REQUIRE(resources.pending.empty());
+  REQUIRE(!resources.isPending("bad"));
+
+  REQUIRE(resources.vectorImages["box"]);
+  REQUIRE(resources.vectorImages["box"]->width == 40);
+  REQUIRE(!resources.rasterImages["bad"]);
+
+  // nothing more to install.
+  REQUIRE(loader.installReadyResources(nullptr, resources) == 0);
+}
+
+TEST_CASE("mlvg/resourceloader/handles", "[resourceloader]")
+{
+  DrawingResources resources;
+  DrawContext dc{};
+  dc.pResources = &resources;
+  ResourceLoader loader(1);
+  const unsigned char* pSVG = reinterpret_cast< const unsigned char* >(kTestSVG);
+
+  // a handle to a resource that is not there yet finds nothing.
+  ResourceHandle< VectorImage > box{Path("box")};
+  REQUIRE(!box.get(dc));
+
+  // once installed, the resource is found.
+  loader.loadVectorImage("box", pSVG, strlen(kTestSVG) + 1);
+  loader.waitUntilDecoded();
+  loader.installReadyResources(nullptr, resources);
+  VectorImage* pFirst = box.get(dc);
+  REQUIRE(pFirst);
+  REQUIRE(pFirst == resources.vectorImages["box"].get());
+
+  // installing a new image with the same name changes the generation, so the
+  // handle finds the replacement.
+  uint32_t generation = resources.generation;
+  loader.loadVectorImage("box", pSVG, strlen(kTestSVG) + 1);
+  loader.waitUntilDecoded();
+  loader.installReadyResources(nullptr, resources);
+  REQUIRE(resources.generation != generation);
+  REQUIRE(box.get(dc) == resources.vectorImages["box"].get());
+
+  // renaming the handle finds a different resource.
+  box.setName(Path("missing"));
+  REQUIRE(!box.get(dc));
+}
@@ -0,0 +1,136 @@
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+#include "MLResourcePack.h"
+#include "catch.hpp"
+
+using namespace ml;
+
+namespace
+{
+std::vector< uint8_t > textBytes(const std::string& s) { return std::vector< uint8_t >(s.begin(), s.end()); }
+
+std::vector< uint8_t > repeatedBytes(size_t n)
+{
+  std::vector< uint8_t > v(n);
+  for(size_t i = 0; i < n; ++i)
+  {
+    v[i] = uint8_t("mlvg "[i % 5]);
+  }
+  return v;
+}
+
+std::vector< uint8_t > noiseBytes(size_t n)
+{
+  std::vector< uint8_t > v(n);
+  uint32_t seed{0x12345678};
+  for(size_t i = 0; i < n; ++i)
+  {
+    seed = seed*1664525 + 1013904223;
+    v[i] = uint8_t(seed >> 24);
+  }
+  return v;
+}
+
+bool matches(ResourcePack::Data d, const std::vector< uint8_t >& v)
+{
+  return d && (d.size == v.size()) && (v.empty() || !std::memcmp(d.data, v.data(), v.size()));
+}
+} // namespace
+
+TEST_CASE("mlvg/resourcepack/roundtrip", "[resourcepack]")
+{
+  std::vector< ResourcePack::Input > inputs{
+    {"zebra", textBytes("stripes")},
+    {"repeated", repeatedBytes(10000)},
+    {"noise", noiseBytes(10000)},
+    {"empty", {}}};
+
+  for(bool compress : {false, true})
+  {
+    auto blob = ResourcePack::build(inputs, compress);
+    ResourcePack pack(blob.data(), blob.size());
+    REQUIRE(pack.isValid());
+    REQUIRE(pack.getNumEntries() == inputs.size());
+
+    // the index is sorted by name.
+    REQUIRE(pack.getEntryName(0) == "empty");
+    REQUIRE(pack.getEntryName(3) == "zebra");
+
+    for(const auto& in : inputs)
+    {
+      auto d = pack.find(in.name);
+      REQUIRE(d);
+      REQUIRE(matches(d, in.data));
+    }
+    REQUIRE(!pack.find("missing"));
+    REQUIRE(!pack.find("zebr"));
+
+    // uncompressed entries are read in place, 16-byte aligned.
+    auto noise = pack.find("noise");
+    REQUIRE(noise.data >= blob.data());
+    REQUIRE(noise.data < blob.data() + blob.size());
+    REQUIRE((noise.data - blob.data()) % 16 == 0);
+
+    // repetitive data is stored compressed only when asked for.
+    if(compress)
+    {
+      REQUIRE(blob.size() < 10000 + 10000/2);
+    }
+    else
+    {
+      REQUIRE(blob.size() > 20000);
+    }
+
+    // a compressed entry is uncompressed once.
+    auto r1 = pack.find("repeated");
+    auto r2 = pack.find("repeated");
+    REQUIRE(r1.data == r2.data);
+  }
+}
+
+TEST_CASE("mlvg/resourcepack/invalid", "[resourcepack]")
+{
+  std::vector< ResourcePack::Input > inputs{{"a", textBytes("aaaa")}};
+  auto blob = ResourcePack::build(inputs, false);
+
+  // bad magic
+  auto bad = blob;
+  bad[0] = 'X';
+  REQUIRE(!ResourcePack(bad.data(), bad.size()).isValid());
+
+  // truncated index or data
+  for(size_t n : {size_t(0), size_t(8), size_t(20), blob.size() - 1})
+  {
+    ResourcePack p(blob.data(), n);
+    REQUIRE(!p.isValid());
+    REQUIRE(!p.find("a"));
+  }
+}
+
+TEST_CASE("mlvg/resourcepack/mapfile", "[resourcepack]")
+{
+  std::vector< ResourcePack::Input > inputs{{"repeated", repeatedBytes(4096)}, {"noise", noiseBytes(4096)}};
+  auto blob = ResourcePack::build(inputs, true);
+
+  std::string path = (std::filesystem::temp_directory_path()/"resourcePackTest.mlrp").string();
+  FILE* f = fopen(path.c_str(), "wb");
+  REQUIRE(f);
+  fwrite(blob.data(), 1, blob.size(), f);
+  fclose(f);
+
+  {
+    auto pack = ResourcePack::mapFile(path);
+    REQUIRE(pack);
+    REQUIRE(pack->isValid());
+    for(const auto& in : inputs)
+    {
+      REQUIRE(matches(pack->find(in.name), in.data));
+    }
+  }
+  std::remove(path.c_str());
+
+  REQUIRE(!ResourcePack::mapFile(path));
+}
@@ -0,0 +1,100 @@
+#include <cmath>
+#include <vector>
+
+#include "catch.hpp"
+#include "madronalib.h"
+#include "mldsp.h"
+#include "clap-saw-demo-voice-bank.h"
+
+using namespace ml;
+
+namespace {
+
+constexpr float kSampleRate = 48000.0f;
+constexpr float kCutoff = 2000.0f, kQ = 3.4f;
+constexpr float kAttack = 0.01f, kDecay = 0.1f, kSustain = 0.7f, kRelease = 0.2f;
+
+// one second of vectors.
+constexpr int kVectorsPerSecond = int(kSampleRate) / kFloatsPerDSPVector;
+
+struct Render
+{
+  std::vector< float > bank;
+  std::vector< float > perVoice;
+};
+
+// play one note at the given gate level for heldVectors, then release it,
+// through SawVoiceBank and through the per-voice path of ClapSawDemo.
+Render renderNote(float gateLevel, int heldVectors, int totalVectors)
+{
+  const DSPVector freqNorm(110.0f/kSampleRate);
+  Render r;
+
+  SawVoiceBank< kFloatsPerSIMDVector > bank;
+  bank.setParams(kCutoff, kQ, kAttack, kDecay, kSustain, kRelease, kSampleRate);
+
+  SawGen saw;
+  Lopass lopass;
+  lopass._coeffs = Lopass::makeCoeffs(kCutoff/kSampleRate, 1.0f/kQ);
+  ADSR adsr;
+  adsr.coeffs = ADSR::calcCoeffs(kAttack, kDecay, kSustain, kRelease, kSampleRate);
+
+  for(int i = 0; i < totalVectors; ++i)
+  {
+    DSPVector gate((i < heldVectors) ? gateLevel : 0.0f);
+    bank.setVoiceInput(0, freqNorm, gate);
+    for(int v = 1; v < kFloatsPerSIMDVector; ++v)
+    {
+      bank.setVoiceSilent(v);
+    }
+    DSPVector bankOut = bank.process();
+    DSPVector perVoiceOut = lopass(saw(freqNorm))*adsr(gate);
+
+    r.bank.insert(r.bank.end(), bankOut.getConstBuffer(), bankOut.getConstBuffer() + kFloatsPerDSPVector);
+    r.perVoice.insert(r.perVoice.end(), perVoiceOut.getConstBuffer(), perVoiceOut.getConstBuffer() + kFloatsPerDSPVector);
+  }
+  return r;
+}
+
+float rms(const std::vector< float >& x, int startVector, int endVector)
+{
+  double sum{0};
+  size_t start = startVector*kFloatsPerDSPVector, end = endVector*kFloatsPerDSPVector;
+  for(size_t i = start; i < end; ++i)
+  {
+    sum += x[i]*x[i];
+  }
+  return float(std::sqrt(sum/(end - start)));
+}
+
+} // namespace
+
+TEST_CASE("mlvg/sawvoicebank/compare", "[sawvoicebank]")
+{
+  // hold for one second, then release for two.
+  const int held = kVectorsPerSecond, total = kVectorsPerSecond*3;
+  Render full = renderNote(1.0f, held, total);
+  Render half = renderNote(0.5f, held, total);
+
+  // the sustain, after the attack and decay are done.
+  const int sustainStart = held/2;
+  float bankSustain = rms(full.bank, sustainStart, held);
+  float perVoiceSustain = rms(full.perVoice, sustainStart, held);
+  REQUIRE(bankSustain > 0.f);
+  REQUIRE(perVoiceSustain > 0.f);
+
+  // the bank is not bit-identical to the per-voice path, but it is as loud.
+  float ratio = bankSustain/perVoiceSustain;
+  REQUIRE(ratio > 0.8f);
+  REQUIRE(ratio < 1.25f);
+
+  // both paths scale by the gate level.
+  float bankVelocity = rms(half.bank, sustainStart, held)/bankSustain;
+  float perVoiceVelocity = rms(half.perVoice, sustainStart, held)/perVoiceSustain;
+  REQUIRE(bankVelocity == Approx(0.5f).epsilon(0.01));
+  REQUIRE(perVoiceVelocity == Approx(0.5f).epsilon(0.05));
+
+  // and both are silent at the end of the release.
+  REQUIRE(rms(full.bank, total - 1, total) < bankSustain*0.01f);
+  REQUIRE(rms(full.perVoice, total - 1, total) < perVoiceSustain*0.01f);
+}
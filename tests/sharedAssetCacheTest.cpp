@@ -0,0 +1,107 @@
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "MLSharedAssetCache.h"
+#include "catch.hpp"
+
+using namespace ml;
+
+namespace {
+
+std::string makeSVG(int width)
+{
+  return "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" + std::to_string(width) +
+         "\" height=\"30\"><rect x=\"0\" y=\"0\" width=\"10\" height=\"10\" fill=\"#ff0000\"/></svg>";
+}
+
+const uint8_t* bytes(const std::string& s) { return reinterpret_cast< const uint8_t* >(s.c_str()); }
+
+} // namespace
+
+TEST_CASE("mlvg/sharedassetcache/svg", "[sharedassetcache]")
+{
+  SharedAssetCache cache;
+  std::string a = makeSVG(40);
+  std::string sameAsA = makeSVG(40);
+  std::string b = makeSVG(50);
+
+  // the same content, even at a different address, is parsed once.
+  auto pa = cache.getSVG(bytes(a), a.size() + 1);
+  auto pa2 = cache.getSVG(bytes(sameAsA), sameAsA.size() + 1);
+  REQUIRE(pa);
+  REQUIRE(pa == pa2);
+  REQUIRE(pa->width == 40);
+  REQUIRE(cache.getDecodeCount() == 1);
+
+  auto pb = cache.getSVG(bytes(b), b.size() + 1);
+  REQUIRE(pb != pa);
+  REQUIRE(pb->width == 50);
+  REQUIRE(cache.getDecodeCount() == 2);
+  REQUIRE(cache.getLiveCount() == 2);
+
+  // once no one uses an asset, it is freed and parsed again when asked for.
+  pa.reset();
+  pa2.reset();
+  REQUIRE(cache.getLiveCount() == 1);
+  REQUIRE(cache.getSVG(bytes(a), a.size() + 1));
+  REQUIRE(cache.getDecodeCount() == 3);
+}
+
+TEST_CASE("mlvg/sharedassetcache/bitmap", "[sharedassetcache]")
+{
+  SharedAssetCache cache;
+
+  // a 2x2 binary PPM image.
+  std::string ppm("P6\n2 2\n255\n");
+  const uint8_t rgb[12] = {255, 0, 0, 0, 255, 0, 0, 0, 255, 255, 255, 255};
+  ppm.append(reinterpret_cast< const char* >(rgb), sizeof(rgb));
+
+  auto p = cache.getBitmap(bytes(ppm), ppm.size());
+  REQUIRE(p);
+  REQUIRE(p->width == 2);
+  REQUIRE(p->height == 2);
+  REQUIRE(p->getSizeInBytes() == 16);
+  REQUIRE(p->pixels[4 + 1] == 255);
+  REQUIRE(p->pixels[4 + 3] == 255);
+  REQUIRE(cache.getBitmap(bytes(ppm), ppm.size()) == p);
+
+  // data that can't be decoded gives nullptr and is not cached.
+  const uint8_t junk[4] = {1, 2, 3, 4};
+  REQUIRE(!cache.getBitmap(junk, sizeof(junk)));
+  REQUIRE(cache.getLiveCount() == 1);
+
+  // a recent bitmap is kept when no one is using it, until it is over the budget.
+  p.reset();
+  REQUIRE(cache.getLiveCount() == 1);
+  REQUIRE(cache.getBitmap(bytes(ppm), ppm.size()));
+  REQUIRE(cache.getDecodeCount() == 1);
+  cache.setBitmapBudget(0);
+  REQUIRE(cache.getLiveCount() == 0);
+  REQUIRE(cache.getBitmap(bytes(ppm), ppm.size()));
+  REQUIRE(cache.getDecodeCount() == 2);
+}
+
+TEST_CASE("mlvg/sharedassetcache/threads", "[sharedassetcache][threads]")
+{
+  // many threads asking for the same asset all get the same one.
+  SharedAssetCache cache;
+  std::string a = makeSVG(40);
+  constexpr int kThreads{8};
+  std::vector< SharedAssetCache::SVGPtr > results(kThreads);
+  std::vector< std::thread > threads;
+  for(int i = 0; i < kThreads; ++i)
+  {
+    threads.emplace_back([&, i]() { results[i] = cache.getSVG(bytes(a), a.size() + 1); });
+  }
+  for(auto& t : threads)
+  {
+    t.join();
+  }
+  for(const auto& r : results)
+  {
+    REQUIRE(r == results[0]);
+  }
+  REQUIRE(cache.getLiveCount() == 1);
+}
@@ -0,0 +1,113 @@
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "MLSignalRing.h"
+#include "catch.hpp"
+#include "madronalib.h"
+
+using namespace ml;
+
+TEST_CASE("mlvg/signalring/basic", "[signalring]")
+{
+  LocalSignalRingTransport transport;
+  transport.publishRing("scope", std::make_shared< SignalRing >(2, 8));
+  auto ring = transport.getRing("scope");
+  REQUIRE(ring);
+  REQUIRE(ring->getCapacityInBlocks() == 8);
+  REQUIRE(ring->getBlockSizeInFloats() == kFloatsPerDSPVector*2);
+
+  for(int i = 0; i < 3; ++i)
+  {
+    ring->write(DSPVectorArray< 2 >(i));
+  }
+
+  uint64_t readSeq{0};
+  std::vector< float > dest(ring->getBlockSizeInFloats()*16);
+  auto r = ring->read(readSeq, dest.data(), 16);
+  REQUIRE(r.blocksRead == 3);
+  REQUIRE(r.blocksDropped == 0);
+  REQUIRE(readSeq == 3);
+  for(int i = 0; i < 3; ++i)
+  {
+    REQUIRE(dest[i*ring->getBlockSizeInFloats()] == i);
+  }
+
+  // nothing new
+  r = ring->read(readSeq, dest.data(), 16);
+  REQUIRE(r.blocksRead == 0);
+
+  // overrun: write more than the capacity without reading
+  for(int i = 3; i < 23; ++i)
+  {
+    ring->write(DSPVectorArray< 2 >(i));
+  }
+  r = ring->read(readSeq, dest.data(), 16);
+  REQUIRE(r.blocksDropped == 13);
+  REQUIRE(r.blocksRead == 7);
+  REQUIRE(dest[0] == 16);
+  REQUIRE(readSeq == 23);
+}
+
+TEST_CASE("mlvg/signalring/threads", "[signalring]")
+{
+  // the producer writes blocks filled with their sequence numbers. The reader
+  // checks that every block it accepts is intact and in order.
+  SignalRing ring(1, 16);
+  constexpr int kBlocks{100000};
+  std::atomic< bool > done{false};
+
+  std::thread producer([&]()
+  {
+    for(int i = 0; i < kBlocks; ++i)
+    {
+      ring.write(DSPVector(float(i)));
+    }
+    done = true;
+  });
+
+  uint64_t readSeq{0};
+  size_t totalRead{0}, totalDropped{0};
+  bool inOrder{true};
+  std::vector< float > dest(ring.getBlockSizeInFloats()*4);
+  while(!done || (readSeq < ring.getWriteSequence()))
+  {
+    uint64_t startSeq = readSeq;
+    auto r = ring.read(readSeq, dest.data(), 4);
+    for(size_t i = 0; i < r.blocksRead; ++i)
+    {
+      float expected = float(startSeq + r.blocksDropped + i);
+      inOrder &= (dest[i*kFloatsPerDSPVector] == expected);
+      inOrder &= (dest[i*kFloatsPerDSPVector + kFloatsPerDSPVector - 1] == expected);
+    }
+    totalRead += r.blocksRead;
+    totalDropped += r.blocksDropped;
+  }
+  producer.join();
+
+  REQUIRE(inOrder);
+  REQUIRE(totalRead + totalDropped == kBlocks);
+}
+
+TEST_CASE("mlvg/signalring/handle", "[signalring]")
+{
+  auto ring = std::make_shared< SignalRing >(1, 4);
+  uint64_t id{0};
+  {
+    SignalRingHandle handle(ring);
+    id = handle.getID();
+    REQUIRE(id != 0);
+    REQUIRE(SignalRingHandle::find(id) == ring);
+
+    // moving keeps the ring registered under the same id.
+    SignalRingHandle moved(std::move(handle));
+    REQUIRE(handle.getID() == 0);
+    REQUIRE(moved.getID() == id);
+    REQUIRE(SignalRingHandle::find(id) == ring);
+  }
+
+  // the registry lets go of the ring with the last handle.
+  REQUIRE(!SignalRingHandle::find(id));
+  REQUIRE(ring.use_count() == 1);
+}
@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "MLSignalSummary.h"
+#include "catch.hpp"
+#include "madronalib.h"
+#include "tests.h"
+
+using namespace ml;
+
+namespace {
+
+// a test signal with some detail at every scale.
+std::vector< float > makeTestSignal(size_t frames)
+{
+  std::vector< float > v(frames);
+  uint32_t seed{12345};
+  for(size_t i = 0; i < frames; ++i)
+  {
+    seed = seed*1664525 + 1013904223;
+    float noise = (seed >> 8)*(1.f/16777216.f) - 0.5f;
+    v[i] = 0.5f*std::sin(i*0.001f) + 0.25f*std::sin(i*0.07f) + 0.1f*noise;
+  }
+  return v;
+}
+
+} // namespace
+
+TEST_CASE("mlvg/signalsummary/columns", "[signalsummary]")
+{
+  constexpr size_t kHistory{8192};
+  const auto signal = makeTestSignal(20000);
+  SignalSummary summary(1, kHistory);
+  REQUIRE(summary.getHistoryInSamples() == kHistory);
+
+  // write in uneven chunks.
+  size_t written{0};
+  size_t chunk{1};
+  while(written < signal.size())
+  {
+    size_t n = std::min(chunk, signal.size() - written);
+    summary.write(signal.data() + written, n);
+    written += n;
+    chunk = (chunk*7 + 3) % 301;
+  }
+  uint64_t end = summary.getEndSample();
+  REQUIRE(end == (signal.size()/kFloatsPerDSPVector)*kFloatsPerDSPVector);
+
+  // columns aligned to bins are exact.
+  constexpr size_t kCols{16};
+  constexpr size_t kBinSize{256};
+  uint64_t start = ((end - kHistory + kBinSize - 1)/kBinSize)*kBinSize;
+  std::vector< SignalSummary::Column > cols(kCols);
+  REQUIRE(summary.getColumns(0, start, kCols*kBinSize, kCols, cols.data()) == kCols);
+  bool exact{true};
+  for(size_t i = 0; i < kCols; ++i)
+  {
+    auto first = signal.begin() + start + i*kBinSize;
+    auto minMax = std::minmax_element(first, first + kBinSize);
+    double sumSq{0};
+    std::for_each(first, first + kBinSize, [&](float x) { sumSq += x*x; });
+    exact &= (cols[i].min == *minMax.first);
+    exact &= (cols[i].max == *minMax.second);
+    exact &= (std::fabs(cols[i].rms - std::sqrt(sumSq/kBinSize)) < 1e-4f);
+  }
+  REQUIRE(exact);
+
+  // unaligned columns contain the true range of their samples.
+  constexpr size_t kPixels{300};
+  cols.resize(kPixels);
+  summary.getRecentColumns(0, 5000, kPixels, cols.data());
+  bool contains{true};
+  for(size_t i = 0; i < kPixels; ++i)
+  {
+    double a = double(end) - 5000 + i*(5000./kPixels);
+    auto first = signal.begin() + size_t(std::floor(a));
+    auto last = signal.begin() + std::min(size_t(std::ceil(a + 5000./kPixels)), size_t(end));
+    auto minMax = std::minmax_element(first, last);
+    contains &= cols[i].valid && (cols[i].min <= *minMax.first) && (cols[i].max >= *minMax.second);
+  }
+  REQUIRE(contains);
+
+  // columns before the history are not valid.
+  cols.resize(kCols);
+  REQUIRE(summary.getRecentColumns(0, kHistory*4, kCols, cols.data()) == kCols/4);
+  REQUIRE(!cols[0].valid);
+  REQUIRE(cols[kCols - 1].valid);
+}
+
+TEST_CASE("mlvg/signalsummary/timing", "[signalsummary][timing]")
+{
+  // compare the work to make the vertices for a 512-pixel wide scope of 64k samples:
+  // one point per sample for a polyline, or two per column from the summary.
+  constexpr size_t kSamples{65536};
+  constexpr size_t kPixels{512};
+  const auto signal = makeTestSignal(kSamples);
+  SignalSummary summary(1, kSamples);
+  summary.write(signal.data(), kSamples);
+
+  std::vector< float > vertices(kSamples*2);
+  std::function< float(void) > polyline = [&]()
+  {
+    for(size_t i = 0; i < kSamples; ++i)
+    {
+      vertices[i*2] = i*(float(kPixels)/kSamples);
+      vertices[i*2 + 1] = signal[i]*100.f;
+    }
+    return vertices[kSamples];
+  };
+
+  std::vector< SignalSummary::Column > cols(kPixels);
+  std::function< float(void) > columns = [&]()
+  {
+    summary.getRecentColumns(0, kSamples, kPixels, cols.data());
+    for(size_t i = 0; i < kPixels; ++i)
+    {
+      vertices[i*4] = float(i);
+      vertices[i*4 + 1] = cols[i].max*100.f;
+      vertices[i*4 + 2] = float(i);
+      vertices[i*4 + 3] = cols[i].min*100.f;
+    }
+    return vertices[kPixels];
+  };
+
+  // writing is done once per incoming block, so time it per DSPVector.
+  std::function< float(void) > write = [&]()
+  {
+    summary.write(signal.data(), kFloatsPerDSPVector);
+    return float(summary.getEndSample() & 1);
+  };
+
+  auto polylineTime = timeIterations< float >(polyline);
+  auto columnsTime = timeIterations< float >(columns);
+  auto writeTime = timeIterations< float >(write);
+
+  std::cout << "signal summary, " << kSamples << " samples in " << kPixels << " pixels:\n";
+  std::cout << "    polyline vertices: " << kSamples << ", " << polylineTime.ns << " ns\n";
+  std::cout << "    column vertices: " << kPixels*2 << ", " << columnsTime.ns << " ns\n";
+  std::cout << "    write one DSPVector: " << writeTime.ns << " ns\n";
+
+  // the columns cover every sample the polyline would draw.
+  bool covered{true};
+  size_t samplesPerPixel = kSamples/kPixels;
+  for(size_t i = 0; i < kPixels; ++i)
+  {
+    auto first = signal.begin() + i*samplesPerPixel;
+    auto minMax = std::minmax_element(first, first + samplesPerPixel);
+    covered &= cols[i].valid && (cols[i].min <= *minMax.first) && (cols[i].max >= *minMax.second);
+  }
+  REQUIRE(covered);
+
+  // and making them is much less work than the polyline's 128 times as many vertices.
+  REQUIRE(columnsTime.ns < polylineTime.ns);
+}
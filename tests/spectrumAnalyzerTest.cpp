@@ -0,0 +1,109 @@
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+#include "MLSpectrumAnalyzer.h"
+#include "catch.hpp"
+#include "madronalib.h"
+
+using namespace ml;
+
+TEST_CASE("mlvg/spectrumanalyzer/fft", "[spectrumanalyzer]")
+{
+  // compare with a direct DFT.
+  constexpr size_t kSize{256};
+  FFT fft(kSize);
+  REQUIRE(fft.size() == kSize);
+
+  std::vector< float > re(kSize), im(kSize);
+  for(size_t i = 0; i < kSize; ++i)
+  {
+    re[i] = std::sin(0.1f*i) + 0.5f*std::cos(1.3f*i);
+    im[i] = 0.25f*std::sin(0.7f*i);
+  }
+  std::vector< std::complex< double > > expected(kSize);
+  for(size_t k = 0; k < kSize; ++k)
+  {
+    for(size_t i = 0; i < kSize; ++i)
+    {
+      double theta = -2.0*kPi*double(k*i)/double(kSize);
+      expected[k] += std::complex< double >(re[i], im[i])*std::polar(1.0, theta);
+    }
+  }
+
+  fft.forward(re.data(), im.data());
+  double maxError{0};
+  for(size_t k = 0; k < kSize; ++k)
+  {
+    maxError = std::max(maxError, std::abs(expected[k] - std::complex< double >(re[k], im[k])));
+  }
+  // the largest values are around kSize/2.
+  REQUIRE(maxError < 1e-2);
+}
+
+TEST_CASE("mlvg/spectrumanalyzer/frames", "[spectrumanalyzer]")
+{
+  constexpr size_t kFFTSize{512};
+  constexpr size_t kHop{128};
+  constexpr size_t kSineBin{20};
+
+  auto input = std::make_shared< SignalRing >(1, 64);
+  SpectrumAnalyzer analyzer(input, kFFTSize, kHop);
+  auto output = analyzer.getOutput();
+  REQUIRE(output->getBlockSizeInFloats() == kFFTSize/2);
+
+  // nothing until the first fftSize samples are in.
+  DSPVector v;
+  size_t t{0};
+  auto writeSine = [&](size_t vectors)
+  {
+    for(size_t j = 0; j < vectors; ++j)
+    {
+      for(size_t i = 0; i < kFloatsPerDSPVector; ++i, ++t)
+      {
+        v[i] = std::sin(kTwoPi*kSineBin*float(t)/float(kFFTSize));
+      }
+      input->write(v.getConstBuffer());
+    }
+  };
+  writeSine(kFFTSize/kFloatsPerDSPVector - 1);
+  REQUIRE(analyzer.process() == 0);
+
+  // then one frame per hop.
+  writeSine(1 + 2*kHop/kFloatsPerDSPVector);
+  REQUIRE(analyzer.process() == 3);
+
+  std::vector< float > frame(kFFTSize/2);
+  uint64_t readSeq{0};
+  auto r = output->read(readSeq, frame.data(), 1);
+  REQUIRE(r.blocksRead == 1);
+
+  size_t peak = std::max_element(frame.begin(), frame.end()) - frame.begin();
+  REQUIRE(peak == kSineBin);
+  REQUIRE(std::abs(frame[peak] - 1.f) < 0.01f);
+  REQUIRE(frame[kSineBin + 10] < 1e-3f);
+}
+
+TEST_CASE("mlvg/spectrumanalyzer/drops", "[spectrumanalyzer]")
+{
+  // if the analyzer falls behind, missed input is counted and the history
+  // starts again, and unread output is overwritten rather than waited for.
+  auto input = std::make_shared< SignalRing >(1, 16);
+  SpectrumAnalyzer analyzer(input, 256, 64, 4);
+
+  DSPVector v(0.5f);
+  for(int i = 0; i < 40; ++i)
+  {
+    input->write(v.getConstBuffer());
+  }
+  analyzer.process();
+  REQUIRE(analyzer.getInputBlocksDropped() > 0);
+
+  for(int i = 0; i < 40; ++i)
+  {
+    input->write(v.getConstBuffer());
+    analyzer.process();
+  }
+  REQUIRE(analyzer.getOutput()->getWriteSequence() > analyzer.getOutput()->getCapacityInBlocks());
+}
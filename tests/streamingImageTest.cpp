@@ -0,0 +1,46 @@
+#include <algorithm>
+
+#include "MLStreamingImage.h"
+#include "catch.hpp"
+#include "madronalib.h"
+
+using namespace ml;
+
+TEST_CASE("mlvg/streamingimage/dirtyrects", "[streamingimage]")
+{
+  DirtyRects d;
+  REQUIRE(d.empty());
+
+  // empty rects are ignored.
+  d.add(Rect(10, 10, 0, 5));
+  REQUIRE(d.empty());
+
+  // separate rects stay separate.
+  d.add(Rect(0, 0, 4, 4));
+  d.add(Rect(10, 0, 4, 4));
+  REQUIRE(d.getRects().size() == 2);
+  REQUIRE(d.getArea() == 32);
+
+  // a rect touching both merges them all into one.
+  d.add(Rect(4, 0, 6, 1));
+  REQUIRE(d.getRects().size() == 1);
+  REQUIRE(d.getRects()[0] == Rect(0, 0, 14, 4));
+
+  // rects in the list never exceed kMaxRects.
+  d.clear();
+  for(int i = 0; i < 20; ++i)
+  {
+    d.add(Rect(i*10, i*10, 2, 2));
+    REQUIRE(d.getRects().size() <= DirtyRects::kMaxRects);
+  }
+
+  // and always cover everything added.
+  float right{0}, bottom{0};
+  for(const auto& r : d.getRects())
+  {
+    right = std::max(right, r.right());
+    bottom = std::max(bottom, r.bottom());
+  }
+  REQUIRE(right == 192);
+  REQUIRE(bottom == 192);
+}
@@ -0,0 +1,316 @@
+#include <algorithm>
+#include <vector>
+
+#include "MLView.h"
+#include "MLVirtualListView.h"
+#include "catch.hpp"
+#include "madronalib.h"
+
+using namespace ml;
+
+namespace {
+
+// a Widget that records the position of the last event it got.
+class HitWidget : public Widget
+{
+public:
+  HitWidget(WithValues p) : Widget(p) {}
+
+  MessageList processGUIEvent(const GUICoordinates& gc, GUIEvent e) override
+  {
+    MessageList r;
+    hits++;
+    lastPosition = e.position;
+    r.push_back(Message("hit"));
+    return r;
+  }
+
+  int hits{0};
+  Vec2 lastPosition;
+};
+
+// a list row that remembers the item it shows.
+class ListRow : public Widget
+{
+public:
+  size_t item{~size_t(0)};
+};
+
+} // namespace
+
+TEST_CASE("mlvg/view/visible", "[view]")
+{
+  CollectionRoot< Widget > root;
+  View view(root, WithValues{{"bounds", rectToMatrix(Rect(0, 0, 10, 10))}});
+  Widget inside(WithValues{{"bounds", rectToMatrix(Rect(4, 4, 2, 2))}});
+  Widget edge(WithValues{{"bounds", rectToMatrix(Rect(9, 9, 2, 2))}});
+  Widget outside(WithValues{{"bounds", rectToMatrix(Rect(12, 0, 2, 2))}});
+  Widget unplaced;
+
+  REQUIRE(view.getVisibleRect() == Rect(0, 0, 10, 10));
+  REQUIRE(view.isOnScreen(inside, view.getVisibleRect()));
+  REQUIRE(view.isOnScreen(edge, view.getVisibleRect()));
+  REQUIRE(!view.isOnScreen(outside, view.getVisibleRect()));
+
+  // Widgets without bounds may be about to get them.
+  REQUIRE(view.isOnScreen(unplaced, view.getVisibleRect()));
+
+  // scaling up around the center shows less of the View.
+  view.setProperty("scale", 2.f);
+  REQUIRE(view.getVisibleRect() == Rect(2.5, 2.5, 5, 5));
+  REQUIRE(view.isOnScreen(inside, view.getVisibleRect()));
+  REQUIRE(!view.isOnScreen(edge, view.getVisibleRect()));
+
+  // moving the contents right shows more on the left.
+  view.setProperty("scale", 1.f);
+  view.setProperty("position", vec2ToMatrix(Vec2(4, 0)));
+  REQUIRE(view.getVisibleRect() == Rect(-4, 0, 10, 10));
+  REQUIRE(!view.isOnScreen(edge, view.getVisibleRect()));
+
+  // before the View is laid out, nothing is culled.
+  View unplacedView(root, WithValues{});
+  REQUIRE(unplacedView.isOnScreen(outside, unplacedView.getVisibleRect()));
+}
+
+TEST_CASE("mlvg/view/events", "[view]")
+{
+  CollectionRoot< Widget > root;
+  View view(root, WithValues{{"bounds", rectToMatrix(Rect(0, 0, 10, 10))}});
+  view._widgets.add_unique< HitWidget >("hit", WithValues{{"bounds", rectToMatrix(Rect(4, 4, 1, 1))}});
+  auto& hit = static_cast< HitWidget& >(*view._widgets["hit"]);
+  GUICoordinates gc;
+
+  view.processGUIEvent(gc, GUIEvent("down", Vec2(4.5f, 4.5f)));
+  view.processGUIEvent(gc, GUIEvent("up", Vec2(4.5f, 4.5f)));
+  REQUIRE(hit.hits == 2);
+
+  // at a scale of 2, the Widget is drawn over (3, 3, 2, 2). Events are moved
+  // into the coordinates of the Widgets before they are hit.
+  view.setProperty("scale", 2.f);
+  view.processGUIEvent(gc, GUIEvent("down", Vec2(3.2f, 3.2f)));
+  view.processGUIEvent(gc, GUIEvent("up", Vec2(3.2f, 3.2f)));
+  REQUIRE(hit.hits == 4);
+  REQUIRE(hit.lastPosition.x() == Approx(4.1f));
+  REQUIRE(hit.lastPosition.y() == Approx(4.1f));
+
+  // moved right by 2, the Widget is drawn over (6, 4, 1, 1), and an event
+  // where it was before misses it.
+  view.setProperty("scale", 1.f);
+  view.setProperty("position", vec2ToMatrix(Vec2(2, 0)));
+  view.processGUIEvent(gc, GUIEvent("down", Vec2(4.5f, 4.5f)));
+  REQUIRE(hit.hits == 4);
+  view.processGUIEvent(gc, GUIEvent("down", Vec2(6.5f, 4.5f)));
+  view.processGUIEvent(gc, GUIEvent("up", Vec2(6.5f, 4.5f)));
+  REQUIRE(hit.hits == 6);
+  REQUIRE(hit.lastPosition.x() == Approx(4.5f));
+}
+
+TEST_CASE("mlvg/view/virtuallist", "[view]")
+{
+  DrawingResources resources;
+  PropertyTree properties;
+  DrawContext dc{nullptr, &resources, &properties, GUICoordinates{}};
+
+  // the rows made and bound for a list of n items: first one row down, then
+  // if scrollAll, on to the end one row at a time.
+  struct Counts
+  {
+    size_t rows{0}, made{0}, binds{0}, scrollBinds{0};
+  };
+  auto run = [&](size_t n, bool scrollAll)
+  {
+    Counts c;
+    VirtualListView list(WithValues{{"bounds", rectToMatrix(Rect(0, 0, 4, 5))}, {"row_height", 0.5f}});
+    list.setItems(n, [&]() { c.made++; return std::make_unique< ListRow >(); },
+                  [&](Widget& w, size_t item) { c.binds++; static_cast< ListRow& >(w).item = item; });
+    list.animate(0, dc);
+    c.rows = list.getNumRows();
+
+    // scrolling by one row binds one row.
+    size_t bindsBefore = c.binds;
+    list.setProperty("scroll", 1.f);
+    list.animate(0, dc);
+    c.scrollBinds = c.binds - bindsBefore;
+
+    if(scrollAll)
+    {
+      for(size_t i = 2; i < n; ++i)
+      {
+        list.setProperty("scroll", float(i));
+        list.animate(0, dc);
+      }
+    }
+    return c;
+  };
+
+  // 10 rows fill the list, plus one for a partial row. Scrolling to the end
+  // binds each item once.
+  Counts small = run(100, true);
+  REQUIRE(small.rows == 11);
+  REQUIRE(small.made == 11);
+  REQUIRE(small.binds == 100);
+  REQUIRE(small.scrollBinds == 1);
+
+  // the rows and the work per scroll step don't depend on the number of items.
+  Counts large = run(100000, false);
+  REQUIRE(large.rows == small.rows);
+  REQUIRE(large.made == small.made);
+  REQUIRE(large.scrollBinds == 1);
+
+  // a list shorter than its height has one row per item.
+  Counts tiny = run(3, false);
+  REQUIRE(tiny.rows == 3);
+}
+
+TEST_CASE("mlvg/view/occlusion", "[view]")
+{
+  CollectionRoot< Widget > root;
+  View view(root, WithValues{{"bounds", rectToMatrix(Rect(0, 0, 10, 10))}});
+  DrawingResources resources;
+  PropertyTree properties;
+  GUICoordinates coords;
+  coords.gridSizeInPixels = 10;
+  DrawContext dc{nullptr, &resources, &properties, coords};
+
+  // a lower z is nearer.
+  auto make = [](Rect bounds, float z, bool opaque)
+  {
+    auto w = std::make_unique< Widget >(WithValues{{"bounds", rectToMatrix(bounds)}, {"z", z}, {"opaque", opaque}});
+    w->setDirty(true);
+    return w;
+  };
+  auto contains = [](const std::vector< Widget* >& v, Widget* w)
+  {
+    return std::find(v.begin(), v.end(), w) != v.end();
+  };
+
+  auto cover = make(Rect(0, 0, 4, 4), 0, true);
+  auto hidden = make(Rect(1, 1, 2, 2), 1, false);
+  auto partial = make(Rect(3, 3, 2, 2), 1, false);
+  auto inFront = make(Rect(1, 1, 2, 2), -1, false);
+  auto sameZ = make(Rect(1, 1, 2, 2), 0, false);
+
+  SECTION("full and partial occlusion")
+  {
+    hidden->setProperty("previous_bounds", rectToMatrix(Rect(8, 8, 1, 1)));
+    std::vector< Widget* > widgets{hidden.get(), partial.get(), sameZ.get(), cover.get(), inFront.get()};
+    view.cullOccludedWidgets(dc, widgets);
+
+    // only the Widget completely behind the opaque one is removed. It is no
+    // longer dirty, and its old bounds won't be redrawn again.
+    REQUIRE(widgets.size() == 4);
+    REQUIRE(!contains(widgets, hidden.get()));
+    REQUIRE(!hidden->isDirty());
+    REQUIRE(hidden->getRectProperty("previous_bounds") == hidden->getBounds());
+    REQUIRE(contains(widgets, partial.get()));
+    REQUIRE(contains(widgets, sameZ.get()));
+    REQUIRE(contains(widgets, cover.get()));
+    REQUIRE(contains(widgets, inFront.get()));
+
+    // the drawing order of the rest is kept.
+    REQUIRE(widgets[0] == partial.get());
+    REQUIRE(widgets[3] == inFront.get());
+  }
+
+  SECTION("clipped")
+  {
+    // only the part of each Widget inside the clip rect needs to be covered.
+    std::vector< Widget* > widgets{partial.get(), cover.get()};
+    view.cullOccludedWidgets(dc, widgets, Rect(30, 30, 10, 10));
+    REQUIRE(widgets.size() == 1);
+    REQUIRE(widgets[0] == cover.get());
+  }
+
+  SECTION("not opaque")
+  {
+    // a Widget that is not opaque hides nothing, wherever it is.
+    auto glass = make(Rect(0, 0, 4, 4), 0, false);
+    std::vector< Widget* > widgets{hidden.get(), glass.get()};
+    view.cullOccludedWidgets(dc, widgets);
+    REQUIRE(widgets.size() == 2);
+    REQUIRE(hidden->isDirty());
+  }
+}
+
+TEST_CASE("mlvg/view/repair", "[view]")
+{
+  CollectionRoot< Widget > root;
+  View view(root, WithValues{{"bounds", rectToMatrix(Rect(0, 0, 10, 10))}});
+  GUICoordinates coords;
+  coords.gridSizeInPixels = 10;
+  DrawingResources resources;
+  PropertyTree properties;
+  DrawContext dc{nullptr, &resources, &properties, coords};
+
+  auto add = [&](const char* name, Rect bounds, float z)
+  {
+    view._widgets.add_unique< Widget >(name, WithValues{{"bounds", rectToMatrix(bounds)}, {"z", z}, {"visible", true}});
+    return view._widgets[name].get();
+  };
+
+  // a full size panel behind two dials, with controls between and below them.
+  Widget* panel = add("panel", Rect(0, 0, 10, 10), 1);
+  Widget* dialA = add("dial_a", Rect(1, 1, 2, 2), 0);
+  Widget* dialB = add("dial_b", Rect(7, 1, 2, 2), 0);
+  Widget* between = add("between", Rect(4, 1, 2, 2), 0);
+  Widget* below = add("below", Rect(4, 6, 2, 2), 0);
+  for(auto w : {panel, dialA, dialB, between, below})
+  {
+    w->setDirty(false);
+  }
+  dialA->setDirty(true);
+  dialB->setDirty(true);
+
+  // the panel touches the damage around each dial, so the two are merged
+  // into one rect, which paints over the control between them. It must be
+  // drawn again too.
+  auto repairs = view.getRepairs(dc);
+  REQUIRE(repairs.size() == 1);
+  const auto& repair = repairs[0];
+  REQUIRE(repair.pixels == Rect(9, 9, 82, 22));
+  REQUIRE(repair.widgets.size() == 4);
+  REQUIRE(repair.widgets[0] == panel);
+  for(auto w : {dialA, dialB, between})
+  {
+    REQUIRE(std::find(repair.widgets.begin(), repair.widgets.end(), w) != repair.widgets.end());
+  }
+
+  // every Widget the rect paints over is drawn.
+  for(auto w : {panel, dialA, dialB, between, below})
+  {
+    bool touches = bool(intersectRects(getPixelBounds(dc, *w), repair.pixels));
+    bool drawn = std::find(repair.widgets.begin(), repair.widgets.end(), w) != repair.widgets.end();
+    REQUIRE(touches == drawn);
+  }
+}
+
+TEST_CASE("mlvg/view/resize", "[view]")
+{
+  CollectionRoot< Widget > root;
+  View view(root, WithValues{{"bounds", rectToMatrix(Rect(0, 0, 12, 10))}});
+  GUICoordinates coords;
+  coords.gridSizeInPixels = 10;
+  coords.viewSizeInPixels = Vec2(120, 100);
+  DrawingResources resources;
+  PropertyTree properties;
+  DrawContext dc{nullptr, &resources, &properties, coords};
+
+  view._widgets.add_unique< Widget >("left", WithValues{{"bounds", rectToMatrix(Rect(1, 1, 2, 2))}, {"visible", true}});
+  view._widgets.add_unique< Widget >("edge", WithValues{{"bounds", rectToMatrix(Rect(9, 1, 2, 2))}, {"visible", true}});
+  Widget* edge = view._widgets["edge"].get();
+  forEach< Widget >(view._widgets, [&](Widget& w) { w.setDirty(false); });
+
+  // growing wider than 100 pixels exposes a strip on the right. Only the
+  // strip and the Widgets touching it are repaired.
+  REQUIRE(view.exposeResizedArea(dc, Vec2(100, 100)));
+  auto repairs = view.getRepairs(dc);
+  REQUIRE(repairs.size() == 1);
+  REQUIRE(repairs[0].pixels == Rect(100, 0, 20, 100));
+  REQUIRE(repairs[0].widgets.size() == 1);
+  REQUIRE(repairs[0].widgets[0] == edge);
+
+  // shrinking exposes nothing.
+  View other(root, WithValues{{"bounds", rectToMatrix(Rect(0, 0, 12, 10))}});
+  REQUIRE(other.exposeResizedArea(dc, Vec2(200, 200)));
+  REQUIRE(other.getRepairs(dc).empty());
+}
@@ -0,0 +1,100 @@
+#include <cmath>
+
+#include "MLWidget.h"
+#include "catch.hpp"
+#include "madronalib.h"
+
+using namespace ml;
+
+namespace {
+
+// a Widget that looks the same for any value in each tenth of its range.
+class SteppedWidget : public Widget
+{
+public:
+  SteppedWidget(WithValues p) : Widget(p) {}
+
+  uint64_t getVisibleState(const DrawContext& dc) override
+  {
+    float v = _params.getNormalizedFloatValue(Path(getTextProperty("param")));
+    return combineVisibleState(kVisibleStateSeed, uint64_t(std::floor(v*10.f)));
+  }
+};
+
+void setParam(Widget& w, float v)
+{
+  w.handleMessage(Message(Path("set_param", "p"), v), nullptr);
+}
+
+// what the View does when it draws a Widget.
+void drawn(Widget& w, const DrawContext& dc)
+{
+  w.setDirty(false);
+  w._visibleState = w.getVisibleState(dc);
+}
+
+} // namespace
+
+TEST_CASE("mlvg/widget/visiblestate", "[widget]")
+{
+  DrawingResources resources;
+  PropertyTree properties;
+  DrawContext dc{nullptr, &resources, &properties, GUICoordinates{}};
+
+  SteppedWidget w(WithValues{{"param", "p"}});
+  w.setupParams();
+  setParam(w, 0.f);
+  w.updateVisibleState(dc);
+  drawn(w, dc);
+
+  // a new value is checked before the next frame, not marked dirty right away.
+  setParam(w, 0.55f);
+  REQUIRE(w._checkVisibleState);
+  REQUIRE(!w.isDirty());
+  w.updateVisibleState(dc);
+  REQUIRE(w.isDirty());
+  REQUIRE(!w._checkVisibleState);
+  drawn(w, dc);
+
+  // a new value that looks the same is not redrawn.
+  setParam(w, 0.58f);
+  w.updateVisibleState(dc);
+  REQUIRE(!w.isDirty());
+
+  // the same value again is not checked.
+  setParam(w, 0.58f);
+  REQUIRE(!w._checkVisibleState);
+
+  // a change is compared to the state last drawn, not the last checked.
+  setParam(w, 0.65f);
+  setParam(w, 0.52f);
+  w.updateVisibleState(dc);
+  REQUIRE(!w.isDirty());
+
+  // properties mark the Widget dirty right away.
+  w.handleMessage(Message(Path("set_prop", "color"), 1.f), nullptr);
+  REQUIRE(w.isDirty());
+}
+
+TEST_CASE("mlvg/widget/visiblestate/unknown", "[widget]")
+{
+  DrawingResources resources;
+  PropertyTree properties;
+  DrawContext dc{nullptr, &resources, &properties, GUICoordinates{}};
+
+  // a Widget that doesn't know its visible state is redrawn for every new value.
+  Widget w(WithValues{{"param", "p"}});
+  w.setupParams();
+  drawn(w, dc);
+  for(float v : {0.1f, 0.11f, 0.12f})
+  {
+    setParam(w, v);
+    w.updateVisibleState(dc);
+    REQUIRE(w.isDirty());
+    drawn(w, dc);
+  }
+
+  // with no new value, nothing is checked.
+  w.updateVisibleState(dc);
+  REQUIRE(!w.isDirty());
+}